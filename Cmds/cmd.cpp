@@ -14,8 +14,12 @@
  *  limitations under the License.
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <new>
 #include "cmd.h"
 #include "../Utils/buffers.h"
+#include "../Utils/binDump.h"
 
 using namespace std;
 
@@ -24,17 +28,17 @@ const uint32_t Cmd::BITMASK_FUSE_DW = (BITMASK_FUSE_B << 8);
 
 
 Cmd::Cmd() :
-    Trackable(Trackable::OBJTYPE_FENCE),
-    mCmdBuf(new MemBuffer())
+    Trackable(Trackable::OBJTYPE_FENCE)
 {
     // This constructor will throw
 }
 
 
 Cmd::Cmd(Trackable::ObjType objBeingCreated) :
-    Trackable(objBeingCreated),
-    mCmdBuf(new MemBuffer())
+    Trackable(objBeingCreated)
 {
+    memset(mCmdBuf, 0, sizeof(mCmdBuf));
+    mCmdSize = 0;
     mDataDir = DATADIR_NONE;
     mCmdName = GetObjName(objBeingCreated);
 }
@@ -45,6 +49,24 @@ Cmd::~Cmd()
 }
 
 
+void *
+Cmd::operator new(size_t size)
+{
+    void *ptr;
+
+    if (posix_memalign(&ptr, CMD_ALIGNMENT, size))
+        throw std::bad_alloc();
+    return ptr;
+}
+
+
+void
+Cmd::operator delete(void *ptr)
+{
+    free(ptr);
+}
+
+
 void
 Cmd::Init(uint8_t opcode, DataDir dataDir, uint16_t cmdSize)
 {
@@ -58,12 +80,15 @@ Cmd::Init(uint8_t opcode, DataDir dataDir, uint16_t cmdSize)
         throw FrmwkEx(HERE, "Illegal data direction specified: %d", dataDir);
     }
 
-    if (cmdSize % sizeof(uint32_t) != 0)
+    if ((cmdSize == 0) || (cmdSize % sizeof(uint32_t) != 0) ||
+        (cmdSize > CMD_MAX_SIZE)) {
         throw FrmwkEx(HERE, "Illegal cmd size specified: %d", cmdSize);
+    }
 
-    // Cmd buffers shall be DWORD aligned according to NVME spec., however
-    // user space only has option to spec. QWORD alignment.
-    mCmdBuf->InitAlignment(cmdSize, PRP_BUFFER_ALIGNMENT, true, 0);
+    // Cmd buffers shall be DWORD aligned according to NVME spec., the inline
+    // storage is cache line aligned which satisfies that and QWORD alignment.
+    memset(mCmdBuf, 0, sizeof(mCmdBuf));
+    mCmdSize = cmdSize;
     SetByte(opcode, 0, 0);
 }
 
@@ -74,7 +99,7 @@ Cmd::GetDword(uint8_t whichDW) const
     if (whichDW >= GetCmdSizeDW())
         throw FrmwkEx(HERE, "Cmd is not large enough to get requested value");
 
-    return ((uint32_t *)mCmdBuf->GetBuffer())[whichDW];
+    return mCmdBuf[whichDW];
 }
 
 
@@ -120,8 +145,7 @@ Cmd::SetDword(uint32_t newVal, uint8_t whichDW)
     if (whichDW >= GetCmdSizeDW())
         throw FrmwkEx(HERE, "Cmd is not large enough to set requested value");
 
-    uint32_t *dw = (uint32_t *)mCmdBuf->GetBuffer();
-    dw[whichDW] = newVal;
+    mCmdBuf[whichDW] = newVal;
 }
 
 
@@ -177,6 +201,18 @@ Cmd::SetBit(bool newVal, uint8_t whichDW, uint8_t dwOffset)
 }
 
 
+void
+Cmd::Reset()
+{
+    uint8_t opcode = GetOpcode();
+
+    memset(mCmdBuf, 0, sizeof(mCmdBuf));
+    SetByte(opcode, 0, 0);
+    ResetPrpBuffer();
+    ReleaseMetaBuffer();
+}
+
+
 void
 Cmd::SetFUSE(uint8_t newVal)
 {
@@ -241,15 +277,20 @@ Cmd::Dump(DumpFilename filename, string fileHdr) const
 {
     FILE *fp;
 
-    if ((fp = fopen(filename.c_str(), "a")) == NULL)
-        throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+    if (BinDump::IsFramed()) {
+        BinDump::Write(filename, BINDUMP_CMD, 0, 0, GetCmd(), GetCmdSizeB(),
+            fileHdr);
+    } else {
+        if ((fp = fopen(filename.c_str(), "a")) == NULL)
+            throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
 
-    fprintf(fp, "This file: %s\n", filename.c_str());
-    fprintf(fp, "%s\n\n", fileHdr.c_str());
-    fclose(fp);
+        fprintf(fp, "This file: %s\n", filename.c_str());
+        fprintf(fp, "%s\n\n", fileHdr.c_str());
+        fclose(fp);
 
-    Buffers::Dump(filename, (uint8_t *)mCmdBuf->GetBuffer(), 0, ULONG_MAX,
-        mCmdBuf->GetBufSize(), "Cmd contents:");
+        Buffers::Dump(filename, GetCmd(), 0, ULONG_MAX, GetCmdSizeB(),
+            "Cmd contents:");
+    }
     PrpData::Dump(filename, "Payload contents:");
     MetaData::Dump(filename, "Meta data contents:");
 }
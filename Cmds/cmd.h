@@ -25,6 +25,11 @@
 
 class SQ;     // forward definition
 
+/// The largest cmd, in bytes, which can be held within a Cmd object
+#define CMD_MAX_SIZE            64
+/// The cmd bytes are cache line aligned so that dnvme copies them in one shot
+#define CMD_ALIGNMENT           64
+
 class Cmd;    // forward definition
 typedef boost::shared_ptr<Cmd>              SharedCmdPtr;
 #define CAST_TO_Cmd(shared_trackable_ptr)   \
@@ -51,12 +56,19 @@ public:
     /// Dump the entire contents of the cmd buffer to the logging endpoint
     void LogCmd() const;
 
-    /// Access to the actual cmd bytes
-    SharedMemBufferPtr GetCmd() const { return mCmdBuf; }
+    /**
+     * Cmd objects embed their cmd bytes, thus they must be allocated with
+     * CMD_ALIGNMENT which operator new() does not guarantee pre C++17.
+     */
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+
+    /// Access to the actual cmd bytes, valid for GetCmdSizeB() bytes
+    const uint8_t *GetCmd() const { return (const uint8_t *)mCmdBuf; }
 
-    uint16_t  GetCmdSizeB() const { return mCmdBuf->GetBufSize(); }
-    uint16_t  GetCmdSizeW() const { return (mCmdBuf->GetBufSize() / 2); }
-    uint8_t   GetCmdSizeDW() const { return (mCmdBuf->GetBufSize() / 4); }
+    uint16_t  GetCmdSizeB() const { return mCmdSize; }
+    uint16_t  GetCmdSizeW() const { return (mCmdSize / 2); }
+    uint8_t   GetCmdSizeDW() const { return (mCmdSize / 4); }
     uint8_t   GetOpcode() const { return GetByte(0, 0); }
     string    GetName() const { return mCmdName; }
 
@@ -118,6 +130,13 @@ public:
     void SetBit(bool newVal, uint8_t whichDW, uint8_t dwOffset);
     bool GetBit(uint8_t whichDW, uint8_t dwOffset) const;
 
+    /**
+     * Return this cmd to the state it was constructed in so it can be reused;
+     * all cmd bytes other than the opcode are zeroed, and any PRP and meta
+     * data buffer associations are dropped.
+     */
+    virtual void Reset();
+
     /**
      * Append the entire contents of this cmd's command bytes to the named file.
      * @param filename Pass the filename as generated by macro
@@ -135,7 +154,8 @@ protected:
      *      to notify dnvme which way to send base classes PrpData. The kernel
      *      requires special calls dependent upon the direction of xfer. If this
      *      is not correct, unknown outcomes will be observed.
-     * @param cmdSize Pass the number of bytes consisting of a single cmd.
+     * @param cmdSize Pass the number of bytes consisting of a single cmd,
+     *      a DWORD multiple no larger than CMD_MAX_SIZE.
      */
     void Init(uint8_t opcode, DataDir dataDir, uint16_t cmdSize);
 
@@ -143,7 +163,10 @@ protected:
 private:
     Cmd();
 
-    SharedMemBufferPtr mCmdBuf;
+    /// The cmd bytes live inline to avoid a heap MemBuffer per cmd
+    uint32_t mCmdBuf[CMD_MAX_SIZE / sizeof(uint32_t)]
+        __attribute__((aligned(CMD_ALIGNMENT)));
+    uint16_t mCmdSize;
     DataDir mDataDir;
     string mCmdName;
 
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _CMDPOOL_H_
+#define _CMDPOOL_H_
+
+#include <string.h>
+#include <mutex>
+#include "cmd.h"
+
+/// Idle cmds beyond this many are deleted rather than kept for reuse
+#define CMDPOOL_DEFAULT_MAX_IDLE        4096
+
+
+/**
+* This class recycles cmd objects of a single type T, e.g. CmdPool<Write>, so
+* that tests which build cmds in tight loops stop paying for a heap
+* allocation and construction per cmd. Get() hands out a cmd which appears
+* freshly constructed; once the last reference to it is dropped the cmd is
+* Reset() and returned to the pool rather than deleted. The block which the
+* shared_ptr allocates to count those references is recycled likewise. The
+* pool may be destroyed while cmds are outstanding, those are then deleted
+* normally.
+*
+* Resetting a cmd releases its meta data buffer to the RsrcMngr, thus as with
+* any other cmd the last reference must be dropped from the main thread when
+* meta data is in use.
+*
+* @note This class may throw exceptions.
+*/
+template <class T>
+class CmdPool
+{
+public:
+    typedef boost::shared_ptr<T> SharedTPtr;
+
+    struct Stats {
+        uint64_t hits;      // Get() satisfied by a recycled cmd
+        uint64_t misses;    // Get() which had to construct a new cmd
+        uint64_t recycled;  // Cmds returned into the pool
+        uint64_t deleted;   // Cmds deleted because the pool was full
+    };
+
+    /**
+     * @param maxIdle Pass the max number of idle cmds to retain for reuse
+     */
+    CmdPool(size_t maxIdle = CMDPOOL_DEFAULT_MAX_IDLE) :
+        mState(new State(maxIdle)) {}
+    virtual ~CmdPool()
+    {
+        bool orphaned;
+        {
+            std::lock_guard<std::mutex> lock(mState->mtx);
+            mState->alive = false;
+            for (size_t i = 0; i < mState->idle.size(); i++)
+                delete mState->idle[i];
+            mState->idle.clear();
+            orphaned = (mState->numBlks == 0);
+        }
+        // Otherwise the last outstanding cmd's block deletes it
+        if (orphaned)
+            delete mState;
+    }
+
+    /**
+     * Obtain a cmd in its constructed state; PRP and meta data buffers must
+     * be associated anew.
+     * @return The cmd, which returns to this pool when no longer referenced
+     */
+    SharedTPtr Get()
+    {
+        T *cmd = NULL;
+        {
+            std::lock_guard<std::mutex> lock(mState->mtx);
+            if (mState->idle.empty() == false) {
+                cmd = mState->idle.back();
+                mState->idle.pop_back();
+                mState->stats.hits++;
+            } else {
+                mState->stats.misses++;
+            }
+        }
+        if (cmd == NULL)
+            cmd = new T();
+        return SharedTPtr(cmd, Recycler(mState), BlkAllocator<T>(mState));
+    }
+
+    /**
+     * Construct cmds ahead of time so the 1st Get()'s are also allocation
+     * free, e.g. pass the number of cmds a queue depth requires in flight.
+     * The cmds are obtained and released as by Get(), thus they also count
+     * towards the stats.
+     * @param num Pass the number of idle cmds the pool should hold
+     */
+    void Prealloc(size_t num)
+    {
+        vector<SharedTPtr> cmds;
+
+        // Only cmds which went through Get() leave reference count blocks
+        num = MIN(num, mState->maxIdle);
+        cmds.reserve(num);
+        while (cmds.size() < num)
+            cmds.push_back(Get());
+    }
+
+    size_t GetNumIdle() const
+    {
+        std::lock_guard<std::mutex> lock(mState->mtx);
+        return mState->idle.size();
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(mState->mtx);
+        return mState->stats;
+    }
+
+    /// Log the pool's stats to the logging endpoint
+    void LogStats() const
+    {
+        Stats stats = GetStats();
+        LOG_NRM("CmdPool stats: hits %llu, misses %llu, recycled %llu, "
+            "deleted %llu, idle %llu", (unsigned long long)stats.hits,
+            (unsigned long long)stats.misses,
+            (unsigned long long)stats.recycled,
+            (unsigned long long)stats.deleted,
+            (unsigned long long)GetNumIdle());
+    }
+
+
+private:
+    /**
+     * Referenced by every outstanding cmd so it may outlive the pool itself.
+     * Rather than paying for a shared_ptr of its own, it is deleted by
+     * whichever comes last; the pool or its last outstanding block.
+     */
+    struct State {
+        std::mutex mtx;
+        vector<T *> idle;
+        vector<void *> idleBlks;    // Reference count blocks of blkSize
+        size_t blkSize;
+        size_t numBlks;             // Blocks handed out but not returned
+        size_t maxIdle;
+        bool alive;
+        Stats stats;
+
+        State(size_t max) : blkSize(0), numBlks(0), maxIdle(max),
+            alive(true) { memset(&stats, 0, sizeof(stats)); }
+        ~State()
+        {
+            for (size_t i = 0; i < idleBlks.size(); i++)
+                ::operator delete(idleBlks[i]);
+        }
+    };
+
+    /// The shared_ptr allocator which recycles its reference count blocks
+    template <class U>
+    class BlkAllocator
+    {
+    public:
+        typedef U value_type;
+        template <class V> struct rebind { typedef BlkAllocator<V> other; };
+
+        BlkAllocator(State *state) : mState(state) {}
+        template <class V>
+        BlkAllocator(const BlkAllocator<V> &other) : mState(other.mState) {}
+
+        U *allocate(size_t num)
+        {
+            void *blk = NULL;
+            std::lock_guard<std::mutex> lock(mState->mtx);
+            if ((num == 1) && (mState->blkSize == sizeof(U)) &&
+                (mState->idleBlks.empty() == false)) {
+                blk = mState->idleBlks.back();
+                mState->idleBlks.pop_back();
+            } else {
+                blk = ::operator new(num * sizeof(U));
+            }
+            mState->numBlks++;
+            return (U *)blk;
+        }
+
+        void deallocate(U *blk, size_t num)
+        {
+            bool orphaned;
+            bool recycled = false;
+            {
+                std::lock_guard<std::mutex> lock(mState->mtx);
+                mState->numBlks--;
+                if ((num == 1) && ((mState->blkSize == 0) ||
+                    (mState->blkSize == sizeof(U))) &&
+                    (mState->idleBlks.size() < mState->maxIdle)) {
+                    mState->blkSize = sizeof(U);
+                    mState->idleBlks.push_back(blk);
+                    recycled = true;
+                }
+                orphaned = ((mState->alive == false) &&
+                    (mState->numBlks == 0));
+            }
+            if (recycled == false)
+                ::operator delete(blk);
+            if (orphaned)
+                delete mState;
+        }
+
+        bool operator==(const BlkAllocator &other) const
+            { return (mState == other.mState); }
+        bool operator!=(const BlkAllocator &other) const
+            { return (mState != other.mState); }
+
+    private:
+        template <class V> friend class BlkAllocator;
+
+        State *mState;
+    };
+
+    /**
+     * The shared_ptr deleter which returns cmds into the pool. It always runs
+     * before the cmd's block is returned, thus while the state still exists.
+     */
+    class Recycler
+    {
+    public:
+        Recycler(State *state) : mState(state) {}
+        void operator()(T *cmd)
+        {
+            // A deleter must not throw, a cmd which won't reset isn't reused
+            try {
+                cmd->Reset();
+            } catch (...) {
+                delete cmd;
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mState->mtx);
+                if (mState->alive && (mState->idle.size() < mState->maxIdle)) {
+                    mState->idle.push_back(cmd);
+                    mState->stats.recycled++;
+                    return;
+                }
+                mState->stats.deleted++;
+            }
+            delete cmd;
+        }
+
+    private:
+        State *mState;
+    };
+
+    State *mState;
+
+    CmdPool(const CmdPool &);
+    CmdPool &operator=(const CmdPool &);
+};
+
+
+#endif
@@ -16,6 +16,7 @@
 
 #include "getLogPage.h"
 #include "globals.h"
+#include "../Utils/binDump.h"
 
 #define NUMD_BITMASK        0x0fff
 
@@ -112,42 +113,56 @@ GetLogPage::Dump(DumpFilename filename, string fileHdr) const
 
     Cmd::Dump(filename, fileHdr);
 
+    if (BinDump::IsFramed()) {
+        BinDump::Write(filename, BINDUMP_LOGPAGE, 0, GetLID(),
+            GetROPrpBuffer(), GetPrpBufferSize(), "");
+        return;
+    }
+
     // Reopen the file and append the same data in a different format
     if ((fp = fopen(filename.c_str(), "a")) == NULL)
         throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
 
+    DumpDecoded(fp, GetROPrpBuffer(), GetPrpBufferSize(), GetLID());
+    fclose(fp);
+}
+
+
+void
+GetLogPage::DumpDecoded(FILE *fp, const uint8_t *buf, uint64_t bufSize,
+    uint16_t lid)
+{
     fprintf(fp, "\n------------------------------------------------------\n");
     fprintf(fp, "----Detailed decoding of the cmd payload as follows---\n");
     fprintf(fp, "------------------------------------------------------");
 
     // How do we interpret the data contained herein?
-    switch (GetLID()) {
+    switch (lid) {
     case LOGID_ERROR_INFO:
         for (int i = 0; i < ERRLOG_FENCE; i++)
-            Dump(fp, i, mErrLogMetrics);
+            Dump(fp, i, mErrLogMetrics, buf, bufSize);
         break;
 
     case LOGID_SMART_HEALTH:
         for (int i = 0; i < SMRTLOG_FENCE; i++)
-            Dump(fp, i, mSmartLogMetrics);
+            Dump(fp, i, mSmartLogMetrics, buf, bufSize);
         break;
 
     case LOGID_FW_SLOT:
         for (int i = 0; i < FWLOG_FENCE; i++)
-            Dump(fp, i, mFwLogMetrics);
+            Dump(fp, i, mFwLogMetrics, buf, bufSize);
         break;
 
     default:
-        fprintf(fp, "Unable to decode LID field: 0x%04X\n", GetLID());
+        fprintf(fp, "Unable to decode LID field: 0x%04X\n", lid);
         break;
     }
-
-    fclose(fp);
 }
 
 
 void
-GetLogPage::Dump(FILE *fp, int field, GetLogPageDataType *logData) const
+GetLogPage::Dump(FILE *fp, int field, GetLogPageDataType *logData,
+    const uint8_t *buf, uint64_t bufSize)
 {
     const uint8_t *data;
     const int BUF_SIZE = 20;
@@ -157,11 +172,11 @@ GetLogPage::Dump(FILE *fp, int field, GetLogPageDataType *logData) const
 
     fprintf(fp, "\n%s\n", logData[field].desc);
 
-    data = &((GetROPrpBuffer())[logData[field].offset]);
-    if ((logData[field].length + logData[field].offset) > GetPrpBufferSize()) {
+    data = &(buf[logData[field].offset]);
+    if ((logData[field].length + logData[field].offset) > bufSize) {
         LOG_ERR("Detected illegal definition in XXXLOG_TABLE");
         throw FrmwkEx(HERE, "Reference calc (%d): %d + %d >= %ld", field,
-            logData[field].length, logData[field].offset, GetPrpBufferSize());
+            logData[field].length, logData[field].offset, bufSize);
     }
 
     unsigned long addr = logData[field].offset;
@@ -76,6 +76,16 @@ public:
      */
     virtual void Dump(DumpFilename filename, string fileHdr) const;
 
+    /**
+     * Append the detailed decoding of a log page to an opened file.
+     * @param fp Pass the file to write
+     * @param buf Pass a copy of the get log page cmd's payload
+     * @param bufSize Pass the number of bytes within buf
+     * @param lid Pass the value of the LID field of the get log page cmd
+     */
+    static void DumpDecoded(FILE *fp, const uint8_t *buf, uint64_t bufSize,
+        uint16_t lid);
+
 
 private:
     /// Details the fields within the get log page error log
@@ -86,7 +96,8 @@ private:
     static GetLogPageDataType mFwLogMetrics[];
 
     /// General functions to support the more specific public versions
-    void Dump(FILE *fp, int field, GetLogPageDataType *idData) const;
+    static void Dump(FILE *fp, int field, GetLogPageDataType *idData,
+        const uint8_t *buf, uint64_t bufSize);
 };
 
 
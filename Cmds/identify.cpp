@@ -18,6 +18,7 @@
 #include "identify.h"
 #include "../Utils/buffers.h"
 #include "../Utils/fileSystem.h"
+#include "../Utils/binDump.h"
 #include "../Singletons/regDefs.h"
 #include "../globals.h"
 
@@ -143,28 +144,43 @@ Identify::Dump(DumpFilename filename, string fileHdr) const
 
     Cmd::Dump(filename, fileHdr);
 
+    if (BinDump::IsFramed()) {
+        BinDump::Write(filename, BINDUMP_IDENTIFY, 0, GetCNS(),
+            GetROPrpBuffer(), GetPrpBufferSize(), "");
+        return;
+    }
+
     // Reopen the file and append the same data in a different format
     if ((fp = fopen(filename.c_str(), "a")) == NULL)
         throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
 
+    DumpDecoded(fp, GetROPrpBuffer(), GetPrpBufferSize(), GetCNS());
+    fclose(fp);
+}
+
+
+void
+Identify::DumpDecoded(FILE *fp, const uint8_t *buf, uint64_t bufSize,
+    bool cns)
+{
     fprintf(fp, "\n------------------------------------------------------\n");
     fprintf(fp, "----Detailed decoding of the cmd payload as follows---\n");
     fprintf(fp, "------------------------------------------------------");
 
     // How do we interpret the data contained herein?
-    if (GetCNS()) {
+    if (cns) {
         for (int i = 0; i < IDCTRLRCAP_FENCE; i++)
-            Dump(fp, i, mIdCtrlrCapMetrics);
+            Dump(fp, i, mIdCtrlrCapMetrics, buf, bufSize);
     } else {
         for (int i = 0; i < IDNAMESPC_FENCE; i++)
-            Dump(fp, i, mIdNamespcType);
+            Dump(fp, i, mIdNamespcType, buf, bufSize);
     }
-    fclose(fp);
 }
 
 
 void
-Identify::Dump(FILE *fp, int field, IdentifyDataType *idData) const
+Identify::Dump(FILE *fp, int field, IdentifyDataType *idData,
+    const uint8_t *buf, uint64_t bufSize)
 {
     const uint8_t *data;
     const int BUF_SIZE = 40;
@@ -174,11 +190,11 @@ Identify::Dump(FILE *fp, int field, IdentifyDataType *idData) const
 
     fprintf(fp, "\n%s\n", idData[field].desc);
 
-    data = &((GetROPrpBuffer())[idData[field].offset]);
-    if ((idData[field].length + idData[field].offset) > GetPrpBufferSize()) {
+    data = &(buf[idData[field].offset]);
+    if ((idData[field].length + idData[field].offset) > bufSize) {
         LOG_ERR("Detected illegal definition in IDxxxxx_TABLE");
         throw FrmwkEx(HERE, "Reference calc (%d): %d + %d >= %ld", field,
-            idData[field].length, idData[field].offset, GetPrpBufferSize());
+            idData[field].length, idData[field].offset, bufSize);
     }
 
     unsigned long addr = idData[field].offset;
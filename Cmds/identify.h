@@ -98,6 +98,17 @@ public:
      */
     virtual void Dump(DumpFilename filename, string fileHdr) const;
 
+    /**
+     * Append the detailed decoding of an identify data struct to an opened
+     * file.
+     * @param fp Pass the file to write
+     * @param buf Pass a copy of the identify cmd's payload
+     * @param bufSize Pass the number of bytes within buf
+     * @param cns Pass the value of the CNS field of the identify cmd
+     */
+    static void DumpDecoded(FILE *fp, const uint8_t *buf, uint64_t bufSize,
+        bool cns);
+
 
 private:
     /// Details the fields within the identify controller capabilities struct
@@ -108,7 +119,8 @@ private:
 
     /// General functions to support the more specific public versions
     uint64_t GetValue(int field, IdentifyDataType *idData) const;
-    void Dump(FILE *fp, int field, IdentifyDataType *idData) const;
+    static void Dump(FILE *fp, int field, IdentifyDataType *idData,
+        const uint8_t *buf, uint64_t bufSize);
 };
 
 
@@ -18,6 +18,7 @@
 #include "metaData.h"
 #include "globals.h"
 #include "../Utils/buffers.h"
+#include "../Utils/patternGen.h"
 #include "../Exception/frmwkEx.h"
 
 using namespace std;
@@ -67,7 +68,7 @@ void
 MetaData::SetMetaDataPattern(DataPattern dataPat, uint64_t initVal,
     uint32_t offset, uint32_t length)
 {
-    LOG_NRM("Write data pattern: initial value = 0x%016llX",
+    LOG_NRM("Write data pattern %d: initial value = 0x%016llX", dataPat,
         (long long unsigned int)initVal);
 
     if (GetMetaBuffer() == NULL)
@@ -77,68 +78,21 @@ MetaData::SetMetaDataPattern(DataPattern dataPat, uint64_t initVal,
     if ((length + offset) > GetMetaBufferSize())
         throw FrmwkEx(HERE, "Length exceeds total meta buffer allocated size");
 
-    switch (dataPat)
-    {
-    case DATAPAT_CONST_8BIT:
-        {
-            LOG_NRM("Write data pattern: constant 8 bit");
-            uint8_t *rawPtr = GetMetaBuffer() + offset;
-            for (uint64_t i = 0; i < length; i++)
-                *rawPtr++ = (uint8_t)initVal;
-        }
-        break;
-
-    case DATAPAT_CONST_16BIT:
-        {
-            LOG_NRM("Write data pattern: constant 16 bit");
-            uint16_t *rawPtr = (uint16_t *)(GetMetaBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint16_t)); i++)
-                *rawPtr++ = (uint16_t)initVal;
-        }
-        break;
-
-    case DATAPAT_CONST_32BIT:
-        {
-            LOG_NRM("Write data pattern: constant 32 bit");
-            uint32_t *rawPtr = (uint32_t *)(GetMetaBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint32_t)); i++)
-                *rawPtr++ = (uint32_t)initVal;
-        }
-        break;
-
-    case DATAPAT_INC_8BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 8 bit");
-            uint8_t *rawPtr = GetMetaBuffer() + offset;
-            for (uint64_t i = 0; i < length; i++)
-                *rawPtr++ = (uint8_t)initVal++;
-        }
-        break;
-
-    case DATAPAT_INC_16BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 16 bit");
-            uint16_t *rawPtr = (uint16_t *)(GetMetaBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint16_t)); i++)
-                *rawPtr++ = (uint16_t)initVal++;
-        }
-        break;
-
-    case DATAPAT_INC_32BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 32 bit");
-            uint32_t *rawPtr = (uint32_t *)(GetMetaBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint32_t)); i++)
-                *rawPtr++ = (uint32_t)initVal++;
-        }
-        break;
-
-    default:
+    if (PatternGen::Fill(dataPat, initVal, (GetMetaBuffer() + offset),
+        length) == false) {
         throw FrmwkEx(HERE, "Unsupported data pattern %d", dataPat);
     }
 }
 
 
+void
+MetaData::ReleaseMetaBuffer()
+{
+    gRsrcMngr->ReleaseMetaBuf(mMetaData);
+    mMetaData = MetaDataBuf();
+}
+
+
 bool
 MetaData::CompareMetaBuffer(SharedMemBufferPtr compTo)
 {
@@ -109,6 +109,12 @@ public:
      */
     bool CompareMetaBuffer(SharedMemBufferPtr compTo);
 
+    /**
+     * Return any meta data buffer allocated by AllocMetaBuffer() to the
+     * RsrcMngr, thus disassociating it from this cmd so the cmd can be reused.
+     */
+    void ReleaseMetaBuffer();
+
 private:
     MetaDataBuf mMetaData;
 };
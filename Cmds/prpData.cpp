@@ -103,6 +103,16 @@ PrpData::SetPrpBuffer(send_64b_bitmask prpFields, uint8_t const *memBuffer,
 }
 
 
+void
+PrpData::ResetPrpBuffer()
+{
+    mBufRW.reset();
+    mBufRO = NULL;
+    mBufSize = 0;
+    mPrpFields = (send_64b_bitmask)0;
+}
+
+
 uint8_t const *
 PrpData::GetROPrpBuffer() const
 {
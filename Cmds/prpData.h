@@ -109,6 +109,12 @@ protected:
     void SetPrpBuffer(send_64b_bitmask prpFields, uint8_t const *memBuffer,
         uint64_t bufSize);
 
+    /**
+     * Disassociate any buffer previously setup by either SetPrpBuffer()
+     * version, thus returning the PRP fields to their constructed state.
+     */
+    void ResetPrpBuffer();
+
     /**
      * Each cmd has unique requirements as to how its PRP ptrs can be
      * interpreted This method should be called during child class instantiation
@@ -15,6 +15,7 @@
  */
 
 #include "read.h"
+#include "../Utils/protInfo.h"
 
 
 SharedReadPtr Read::NullReadPtr;
@@ -255,3 +256,61 @@ Read::GetELBAT() const
     return GetWord(15, 0);
 }
 
+
+bool
+Read::VerifyTaggedDataPattern(uint32_t lbaDataSize, uint32_t generation,
+    uint64_t seed)
+{
+    SharedMemBufferPtr buf = GetRWPrpBuffer();
+    if (buf == MemBuffer::NullMemBufferPtr)
+        throw FrmwkEx(HERE, "Cmd has no RW PRP buffer to verify");
+    if (buf->GetBufSize() != ((GetNLB() + 1) * lbaDataSize)) {
+        throw FrmwkEx(HERE, "PRP buffer size 0x%08X != (NLB + 1) blks",
+            buf->GetBufSize());
+    }
+
+    BlkTagParams params = { GetNSID(), GetSLBA(), lbaDataSize, generation,
+        seed };
+    return buf->VerifyDataPattern(params);
+}
+
+
+void
+Read::SetProtInfo(ConstSharedIdentifyPtr idNamspc, uint8_t prchk,
+    uint16_t appTag, uint16_t appTagMask)
+{
+    ProtInfoParams params;
+
+    if (ProtInfo::GetParams(idNamspc, params) == false)
+        throw FrmwkEx(HERE, "Namspc is not formatted with PI");
+
+    if (params.type == PITYPE_1)
+        SetEILBRT((uint32_t)GetSLBA());
+    SetPRINFO(prchk & PRCHK_ALL);
+    SetELBAT(appTag);
+    SetELBATM(appTagMask);
+}
+
+
+bool
+Read::VerifyProtInfo(ConstSharedIdentifyPtr idNamspc)
+{
+    ProtInfoParams params;
+    ProtInfoResult result;
+    uint8_t *data;
+    uint8_t *meta;
+
+    if (ProtInfo::GetParams(idNamspc, params) == false)
+        throw FrmwkEx(HERE, "Namspc is not formatted with PI");
+
+    params.prchk = (GetPRINFO() & PRCHK_ALL);
+    params.refTag = GetEILBRT();
+    params.appTag = GetELBAT();
+    params.appTagMask = GetELBATM();
+    ProtInfo::GetBuffers(*this, params, (GetNLB() + 1), data, meta);
+    if (ProtInfo::Verify(params, data, meta, (GetNLB() + 1), result) == false) {
+        ProtInfo::Log(result);
+        return false;
+    }
+    return true;
+}
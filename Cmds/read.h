@@ -18,6 +18,7 @@
 #define _READ_H_
 
 #include "cmd.h"
+#include "identify.h"
 
 
 class Read;    // forward definition
@@ -125,6 +126,40 @@ public:
      */
     void     SetELBAT(uint16_t elbat);
     uint16_t GetELBAT() const;
+
+    /**
+     * Verify the RW PRP buffer contains the logical blocks which would have
+     * been written by Write::SetTaggedDataPattern() given the same NSID,
+     * SLBA and parameters. Upon failure the details are logged.
+     * @param lbaDataSize Pass the LBA data size of the namspc
+     * @param generation Pass the generation which was written
+     * @param seed Pass the seed which was written
+     * @return true when every block verified, otherwise false
+     */
+    bool VerifyTaggedDataPattern(uint32_t lbaDataSize, uint32_t generation,
+        uint64_t seed);
+
+    /**
+     * Set PRINFO, EILBRT, ELBAT and ELBATM for reading end to end protection
+     * information (PI), see class ProtInfo. SLBA must already be set. Type 1
+     * namspcs use the lower 32 bits of SLBA as EILBRT, the other types use
+     * the EILBRT which is already set.
+     * @param idNamspc Pass the identify namspc data of NSID
+     * @param prchk Pass the PRCHK_* fields the DUT is to check
+     * @param appTag Pass the expected application tag
+     * @param appTagMask Pass which application tag bits are to be checked
+     */
+    void SetProtInfo(ConstSharedIdentifyPtr idNamspc, uint8_t prchk,
+        uint16_t appTag = 0, uint16_t appTagMask = 0xffff);
+
+    /**
+     * Verify the PI which was read into this cmd's data or meta data buffer
+     * against PRINFO, EILBRT, ELBAT and ELBATM. Upon failure the details are
+     * logged.
+     * @param idNamspc Pass the identify namspc data of NSID
+     * @return true when the PI of every block verified, otherwise false
+     */
+    bool VerifyProtInfo(ConstSharedIdentifyPtr idNamspc);
 };
 
 
@@ -15,6 +15,7 @@
  */
 
 #include "write.h"
+#include "../Utils/protInfo.h"
 
 
 SharedWritePtr Write::NullWritePtr;
@@ -255,3 +256,46 @@ Write::GetLBAT() const
     return GetWord(15, 0); 
 }
 
+
+void
+Write::SetTaggedDataPattern(uint32_t lbaDataSize, uint32_t generation,
+    uint64_t seed)
+{
+    SharedMemBufferPtr buf = GetRWPrpBuffer();
+    if (buf == MemBuffer::NullMemBufferPtr)
+        throw FrmwkEx(HERE, "Cmd has no RW PRP buffer to fill");
+    if (buf->GetBufSize() != ((GetNLB() + 1) * lbaDataSize)) {
+        throw FrmwkEx(HERE, "PRP buffer size 0x%08X != (NLB + 1) blks",
+            buf->GetBufSize());
+    }
+
+    BlkTagParams params = { GetNSID(), GetSLBA(), lbaDataSize, generation,
+        seed };
+    buf->SetDataPattern(params);
+}
+
+
+void
+Write::SetProtInfo(ConstSharedIdentifyPtr idNamspc, uint8_t prchk,
+    uint16_t appTag, uint16_t appTagMask)
+{
+    ProtInfoParams params;
+    uint8_t *data;
+    uint8_t *meta;
+
+    if (ProtInfo::GetParams(idNamspc, params) == false)
+        throw FrmwkEx(HERE, "Namspc is not formatted with PI");
+
+    if (params.type == PITYPE_1)
+        SetILBRT((uint32_t)GetSLBA());
+    SetPRINFO(prchk & PRCHK_ALL);
+    SetLBAT(appTag);
+    SetLBATM(appTagMask);
+
+    params.prchk = (prchk & PRCHK_ALL);
+    params.refTag = GetILBRT();
+    params.appTag = appTag;
+    params.appTagMask = appTagMask;
+    ProtInfo::GetBuffers(*this, params, (GetNLB() + 1), data, meta);
+    ProtInfo::Generate(params, data, meta, (GetNLB() + 1));
+}
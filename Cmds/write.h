@@ -18,6 +18,7 @@
 #define _WRITE_H_
 
 #include "cmd.h"
+#include "identify.h"
 
 
 class Write;    // forward definition
@@ -125,6 +126,32 @@ public:
      */
     void     SetLBAT(uint16_t lbat);
     uint16_t GetLBAT() const;
+
+    /**
+     * Fill the RW PRP buffer with self describing logical blocks, see class
+     * BlkTag, tagged with this cmd's NSID, SLBA and NLB. Thus NSID, SLBA and
+     * NLB must be set and the buffer must be (NLB + 1) blocks.
+     * @param lbaDataSize Pass the LBA data size of the namspc
+     * @param generation Pass a count which changes every time the same LBA's
+     *        are rewritten
+     * @param seed Pass the seed of the PRNG data within every block
+     */
+    void SetTaggedDataPattern(uint32_t lbaDataSize, uint32_t generation,
+        uint64_t seed);
+
+    /**
+     * Generate end to end protection information (PI), see class ProtInfo,
+     * into this cmd's data or meta data buffer, and set PRINFO, ILBRT, LBAT
+     * and LBATM to match. NSID, SLBA, NLB and the buffers must already be
+     * set. Type 1 namspcs use the lower 32 bits of SLBA as ILBRT, the other
+     * types use the ILBRT which is already set.
+     * @param idNamspc Pass the identify namspc data of NSID
+     * @param prchk Pass the PRCHK_* fields the DUT is to check
+     * @param appTag Pass the application tag
+     * @param appTagMask Pass which application tag bits are to be checked
+     */
+    void SetProtInfo(ConstSharedIdentifyPtr idNamspc, uint8_t prchk,
+        uint16_t appTag = 0, uint16_t appTagMask = 0xffff);
 };
 
 
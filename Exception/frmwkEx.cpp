@@ -16,17 +16,22 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <thread>
 #include "frmwkEx.h"
 #include "tnvme.h"
 #include "globals.h"
 #include "../Utils/kernelAPI.h"
 #include "../Utils/io.h"
+#include "../Utils/flightRec.h"
 #include "../Cmds/getLogPage.h"
 
 #define GRP_NAME            "post"
 #define TEST_NAME           "failure"
 
-bool FrmwkEx::mPrelimProcessingInProgress = false;
+std::atomic<bool> FrmwkEx::mPrelimProcessingInProgress(false);
+
+// Static initialization occurs upon the main thread, before main() runs
+static const std::thread::id mainThreadId = std::this_thread::get_id();
 
 
 FrmwkEx::FrmwkEx(string filename, int lineNum)
@@ -71,6 +76,20 @@ FrmwkEx::~FrmwkEx()
 void
 FrmwkEx::DumpStateOfTheSystem()
 {
+    // IOWorker threads catch and record their exceptions; the main thread
+    // rethrows them once every worker has stopped, and only then may the
+    // DUT be dumped and disabled.
+    if (std::this_thread::get_id() != mainThreadId) {
+        LOG_NRM("Exception within a worker thread, deferring to main thread");
+        return;
+    }
+
+    // Whatever led to this exception must be visible before the DUT is dumped
+    Logger::Flush();
+
+    // So must the dumps which led up to it, and those to follow bypass it
+    FlightRec::Flush();
+
     // Mark this point in /var/log/messages from dnvme's logging output
     KernelAPI::WriteToDnvmeLog("-------START POST FAILURE STATE DUMP-------");
     LOG_NRM("-------------------------------------------");
@@ -18,6 +18,7 @@
 #define _FRMWKEX_H_
 
 #include <string>
+#include <atomic>
 
 using namespace std;
 
@@ -54,7 +55,7 @@ private:
     FrmwkEx();
 
     string mMsg;
-    static bool mPrelimProcessingInProgress;
+    static std::atomic<bool> mPrelimProcessingInProgress;
 
     void DumpStateOfTheSystem();
 };
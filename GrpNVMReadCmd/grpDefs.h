@@ -27,6 +27,9 @@ namespace GrpNVMReadCmd {
 #define IOSQ_GROUP_ID               "IOSQ"
 #define IOQ_ID                      1
 
+// App tag of E2E protected cmds; 0xffff disables PI checking, never use it
+#define E2E_APPTAG                  0x5aa5
+
 
 
 }   // namespace
@@ -23,6 +23,8 @@
 #include "../Utils/io.h"
 #include "../Utils/irq.h"
 #include "../Cmds/read.h"
+#include "../Cmds/write.h"
+#include "../Utils/protInfo.h"
 
 namespace GrpNVMReadCmd {
 
@@ -44,7 +46,9 @@ LBAOutOfRangeMeta_r10b::LBAOutOfRangeMeta_r10b(
         "requirements. 1) Issue cmd where 1st block starts at LBA "
         "(Identify.NSZE - 1), expect failure. 2) Issue cmd where 1st block "
         "starts at LBA Identify.NSZE, expect failure. 3) Issue cmd where 1st "
-        "block starts at 2nd to last max LBA value, expect success.");
+        "block starts at 2nd to last max LBA value, expect success. E2E "
+        "namspcs check the PI, so the last 2 LBA's are 1st written with "
+        "valid PI, and the PI read back is verified.");
 }
 
 
@@ -152,6 +156,7 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
+        case Informative::NS_E2ES:
             LOG_NRM("Meta mamespace with separate buffer. meta size = %d",
                 lbaFormat.MS);
             readMem->Init(RD_NUM_BLKS * lbaDataSize);
@@ -162,39 +167,78 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
             readCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
+        case Informative::NS_E2EI:
             LOG_NRM("Meta mamespace with extended LBA size = %ld.",
                 (lbaDataSize + lbaFormat.MS));
             readMem->Init(RD_NUM_BLKS * (lbaDataSize + lbaFormat.MS));
             break;
-        case Informative::NS_E2ES:
-        case Informative::NS_E2EI:
-            throw FrmwkEx(HERE, "Deferring work to handle this case in future");
-            break;
         }
+        bool e2e = ((nsType == Informative::NS_E2ES) ||
+            (nsType == Informative::NS_E2EI));
         LOG_NRM("Set read cmd options after buffer is allocated.");
         readCmd->SetPrpBuffer(prpBitmask, readMem);
         readCmd->SetNSID(meta[i]);
         readCmd->SetNLB(RD_NUM_BLKS - 1);    // convert to 0-based value
 
+        if (e2e) {
+            WriteProtInfo(iosq, iocq, meta[i], namSpcPtr, (nsze - 2),
+                readMem->GetBufSize());
+        }
+
         LOG_NRM("Issue cmd where 1st block starts at LBA (Identify.NSZE - 1)");
         work = str(boost::format("nsze-1.meta.%d") % (uint32_t)i);
         readCmd->SetSLBA(nsze - 1);
+        if (e2e)
+            readCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
         SendCmdToHdw(iosq, iocq, readCmd, work);
 
         LOG_NRM("Issue cmd where 1st block starts at LBA (Identify.NSZE)");
         work = str(boost::format("nsze.meta.%d") % (uint32_t)i);
         readCmd->SetSLBA(nsze);
+        if (e2e)
+            readCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
         SendCmdToHdw(iosq, iocq, readCmd, work);
 
         LOG_NRM("Issue cmd where 1st block starts at LBA (Identify.NSZE - 2)");
         work = str(boost::format("nsze-2.meta.%d") % (uint32_t)i);
         readCmd->SetSLBA(nsze - 2);
+        if (e2e)
+            readCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
         IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
             iocq, readCmd, work, true);
+
+        if (e2e && (readCmd->VerifyProtInfo(namSpcPtr) == false))
+            throw FrmwkEx(HERE, "End to end protection miscompare");
     }
 }
 
 
+void
+LBAOutOfRangeMeta_r10b::WriteProtInfo(SharedIOSQPtr iosq, SharedIOCQPtr iocq,
+    uint32_t nsid, ConstSharedIdentifyPtr namSpcPtr, uint64_t slba,
+    uint32_t bufSize)
+{
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+
+    LOG_NRM("Write LBA 0x%016llX with valid PI for the read cmd to check",
+        (long long unsigned int)slba);
+    SharedWritePtr writeCmd = SharedWritePtr(new Write());
+    SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
+    writeMem->Init(bufSize);
+    if (gInformative->IdentifyNamespace(namSpcPtr) == Informative::NS_E2ES)
+        writeCmd->AllocMetaBuffer();
+
+    writeCmd->SetPrpBuffer(prpBitmask, writeMem);
+    writeCmd->SetNSID(nsid);
+    writeCmd->SetNLB(RD_NUM_BLKS - 1);    // convert to 0-based value
+    writeCmd->SetSLBA(slba);
+    writeCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq, iocq,
+        writeCmd, "protInfo", true);
+}
+
+
 void
 LBAOutOfRangeMeta_r10b::SendCmdToHdw(SharedSQPtr sq, SharedCQPtr cq,
     SharedCmdPtr cmd, string qualify)
@@ -19,6 +19,7 @@
 
 #include "test.h"
 #include "../Utils/queues.h"
+#include "../Cmds/identify.h"
 
 namespace GrpNVMReadCmd {
 
@@ -58,6 +59,8 @@ private:
         string qualify);
     void CreateIOQs(SharedASQPtr asq, SharedACQPtr acq, uint32_t ioqId,
        SharedIOSQPtr &iosq, SharedIOCQPtr &iocq);
+    void WriteProtInfo(SharedIOSQPtr iosq, SharedIOCQPtr iocq, uint32_t nsid,
+        ConstSharedIdentifyPtr namSpcPtr, uint64_t slba, uint32_t bufSize);
 };
 
 }   // namespace
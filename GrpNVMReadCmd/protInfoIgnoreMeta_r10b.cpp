@@ -21,6 +21,8 @@
 #include "../Utils/io.h"
 #include "../Utils/irq.h"
 #include "../Cmds/read.h"
+#include "../Cmds/write.h"
+#include "../Utils/protInfo.h"
 
 namespace GrpNVMReadCmd {
 
@@ -37,7 +39,9 @@ ProtInfoIgnoreMeta_r10b::ProtInfoIgnoreMeta_r10b(
         "For all meta namspcs from Identify.NN; For each namspc issue multiple "
         "read cmds where each is reading 1 data block at LBA 0 and approp "
         "metadata requirements, and vary the values of DW12.PRINFO "
-        "from 0x0 to 0x0f, expect success for all.");
+        "from 0x0 to 0x0f, expect success for all. E2E namspcs check the "
+        "PI, so LBA 0 is 1st written with valid PI, and the PI read back "
+        "is verified unless PRINFO.PRACT strips it.");
 }
 
 
@@ -143,25 +147,35 @@ ProtInfoIgnoreMeta_r10b::RunCoreTest()
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
+        case Informative::NS_E2ES:
             readMem->Init(lbaDataSize);
             if (gRsrcMngr->SetMetaAllocSize(lbaFormat.MS) == false)
                 throw FrmwkEx(HERE);
             readCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
-            readMem->Init(lbaDataSize + lbaFormat.MS);
-            break;
-        case Informative::NS_E2ES:
         case Informative::NS_E2EI:
-            throw FrmwkEx(HERE, "Deferring work to handle this case in future");
+            readMem->Init(lbaDataSize + lbaFormat.MS);
             break;
         }
+        bool e2e = ((nsType == Informative::NS_E2ES) ||
+            (nsType == Informative::NS_E2EI));
 
         readCmd->SetPrpBuffer(prpBitmask, readMem);
         readCmd->SetNSID(meta[i]);
         readCmd->SetNLB(0);    // convert to 0-based value
 
+        if (e2e) {
+            WriteProtInfo(iosq, iocq, meta[i], namSpcPtr,
+                readMem->GetBufSize());
+        }
+
         for (uint16_t protInfo = 0; protInfo <= 0x0f; protInfo++) {
+            if (e2e) {
+                readCmd->SetProtInfo(namSpcPtr, (protInfo & PRCHK_ALL),
+                    E2E_APPTAG);
+            }
+
             uint8_t work = readCmd->GetByte(12, 3);
             work &= ~0x3c;  // PRINFO specific bits
             work |= (protInfo << 2);
@@ -171,11 +185,40 @@ ProtInfoIgnoreMeta_r10b::RunCoreTest()
                 (uint32_t)i % protInfo);
             IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
                 iocq, readCmd, context, true);
+
+            if (e2e && ((protInfo & PRINFO_PRACT) == 0) &&
+                (readCmd->VerifyProtInfo(namSpcPtr) == false)) {
+                throw FrmwkEx(HERE, "End to end protection miscompare");
+            }
         }
     }
 }
 
 
+void
+ProtInfoIgnoreMeta_r10b::WriteProtInfo(SharedIOSQPtr iosq,
+    SharedIOCQPtr iocq, uint32_t nsid, ConstSharedIdentifyPtr namSpcPtr,
+    uint32_t bufSize)
+{
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+
+    LOG_NRM("Write LBA 0 with valid PI for the read cmds to check");
+    SharedWritePtr writeCmd = SharedWritePtr(new Write());
+    SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
+    writeMem->Init(bufSize);
+    if (gInformative->IdentifyNamespace(namSpcPtr) == Informative::NS_E2ES)
+        writeCmd->AllocMetaBuffer();
+
+    writeCmd->SetPrpBuffer(prpBitmask, writeMem);
+    writeCmd->SetNSID(nsid);
+    writeCmd->SetNLB(0);    // convert to 0-based value
+    writeCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
+    IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq, iocq,
+        writeCmd, "protInfo", true);
+}
+
+
 void
 ProtInfoIgnoreMeta_r10b::CreateIOQs(SharedASQPtr asq, SharedACQPtr acq,
     uint32_t ioqId, SharedIOSQPtr &iosq, SharedIOCQPtr &iocq)
@@ -19,6 +19,7 @@
 
 #include "test.h"
 #include "../Utils/queues.h"
+#include "../Cmds/identify.h"
 
 namespace GrpNVMReadCmd {
 
@@ -56,6 +57,8 @@ private:
     ///////////////////////////////////////////////////////////////////////////
     void CreateIOQs(SharedASQPtr asq, SharedACQPtr acq, uint32_t ioqId,
        SharedIOSQPtr &iosq, SharedIOCQPtr &iocq);
+    void WriteProtInfo(SharedIOSQPtr iosq, SharedIOCQPtr iocq, uint32_t nsid,
+        ConstSharedIdentifyPtr namSpcPtr, uint32_t bufSize);
 };
 
 }   // namespace
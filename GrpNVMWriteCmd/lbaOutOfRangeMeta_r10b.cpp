@@ -23,6 +23,7 @@
 #include "../Utils/io.h"
 #include "../Utils/irq.h"
 #include "../Cmds/write.h"
+#include "../Utils/protInfo.h"
 
 namespace GrpNVMWriteCmd {
 
@@ -44,7 +45,8 @@ LBAOutOfRangeMeta_r10b::LBAOutOfRangeMeta_r10b(
         "requirements. 1) Issue cmd where 1st block starts at LBA "
         "(Identify.NSZE - 1), expect failure. 2) Issue cmd where 1st block "
         "starts at LBA Identify.NSZE, expect failure. 3) Issue cmd where 1st "
-        "block starts at 2nd to last max LBA value, expect success.");
+        "block starts at 2nd to last max LBA value, expect success. E2E "
+        "namspcs send valid PI for each starting LBA.");
 }
 
 
@@ -150,6 +152,7 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
+        case Informative::NS_E2ES:
             writeMem->Init(WR_NUM_BLKS * lbaDataSize);
             if (gRsrcMngr->SetMetaAllocSize(WR_NUM_BLKS * lbaFormat.MS)
                 == false) {
@@ -158,13 +161,12 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
             writeCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
-            writeMem->Init(WR_NUM_BLKS * (lbaDataSize + lbaFormat.MS));
-            break;
-        case Informative::NS_E2ES:
         case Informative::NS_E2EI:
-            throw FrmwkEx(HERE, "Deferring work to handle this case in future");
+            writeMem->Init(WR_NUM_BLKS * (lbaDataSize + lbaFormat.MS));
             break;
         }
+        bool e2e = ((nsType == Informative::NS_E2ES) ||
+            (nsType == Informative::NS_E2EI));
         writeCmd->SetPrpBuffer(prpBitmask, writeMem);
         writeCmd->SetNSID(meta[i]);
         writeCmd->SetNLB(WR_NUM_BLKS - 1);    // convert to 0-based value
@@ -172,16 +174,22 @@ LBAOutOfRangeMeta_r10b::RunCoreTest()
         LOG_NRM("Issue cmd where 1st block starts at LBA (Identify.NSZE - 1)");
         work = str(boost::format("nsze-1.meta.%d") % (uint32_t)i);
         writeCmd->SetSLBA(nsze - 1);
+        if (e2e)
+            writeCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
         SendCmdToHdw(iosq, iocq, writeCmd, work);
 
         LOG_NRM("Issue cmd where 1st block starts at LBA (Identify.NSZE)");
         work = str(boost::format("nsze.meta.%d") % (uint32_t)i);
         writeCmd->SetSLBA(nsze);
+        if (e2e)
+            writeCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
         SendCmdToHdw(iosq, iocq, writeCmd, work);
 
         LOG_NRM("Issue cmd where 1st block starts at LBA (Identify.NSZE - 2)");
         work = str(boost::format("nsze-2.meta.%d") % (uint32_t)i);
         writeCmd->SetSLBA(nsze - 2);
+        if (e2e)
+            writeCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
         IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
             iocq, writeCmd, work, true);
     }
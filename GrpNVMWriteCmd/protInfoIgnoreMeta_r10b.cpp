@@ -21,6 +21,7 @@
 #include "../Utils/io.h"
 #include "../Utils/irq.h"
 #include "../Cmds/write.h"
+#include "../Utils/protInfo.h"
 
 namespace GrpNVMWriteCmd {
 
@@ -37,7 +38,8 @@ ProtInfoIgnoreMeta_r10b::ProtInfoIgnoreMeta_r10b(
         "For all meta namspcs from Identify.NN; For each namspc issue multiple "
         "write cmds where each is sending 1 data block at LBA 0 and approp "
         "metadata requirements, and vary the values of DW12.PRINFO "
-        "from 0x0 to 0x0f, expect success for all.");
+        "from 0x0 to 0x0f, expect success for all. E2E namspcs check the "
+        "PI, so valid PI is generated for each value of PRINFO.PRCHK.");
 }
 
 
@@ -142,25 +144,30 @@ ProtInfoIgnoreMeta_r10b::RunCoreTest()
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
+        case Informative::NS_E2ES:
             writeMem->Init(lbaDataSize);
             if (gRsrcMngr->SetMetaAllocSize(lbaFormat.MS) == false)
                 throw FrmwkEx(HERE);
             writeCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
-            writeMem->Init(lbaDataSize + lbaFormat.MS);
-            break;
-        case Informative::NS_E2ES:
         case Informative::NS_E2EI:
-            throw FrmwkEx(HERE, "Deferring work to handle this case in future");
+            writeMem->Init(lbaDataSize + lbaFormat.MS);
             break;
         }
+        bool e2e = ((nsType == Informative::NS_E2ES) ||
+            (nsType == Informative::NS_E2EI));
 
         writeCmd->SetPrpBuffer(prpBitmask, writeMem);
         writeCmd->SetNSID(meta[i]);
         writeCmd->SetNLB(0);    // convert to 0-based value
 
         for (uint16_t protInfo = 0; protInfo <= 0x0f; protInfo++) {
+            if (e2e) {
+                writeCmd->SetProtInfo(namSpcPtr, (protInfo & PRCHK_ALL),
+                    E2E_APPTAG);
+            }
+
             uint8_t work = writeCmd->GetByte(12, 3);
             work &= ~0x3c;  // PRINFO specific bits
             work |= (protInfo << 2);
@@ -22,12 +22,15 @@
 #include "../Queues/iosq.h"
 #include "../Cmds/write.h"
 #include "../Utils/io.h"
+#include "../Utils/buffers.h"
 
 
 namespace GrpNVMWriteReadCombo {
 
 // Maximum number of bits for logical blks (NLB) in cmd DWORD 12 for rd/wr cmd.
 #define CDW12_NLB_BITS          16
+// Seeds the PRNG body of the tagged blks, see class BlkTag
+#define TAGGED_BLK_SEED         0x4e4c424142617265ULL
 
 
 NLBABare_r10b::NLBABare_r10b(
@@ -44,9 +47,12 @@ NLBABare_r10b::NLBABare_r10b(
         "values for DW12.NLB from 0 to {0xffff | (Identify.MDTS / "
         "Identify.LBAF[Identify.FLBAS].LBADS) | NCAP} "
         "which ever is less. Each write cmd should use a new data pattern by "
-        "rolling through {byte++, byteK, word++, wordK, dword++, dwordK}. "
-        "After each write cmd completes issue a correlating read cmd through "
-        "the same parameters verifying the data pattern.");
+        "rolling through {byte++, byteK, word++, wordK, dword++, dwordK, "
+        "tagged}. Tagged blks name their NSID, LBA and write generation, "
+        "the NLB being the generation, so that a blk which was misdirected, "
+        "never rewritten or torn is identified. After each write cmd "
+        "completes issue a correlating read cmd through the same parameters "
+        "verifying the data pattern.");
 }
 
 
@@ -134,6 +140,7 @@ NLBABare_r10b::RunCoreTest()
         DATAPAT_CONST_32BIT
     };
     uint64_t dpArrSize = sizeof(dataPat) / sizeof(dataPat[0]);
+    uint64_t numPatterns = (dpArrSize + 1);     // The last is tagged blks
 
     vector<uint32_t> bare = gInformative->GetBareNamespaces();
     for (size_t i = 0; i < bare.size(); i++) {
@@ -161,7 +168,14 @@ NLBABare_r10b::RunCoreTest()
                 writeMem->Init(nLBA * lbaDataSize);
                 writeCmd->SetPrpBuffer(prpBitmask, writeMem);
                 writeCmd->SetNLB(nLBA - 1); // 0 based value.
-                writeMem->SetDataPattern(dataPat[(nLBA - 1) % dpArrSize], nLBA);
+                bool tagged = (((nLBA - 1) % numPatterns) == dpArrSize);
+                DataPattern pattern = dataPat[(nLBA - 1) % dpArrSize];
+                if (tagged) {
+                    writeCmd->SetTaggedDataPattern(lbaDataSize, nLBA,
+                        TAGGED_BLK_SEED);
+                } else {
+                    writeMem->SetDataPattern(pattern, nLBA);
+                }
 
                 readMem->Init(nLBA * lbaDataSize);
                 readCmd->SetPrpBuffer(prpBitmask, readMem);
@@ -178,7 +192,10 @@ NLBABare_r10b::RunCoreTest()
                 IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
                     iocq, readCmd, work, enableLog);
 
-                VerifyDataPat(readCmd, writeMem);
+                if (tagged)
+                    VerifyTaggedDataPat(readCmd, nLBA, lbaDataSize);
+                else
+                    VerifyDataPat(readCmd, pattern, nLBA, lbaDataSize);
             }
         }
     }
@@ -187,23 +204,46 @@ NLBABare_r10b::RunCoreTest()
 
 
 void
-NLBABare_r10b::VerifyDataPat(SharedReadPtr readCmd,
-    SharedMemBufferPtr wrPayload)
+NLBABare_r10b::VerifyDataPat(SharedReadPtr readCmd, DataPattern dataPat,
+    uint64_t initVal, uint64_t lbaDataSize)
 {
-    LOG_NRM("Compare read vs written data to verify");
+    Miscompare result;
+
+    LOG_NRM("Verify read data against the written data pattern");
     SharedMemBufferPtr rdPayload = readCmd->GetRWPrpBuffer();
-    if (rdPayload->Compare(wrPayload) == false) {
+    if (rdPayload->VerifyDataPattern(dataPat, initVal, 0, UINT32_MAX,
+        lbaDataSize, result) == false) {
         readCmd->Dump(
             FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadCmd"),
             "Read command");
-        rdPayload->Dump(
+
+        // Payloads may be MB's, only dump the 1st range which miscompared
+        MiscompareRange range = result.ranges[0];
+        string hdr = str(boost::format("Data read from media miscompared "
+            "from written pattern %d, initial value 0x%lX; LBA's @ offset "
+            "0x%08X, length 0x%08X") % dataPat % initVal % range.offset %
+            range.length);
+        Buffers::Dump(
             FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadPayload"),
-            "Data read from media miscompared from written");
-        wrPayload->Dump(
-            FileSystem::PrepDumpFile(mGrpName, mTestName, "WrittenPayload"),
-            "Data read from media miscompared from written");
+            rdPayload->GetBuffer(), range.offset, range.length,
+            rdPayload->GetBufSize(), hdr);
         throw FrmwkEx(HERE, "Data miscompare");
     }
 }
 
+
+void
+NLBABare_r10b::VerifyTaggedDataPat(SharedReadPtr readCmd, uint32_t generation,
+    uint64_t lbaDataSize)
+{
+    LOG_NRM("Verify read data against the written tagged blks");
+    if (readCmd->VerifyTaggedDataPattern(lbaDataSize, generation,
+        TAGGED_BLK_SEED) == false) {
+        readCmd->Dump(
+            FileSystem::PrepDumpFile(mGrpName, mTestName, "ReadCmd"),
+            "Read command");
+        throw FrmwkEx(HERE, "Tagged blk miscompare");
+    }
+}
+
 }   // namespace
@@ -54,7 +54,10 @@ private:
     ///////////////////////////////////////////////////////////////////////////
     // Adding a member variable? Then edit the copy constructor and operator=().
     ///////////////////////////////////////////////////////////////////////////
-    void VerifyDataPat(SharedReadPtr readCmd, SharedMemBufferPtr wrPayload);
+    void VerifyDataPat(SharedReadPtr readCmd, DataPattern dataPat,
+        uint64_t initVal, uint64_t lbaDataSize);
+    void VerifyTaggedDataPat(SharedReadPtr readCmd, uint32_t generation,
+        uint64_t lbaDataSize);
 };
 
 }   // namespace
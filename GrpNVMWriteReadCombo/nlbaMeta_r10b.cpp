@@ -21,6 +21,7 @@
 #include "grpDefs.h"
 #include "../Utils/io.h"
 #include "../Utils/irq.h"
+#include "../Utils/protInfo.h"
 
 
 namespace GrpNVMWriteReadCombo {
@@ -173,6 +174,7 @@ NLBAMeta_r10b::RunCoreTest()
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
+        case Informative::NS_E2ES:
             LOG_NRM("Process for separate meta buffer");
             if (maxDtXferSz != 0)
                 maxWrBlks = MIN(maxWrBlks, (maxDtXferSz / lbaDataSize));
@@ -183,17 +185,16 @@ NLBAMeta_r10b::RunCoreTest()
             readCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
+        case Informative::NS_E2EI:
             LOG_NRM("Process for integrated meta buffer");
             if (maxDtXferSz != 0) {
                 maxWrBlks = MIN(maxWrBlks,
                     (maxDtXferSz / (lbaDataSize + lbaFormat.MS)));
             }
             break;
-        case Informative::NS_E2ES:
-        case Informative::NS_E2EI:
-            throw FrmwkEx(HERE, "Deferring work to handle this case in future");
-            break;
         }
+        bool e2e = ((nsType == Informative::NS_E2ES) ||
+            (nsType == Informative::NS_E2EI));
         writeCmd->SetNSID(meta[i]);
         readCmd->SetNSID(meta[i]);
 
@@ -214,6 +215,7 @@ NLBAMeta_r10b::RunCoreTest()
                 case Informative::NS_BARE:
                     throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
                 case Informative::NS_METAS:
+                case Informative::NS_E2ES:
                     writeMem->Init(nLBA * lbaDataSize);
                     readMem->Init(nLBA * lbaDataSize);
                     metaBuffSz = nLBA * lbaFormat.MS;
@@ -221,13 +223,10 @@ NLBAMeta_r10b::RunCoreTest()
                         (dataPat[(nLBA - 1) % dpArrSize], nLBA);
                     break;
                 case Informative::NS_METAI:
+                case Informative::NS_E2EI:
                     writeMem->Init(nLBA * (lbaDataSize + lbaFormat.MS));
                     readMem->Init(nLBA * (lbaDataSize + lbaFormat.MS));
                     break;
-                case Informative::NS_E2ES:
-                case Informative::NS_E2EI:
-                    throw FrmwkEx(HERE, "Deferring work to handle in future");
-                    break;
                 }
 
                 writeCmd->SetPrpBuffer(prpBitmask, writeMem);
@@ -237,6 +236,12 @@ NLBAMeta_r10b::RunCoreTest()
                 readCmd->SetPrpBuffer(prpBitmask, readMem);
                 readCmd->SetNLB(nLBA - 1); // 0 based value.
 
+                if (e2e) {
+                    // PI overwrites the tail or head of each LBA's meta data
+                    writeCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
+                    readCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
+                }
+
                 enableLog = false;
                 if ((nLBA <= 8) || (nLBA >= (maxWrBlks - 8)))
                     enableLog = true;
@@ -248,6 +253,8 @@ NLBAMeta_r10b::RunCoreTest()
                 IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
                     iosq, iocq, readCmd, work, enableLog);
 
+                if (e2e && (readCmd->VerifyProtInfo(namSpcPtr) == false))
+                    throw FrmwkEx(HERE, "End to end protection miscompare");
                 VerifyDataPat(readCmd, writeCmd, metaBuffSz);
             }
         }
@@ -21,6 +21,7 @@
 #include "grpDefs.h"
 #include "../Utils/io.h"
 #include "../Utils/irq.h"
+#include "../Utils/protInfo.h"
 
 
 namespace GrpNVMWriteReadCombo {
@@ -42,7 +43,8 @@ StartingLBAMeta_r10b::StartingLBAMeta_r10b(
         "data pattern by rolling through {byte++, byteK, word++, wordK, "
         "dword++, dwordK}. After all writing completes issue correlating "
         "read cmds through the same range verifying the data pattern upon "
-        "each block.");
+        "each block. E2E namspcs also send valid PI with each write cmd and "
+        "verify the PI read back.");
 }
 
 
@@ -165,10 +167,13 @@ StartingLBAMeta_r10b::RunCoreTest()
         uint64_t metaBuffSz = 0;
 
         LOG_NRM("Set read and write buffers based on the namspc type");
-        switch (gInformative->IdentifyNamespace(namSpcPtr)) {
+        Informative::NamspcType nsType =
+            gInformative->IdentifyNamespace(namSpcPtr);
+        switch (nsType) {
         case Informative::NS_BARE:
             throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
         case Informative::NS_METAS:
+        case Informative::NS_E2ES:
             maxWrBlks = maxDtXferSz / lbaDataSize;
             metaBuffSz = maxWrBlks * lbaFormat.MS;
             if (gRsrcMngr->SetMetaAllocSize(metaBuffSz) == false)
@@ -181,17 +186,16 @@ StartingLBAMeta_r10b::RunCoreTest()
             readCmd->AllocMetaBuffer();
             break;
         case Informative::NS_METAI:
+        case Informative::NS_E2EI:
             maxWrBlks = maxDtXferSz / (lbaDataSize + lbaFormat.MS);
             LOG_NRM("Max rd/wr blks %ld using integrated meta buff of ncap %ld",
                 maxWrBlks, ncap);
             writeMem->Init(maxWrBlks * (lbaDataSize + lbaFormat.MS));
             readMem->Init(maxWrBlks * (lbaDataSize + lbaFormat.MS));
             break;
-        case Informative::NS_E2ES:
-        case Informative::NS_E2EI:
-            throw FrmwkEx(HERE, "Deferring work to handle this case in future");
-            break;
         }
+        bool e2e = ((nsType == Informative::NS_E2ES) ||
+            (nsType == Informative::NS_E2EI));
 
         writeCmd->SetPrpBuffer(prpBitmask, writeMem);
         writeCmd->SetNSID(meta[i]);
@@ -219,6 +223,11 @@ StartingLBAMeta_r10b::RunCoreTest()
             }
             writeCmd->SetSLBA(sLBA);
             readCmd->SetSLBA(sLBA);
+            if (e2e) {
+                // PI overwrites the tail or head of each LBA's meta data
+                writeCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
+                readCmd->SetProtInfo(namSpcPtr, PRCHK_ALL, E2E_APPTAG);
+            }
 
             enableLog = false;
             if ((sLBA <= maxWrBlks) || (sLBA >= (ncap - 2 * maxWrBlks)))
@@ -232,6 +241,8 @@ StartingLBAMeta_r10b::RunCoreTest()
             IO::SendAndReapCmd(mGrpName, mTestName, CALC_TIMEOUT_ms(1), iosq,
                 iocq, readCmd, work, enableLog);
 
+            if (e2e && (readCmd->VerifyProtInfo(namSpcPtr) == false))
+                throw FrmwkEx(HERE, "End to end protection miscompare");
             VerifyDataPat(readCmd, writeCmd, metaBuffSz);
         }
     }
@@ -328,19 +339,17 @@ StartingLBAMeta_r10b::ResizeDataBuf(SharedReadPtr &readCmd,
     case Informative::NS_BARE:
         throw FrmwkEx(HERE, "Namspc type cannot be BARE.");
     case Informative::NS_METAS:
+    case Informative::NS_E2ES:
         LOG_NRM("Resized max rd/wr blks to %ld for separate meta", maxWrBlks);
         writeMem->Init(maxWrBlks * lbaDataSize);
         readMem->Init(maxWrBlks * lbaDataSize);
         break;
     case Informative::NS_METAI:
+    case Informative::NS_E2EI:
         LOG_NRM("Resized max rd/wr blks to %ld for integrated meta", maxWrBlks);
         writeMem->Init(maxWrBlks * (lbaDataSize + lbaFormat.MS));
         readMem->Init(maxWrBlks * (lbaDataSize + lbaFormat.MS));
         break;
-    case Informative::NS_E2ES:
-    case Informative::NS_E2EI:
-    throw FrmwkEx(HERE, "Deferring work to handle this case in future");
-    break;
     }
 
     writeCmd->SetPrpBuffer(prpBitmask, writeMem);
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _GRPDEFS_H_
+#define _GRPDEFS_H_
+
+#include "dutDefs.h"
+
+namespace GrpPerformance {
+
+#define ACQ_GROUP_ID                "ACQ"
+#define ASQ_GROUP_ID                "ASQ"
+
+// Workload parameters shared by all tests within the group, these are compiled
+// in; changing a workload requires rebuilding tnvme.
+#define PERF_NUM_IOQS               4       // IOQ pairs, 1 worker thread each
+#define PERF_QDEPTH                 32      // cmds outstanding per IOQ pair
+#define PERF_DURATION_ms            10000
+#define PERF_SEQ_BLKSIZE            (128 * 1024)
+#define PERF_RAND_BLKSIZE           (4 * 1024)
+#define PERF_MIXED_READ_PCT         70
+
+
+}   // namespace
+
+#endif
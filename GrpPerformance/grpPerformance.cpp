@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "grpPerformance.h"
+#include "createResources_r10b.h"
+#include "seqWrite_r10b.h"
+#include "seqRead_r10b.h"
+#include "randWrite_r10b.h"
+#include "randRead_r10b.h"
+#include "randMixed_r10b.h"
+
+namespace GrpPerformance {
+
+
+GrpPerformance::GrpPerformance(size_t grpNum) :
+    Group(grpNum, "GrpPerformance",
+        "Throughput and latency workloads, fixed at build time by grpDefs.h")
+{
+    // For complete details about the APPEND_TEST_AT_?LEVEL() macros:
+    // "https://github.com/nvmecompliance/tnvme/wiki/Test-Numbering" and
+    // "https://github.com/nvmecompliance/tnvme/wiki/Test-Strategy
+    switch (gCmdLine.rev) {
+    case SPECREV_10b:
+        APPEND_TEST_AT_XLEVEL(CreateResources_r10b, GrpPerformance)
+        APPEND_TEST_AT_YLEVEL(SeqWrite_r10b, GrpPerformance)
+        APPEND_TEST_AT_YLEVEL(SeqRead_r10b, GrpPerformance)
+        APPEND_TEST_AT_YLEVEL(RandWrite_r10b, GrpPerformance)
+        APPEND_TEST_AT_YLEVEL(RandRead_r10b, GrpPerformance)
+        APPEND_TEST_AT_YLEVEL(RandMixed_r10b, GrpPerformance)
+        break;
+
+    default:
+    case SPECREVTYPE_FENCE:
+        throw FrmwkEx(HERE, "Object created with an unknown SpecRev=%d",
+            gCmdLine.rev);
+    }
+}
+
+
+GrpPerformance::~GrpPerformance()
+{
+    // mTests deallocated in parent
+}
+
+}   // namespace
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _GRPPERFORMANCE_H_
+#define _GRPPERFORMANCE_H_
+
+#include "../group.h"
+#include "../Exception/frmwkEx.h"
+
+
+namespace GrpPerformance {
+
+
+/**
+* This class implements fio style workloads which measure the throughput and
+* completion latency of the DUT rather than deciding pass/fail on compliance.
+* The workloads' parameters are defined within grpDefs.h, changing them
+* requires rebuilding tnvme.
+*/
+class GrpPerformance : public Group
+{
+public:
+    GrpPerformance(size_t grpNum);
+    virtual ~GrpPerformance();
+};
+
+}   // namespace
+
+#endif
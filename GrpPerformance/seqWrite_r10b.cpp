@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "seqWrite_r10b.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "workload.h"
+
+namespace GrpPerformance {
+
+
+SeqWrite_r10b::SeqWrite_r10b(
+    string grpName, string testName) :
+    Test(grpName, testName, SPECREV_10b)
+{
+    // 63 chars allowed:     xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    mTestDesc.SetCompliance("revision 1.0b, section 6");
+    mTestDesc.SetShort(     "Sequential write throughput and completion latency");
+    // No string size limit for the long description
+    mTestDesc.SetLong(
+        "Measure sequential write performance against every bare namspc. Each "
+        "of PERF_NUM_IOQS IOQ pairs is driven by its own thread keeping "
+        "PERF_QDEPTH write cmds of PERF_SEQ_BLKSIZE outstanding for "
+        "PERF_DURATION_ms, sequentially within its own region of the namspc. "
+        "Report IOPS, MiB/s and completion latency percentiles.");
+}
+
+
+SeqWrite_r10b::~SeqWrite_r10b()
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // Allocations taken from the heap and not under the control of the
+    // RsrcMngr need to be freed/deleted here.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+SeqWrite_r10b::
+SeqWrite_r10b(const SeqWrite_r10b &other) : Test(other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+
+SeqWrite_r10b &
+SeqWrite_r10b::operator=(const SeqWrite_r10b &other)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All pointers in this object must be NULL, never allow shallow or deep
+    // copies, see Test::Clone() header comment.
+    ///////////////////////////////////////////////////////////////////////////
+    Test::operator=(other);
+    return *this;
+}
+
+
+Test::RunType
+SeqWrite_r10b::RunnableCoreTest(bool preserve)
+{
+    ///////////////////////////////////////////////////////////////////////////
+    // All code contained herein must never permanently modify the state or
+    // configuration of the DUT. Permanence is defined as state or configuration
+    // changes that will not be restored after a cold hard reset.
+    ///////////////////////////////////////////////////////////////////////////
+
+    return ((preserve == true) ? RUN_FALSE : RUN_TRUE);   // Test is destructive
+}
+
+
+void
+SeqWrite_r10b::RunCoreTest()
+{
+    /** \verbatim
+     * Assumptions:
+     * 1) Test CreateResources_r10b has run prior.
+     *  \endverbatim
+     */
+    WorkloadParams params;
+    params.blkSize = PERF_SEQ_BLKSIZE;
+    params.qDepth = PERF_QDEPTH;
+    params.numIOQs = PERF_NUM_IOQS;
+    params.randomPct = 0;
+    params.readPct = 0;
+    params.duration_ms = PERF_DURATION_ms;
+    params.pinCPUs = true;
+
+    Workload workload(mGrpName, mTestName, params);
+    workload.Run();
+}
+
+}   // namespace
@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <random>
+#include "workload.h"
+#include "globals.h"
+#include "grpDefs.h"
+#include "../Utils/queues.h"
+#include "../Cmds/write.h"
+#include "../Cmds/read.h"
+#include "../Cmds/cmdPool.h"
+
+namespace GrpPerformance {
+
+
+Workload::Workload()
+{
+    throw FrmwkEx(HERE, "Illegal constructor");
+}
+
+
+Workload::Workload(string grpName, string testName, WorkloadParams params)
+{
+    if ((params.blkSize == 0) || (params.qDepth == 0) ||
+        (params.numIOQs == 0) || (params.duration_ms == 0)) {
+        throw FrmwkEx(HERE, "Workload parameters must all be non-zero");
+    } else if ((params.randomPct > 100) || (params.readPct > 100)) {
+        throw FrmwkEx(HERE, "Workload percentages must be <= 100");
+    }
+
+    mGrpName = grpName;
+    mTestName = testName;
+    mParams = params;
+}
+
+
+Workload::~Workload()
+{
+}
+
+
+void
+Workload::Run()
+{
+    vector<uint32_t> bare = gInformative->GetBareNamespaces();
+    if (bare.empty()) {
+        LOG_NRM("No bare namspc's exist, unable to run workload");
+        return;
+    }
+
+    for (size_t i = 0; i < bare.size(); i++)
+        RunNamspc(bare[i]);
+}
+
+
+void
+Workload::RunNamspc(uint32_t nsid)
+{
+    uint64_t maxIOQEntries;
+
+    SharedASQPtr asq = CAST_TO_ASQ(gRsrcMngr->GetObj(ASQ_GROUP_ID))
+    SharedACQPtr acq = CAST_TO_ACQ(gRsrcMngr->GetObj(ACQ_GROUP_ID))
+
+    ConstSharedIdentifyPtr namSpcPtr = gInformative->GetIdentifyCmdNamspc(nsid);
+    uint64_t ncap = namSpcPtr->GetValue(IDNAMESPC_NCAP);
+    uint64_t lbaDataSize = namSpcPtr->GetLBADataSize();
+
+    // Each cmd transfers whole LBA's, limited by MDTS and the NLB field
+    uint32_t maxDtXferSz =
+        gInformative->GetIdentifyCmdCtrlr()->GetMaxDataXferSize();
+    if (maxDtXferSz == 0)
+        maxDtXferSz = MAX_DATA_TX_SIZE;
+    uint64_t nlb = MIN(mParams.blkSize, maxDtXferSz) / lbaDataSize;
+    nlb = MAX(MIN(nlb, (uint64_t)65536), (uint64_t)1);
+    uint32_t xferSize = (nlb * lbaDataSize);
+
+    // Limit the workload to what the DUT supports
+    uint16_t numIOQs = MIN(mParams.numIOQs,
+        MIN((gInformative->GetFeaturesNumOfIOSQs() + 1),
+        (gInformative->GetFeaturesNumOfIOCQs() + 1)));
+    if (gRegisters->Read(CTLSPC_CAP, maxIOQEntries) == false)
+        throw FrmwkEx(HERE, "Unable to determine MQES");
+    maxIOQEntries = ((maxIOQEntries & CAP_MQES) + 1);    // convert to 1-based
+    uint32_t numEntries =
+        MIN((uint64_t)(mParams.qDepth + 1), maxIOQEntries);
+
+    // Each IOQ pair works within its own region of the namspc
+    uint64_t regionBlks = (ncap / numIOQs);
+    uint64_t numSlots = (regionBlks / nlb);
+    if (numSlots == 0) {
+        throw FrmwkEx(HERE, "NSID %d, NCAP %ld too small for %d IOQ's of "
+            "%ld LBA cmds", nsid, ncap, numIOQs, nlb);
+    }
+
+    LOG_NRM("Workload NSID %d: bs=%d, qd=%d, ioqs=%d, rand=%d%%, read=%d%%, "
+        "%d ms", nsid, xferSize, (numEntries - 1), numIOQs, mParams.randomPct,
+        mParams.readPct, mParams.duration_ms);
+
+    vector<SharedIOSQPtr> iosqs;
+    vector<SharedIOCQPtr> iocqs;
+    vector<SharedIOWorkerPtr> workers;
+    IOStats stats;
+    long numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    // Whatever fails, the IOQ's created thus far must not outlive the test
+    try {
+        for (uint16_t q = 0; q < numIOQs; q++) {
+            uint16_t ioqId = (q + 1);
+            SharedIOCQPtr iocq = Queues::CreateIOCQContigToHdw(mGrpName,
+                mTestName, CALC_TIMEOUT_ms(1), asq, acq, ioqId, numEntries,
+                false, "", false, 0, "", false);
+            iocqs.push_back(iocq);
+            SharedIOSQPtr iosq = Queues::CreateIOSQContigToHdw(mGrpName,
+                mTestName, CALC_TIMEOUT_ms(1), asq, acq, ioqId, numEntries,
+                false, "", ioqId, 0, "", false);
+            iosqs.push_back(iosq);
+
+            // Every worker owns its cmds and buffers, none are shared. Each
+            // cmd in flight is its own object, so IOEngine completes it with
+            // the SLBA it was issued with; the pools recycle them as they
+            // complete rather than allocating each one.
+            send_64b_bitmask prpBitmask = (send_64b_bitmask)
+                (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+            SharedMemBufferPtr writeMem = SharedMemBufferPtr(new MemBuffer());
+            writeMem->Init(xferSize);
+            writeMem->SetDataPattern(DATAPAT_INC_32BIT, ioqId);
+            SharedMemBufferPtr readMem = SharedMemBufferPtr(new MemBuffer());
+            readMem->Init(xferSize);
+
+            boost::shared_ptr<CmdPool<Write> > writePool(
+                new CmdPool<Write>());
+            boost::shared_ptr<CmdPool<Read> > readPool(new CmdPool<Read>());
+            writePool->Prealloc(numEntries);
+            readPool->Prealloc(numEntries);
+
+            uint64_t regionStart = (q * regionBlks);
+            uint8_t randomPct = mParams.randomPct;
+            uint8_t readPct = mParams.readPct;
+            std::mt19937_64 rng(ioqId);
+            CmdSource source = [=](uint64_t n) mutable -> SharedCmdPtr {
+                std::uniform_int_distribution<uint32_t> pct(0, 99);
+                std::uniform_int_distribution<uint64_t> slots(0,
+                    (numSlots - 1));
+                uint64_t slot = (pct(rng) < randomPct) ?
+                    slots(rng) : (n % numSlots);
+                uint64_t lba = (regionStart + (slot * nlb));
+                if (pct(rng) < readPct) {
+                    SharedReadPtr readCmd = readPool->Get();
+                    readCmd->SetPrpBuffer(prpBitmask, readMem);
+                    readCmd->SetNSID(nsid);
+                    readCmd->SetNLB(nlb - 1);     // 0-based value
+                    readCmd->SetSLBA(lba);
+                    return readCmd;
+                }
+                SharedWritePtr writeCmd = writePool->Get();
+                writeCmd->SetPrpBuffer(prpBitmask, writeMem);
+                writeCmd->SetNSID(nsid);
+                writeCmd->SetNLB(nlb - 1);    // 0-based value
+                writeCmd->SetSLBA(lba);
+                return writeCmd;
+            };
+
+            int cpu = (mParams.pinCPUs && (numCPUs > 0)) ? (q % numCPUs) : -1;
+            workers.push_back(SharedIOWorkerPtr(new IOWorker(iosq, iocq,
+                (numEntries - 1), CALC_TIMEOUT_ms(numEntries), source, 0,
+                mParams.duration_ms, cpu)));
+        }
+
+        stats = IOWorker::RunAll(workers);
+    } catch (...) {
+        workers.clear();
+        DeleteIOQs(asq, acq, iosqs, iocqs);
+        throw;
+    }
+    workers.clear();
+    DeleteIOQs(asq, acq, iosqs, iocqs);
+    Report(nsid, xferSize, stats);
+
+    if (stats.numErrors) {
+        throw FrmwkEx(HERE, "%ld of %ld cmds completed unsuccessfully",
+            stats.numErrors, stats.numCompleted);
+    }
+}
+
+
+void
+Workload::DeleteIOQs(SharedASQPtr asq, SharedACQPtr acq,
+    vector<SharedIOSQPtr> &iosqs, vector<SharedIOCQPtr> &iocqs)
+{
+    // A FrmwkEx has already disabled the DUT, which deleted all IOQ's
+    if (gCtrlrConfig->IsStateEnabled() == false) {
+        LOG_NRM("DUT is disabled, its IOQ's no longer exist");
+    } else {
+        for (size_t q = 0; q < iosqs.size(); q++) {
+            Queues::DeleteIOSQToHdw(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
+                iosqs[q], asq, acq, "", false);
+        }
+        for (size_t q = 0; q < iocqs.size(); q++) {
+            Queues::DeleteIOCQToHdw(mGrpName, mTestName, CALC_TIMEOUT_ms(1),
+                iocqs[q], asq, acq, "", false);
+        }
+    }
+    iosqs.clear();
+    iocqs.clear();
+}
+
+
+void
+Workload::Report(uint32_t nsid, uint32_t xferSize, const IOStats &stats)
+{
+    const double percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+    const size_t numPercentiles = sizeof(percentiles) / sizeof(percentiles[0]);
+
+    double secs = ((double)MAX(stats.elapsed_us, (uint64_t)1) / 1000000.0);
+    double iops = ((double)stats.numCompleted / secs);
+    double mibps = ((iops * xferSize) / (1024.0 * 1024.0));
+
+    LOG_NRM("Workload NSID %d results: %ld cmds in %.3f s, errors %ld",
+        nsid, stats.numCompleted, secs, stats.numErrors);
+    LOG_NRM("  IOPS = %.0f, BW = %.2f MiB/s", iops, mibps);
+    if (stats.latency_us.GetCount() == 0)
+        return;
+
+    LOG_NRM("  clat (us): min=%ld, max=%ld, avg=%.2f",
+        stats.latency_us.GetMin(), stats.latency_us.GetMax(),
+        stats.latency_us.GetMean());
+    // Percentiles come from the histogram's buckets, accurate to within ~6%
+    for (size_t i = 0; i < numPercentiles; i++) {
+        LOG_NRM("  clat percentile %6.2f%% = %ld us", percentiles[i],
+            stats.latency_us.GetPercentile(percentiles[i]));
+    }
+}
+
+}   // namespace
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _WORKLOAD_H_
+#define _WORKLOAD_H_
+
+#include "tnvme.h"
+#include "../Utils/ioWorker.h"
+#include "../Queues/asq.h"
+#include "../Queues/acq.h"
+#include "../Queues/iosq.h"
+#include "../Queues/iocq.h"
+
+namespace GrpPerformance {
+
+
+/// The parameters describing a fio style workload
+struct WorkloadParams {
+    uint32_t blkSize;       // bytes per cmd, rounded down to whole LBA's
+    uint32_t qDepth;        // cmds outstanding per IOQ pair
+    uint16_t numIOQs;       // IOQ pairs, each driven by its own IOWorker
+    uint8_t  randomPct;     // % of cmds at random LBA's, remainder sequential
+    uint8_t  readPct;       // % of cmds which read, remainder write
+    uint32_t duration_ms;   // length of time to issue cmds
+    bool     pinCPUs;       // pin each IOWorker round robin across CPU's
+};
+
+
+/**
+* This class runs a fio style workload against every bare namspc. For each
+* namspc the requested number of IOQ pairs are created, each namspc is
+* divided into equal regions, 1 per IOQ pair, and each pair is driven from
+* its own IOWorker thread issuing Write and Read cmds. IOPS, MiB/s and
+* completion latency percentiles are then reported.
+*
+* @note This class may throw exceptions.
+*/
+class Workload
+{
+public:
+    /**
+     * @param grpName Pass the name of the group to which the test belongs
+     * @param testName Pass the name of the test running the workload
+     * @param params Pass the description of the workload
+     */
+    Workload(string grpName, string testName, WorkloadParams params);
+    virtual ~Workload();
+
+    /// Run the workload against every bare namspc
+    void Run();
+
+
+private:
+    Workload();
+
+    string mGrpName;
+    string mTestName;
+    WorkloadParams mParams;
+
+    /**
+     * Run the workload against a single namspc.
+     * @param nsid Pass the ID of the bare namspc
+     */
+    void RunNamspc(uint32_t nsid);
+
+    /**
+     * Delete IOQ's from the DUT, SQ's before CQ's, unless the DUT has
+     * already been disabled.
+     * @param asq Pass the ASQ to issue the delete cmds into
+     * @param acq Pass the ACQ which the ASQ completes into
+     * @param iosqs Pass the IOSQ's to delete, returns empty
+     * @param iocqs Pass the IOCQ's to delete, returns empty
+     */
+    void DeleteIOQs(SharedASQPtr asq, SharedACQPtr acq,
+        vector<SharedIOSQPtr> &iosqs, vector<SharedIOCQPtr> &iocqs);
+
+    /**
+     * Log the results of the workload.
+     * @param nsid Pass the ID of the namspc the workload ran against
+     * @param xferSize Pass the number of bytes each cmd transferred
+     * @param stats Pass the merged stats of all workers
+     */
+    void Report(uint32_t nsid, uint32_t xferSize, const IOStats &stats);
+};
+
+}   // namespace
+
+#endif
@@ -92,12 +92,11 @@ ManyCmdSubmit_r10b::RunCoreTest()
      * 1) Test CreateResources_r10b has run prior.
      *  \endverbatim
      */
-    uint32_t nCmds;
     uint32_t isrCount;
     uint32_t ceRemain;
     uint32_t numReaped;
     uint32_t numCE;
-    uint16_t uniqueId;
+    vector<uint16_t> uniqueIds;
 
     // Lookup objs which were created in a prior test within group
     SharedASQPtr asq = CAST_TO_ASQ(gRsrcMngr->GetObj(ASQ_GROUP_ID))
@@ -125,8 +124,8 @@ ManyCmdSubmit_r10b::RunCoreTest()
     for (uint32_t x = 1; x < maxIOQEntries; x += increment) {
         LOG_NRM("Sending #%d simultaneous NVM write cmds to IOSQ", x);
         // Issue x simultaneous NVM write cmds.
-        for (nCmds = 1; nCmds <= x; nCmds++)
-            iosq->Send(writeCmd, uniqueId);
+        vector<SharedCmdPtr> cmds(x, writeCmd);
+        iosq->SendBatch(cmds, uniqueIds);
         iosq->Ring();
 
         // Variable wait time w.r.t "x" and expect all CE's to arrive in CQ.
@@ -15,6 +15,7 @@
  */
 
 #include "backdoor.h"
+#include "../Utils/kernelAPI.h"
 #include "../Exception/frmwkEx.h"
 
 
@@ -43,6 +44,7 @@ Backdoor::SetToxicCmdValue(struct backdoor_inject &injectReq)
     int ret;
 
     // This is volatile, see class level header comment.
-    if ((ret = ioctl(mFD, NVME_IOCTL_TOXIC_64B_DWORD, &injectReq)) < 0)
+    if ((ret = KernelAPI::ioctl(mFD, NVME_IOCTL_TOXIC_64B_DWORD,
+        &injectReq)) < 0)
         throw FrmwkEx(HERE, "Backdoor toxic injection failed: 0x%02X", ret);
 }
@@ -14,14 +14,25 @@
  *  limitations under the License.
  */
 
-#include <sys/time.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
 #include "cq.h"
 #include "globals.h"
 #include "../Utils/kernelAPI.h"
 #include "../Utils/buffers.h"
+#include "../Utils/binDump.h"
+#include "../Utils/latency.h"
 
 SharedCQPtr CQ::NullCQPtr;
 
+// Parameters governing WAIT_ADAPTIVE and WAIT_EVENT, CE's typically arrive
+// within a few usec so spinning briefly beats sleeping, after which backing
+// off keeps long waits from burning a CPU.
+#define WAIT_SPIN_LIMIT         64
+#define WAIT_BACKOFF_MIN_us     1
+#define WAIT_BACKOFF_MAX_us     1024
+
 
 CQ::CQ() : Queue(0, Trackable::OBJTYPE_FENCE)
 {
@@ -34,6 +45,10 @@ CQ::CQ(int fd, Trackable::ObjType objBeingCreated) :
 {
     mIrqEnabled = false;
     mIrqVec = 0;
+    mWaitMode = WAIT_ADAPTIVE;
+    mLastWait_us = 0;
+    mDetectedValid = false;
+    ResetScan();
 }
 
 
@@ -54,6 +69,8 @@ CQ::Init(uint16_t qId, uint16_t entrySize, uint32_t numEntries,
     Queue::Init(qId, entrySize, numEntries);
     mIrqEnabled = irqEnabled;
     mIrqVec = irqVec;
+    mWaitMode = WAIT_ADAPTIVE;
+    ResetScan();
     LOG_NRM(
         "Create CQ: (id,entrySize,numEntry,IRQEnable) = (%d,%d,%d,%s)",
         GetQId(), GetEntrySize(), GetNumEntries(), GetIrqEnabled() ? "T" : "F");
@@ -80,7 +97,7 @@ CQ::Init(uint16_t qId, uint16_t entrySize, uint32_t numEntries,
         LOG_NRM("Init contig ACQ: (id, entrySize, numEntries) = (%d, %d, %d)",
             GetQId(), GetEntrySize(), GetNumEntries());
 
-        if ((ret = ioctl(mFd, NVME_IOCTL_CREATE_ADMN_Q, &q)) < 0) {
+        if ((ret = KernelAPI::ioctl(mFd, NVME_IOCTL_CREATE_ADMN_Q, &q)) < 0) {
             throw FrmwkEx(HERE, "Q Creation failed by dnvme with error: 0x%02X",
                 ret);
         }
@@ -107,6 +124,8 @@ CQ::Init(uint16_t qId, uint16_t entrySize, uint32_t numEntries,
     Queue::Init(qId, entrySize, numEntries);
     mIrqEnabled = irqEnabled;
     mIrqVec = irqVec;
+    mWaitMode = WAIT_ADAPTIVE;
+    ResetScan();
     LOG_NRM(
         "Create CQ: (id,entrySize,numEntry,IRQEnable) = (%d,%d,%d,%s)",
         GetQId(), GetEntrySize(), GetNumEntries(), GetIrqEnabled() ? "T" : "F");
@@ -158,7 +177,7 @@ CQ::CreateIOCQ(struct nvme_prep_cq &q)
         q.contig ? "contig" : "discontig", GetQId(), GetEntrySize(),
         GetNumEntries());
 
-    if ((ret = ioctl(mFd, NVME_IOCTL_PREPARE_CQ_CREATION, &q)) < 0) {
+    if ((ret = KernelAPI::ioctl(mFd, NVME_IOCTL_PREPARE_CQ_CREATION, &q)) < 0) {
         throw FrmwkEx(HERE, "Q Creation failed by dnvme with error: 0x%02X",
             ret);
     }
@@ -177,7 +196,8 @@ CQ::GetQMetrics()
     getQMetrics.nBytes = sizeof(qMetrics);
     getQMetrics.buffer = (uint8_t *)&qMetrics;
 
-    if ((ret = ioctl(mFd, NVME_IOCTL_GET_Q_METRICS, &getQMetrics)) < 0) {
+    if ((ret = KernelAPI::ioctl(mFd, NVME_IOCTL_GET_Q_METRICS, &getQMetrics,
+        getQMetrics.nBytes)) < 0) {
         throw FrmwkEx(HERE, 
             "Get Q metrics failed by dnvme with error: 0x%02X", ret);
     }
@@ -200,22 +220,38 @@ CQ::LogQMetrics()
 }
 
 
-union CE
-CQ::PeekCE(uint16_t indexPtr)
+void
+CQ::ResetScan()
 {
-    union CE *dataPtr;
+    // Newly created CQ's are zeroed, the ctrlr posts with P=1 on the 1st pass
+    mScanHead = 0;
+    mScanPhase = 1;
+    mScanReported = 0;
+}
+
 
+volatile union CE *
+CQ::GetCEBuffer()
+{
     if (GetIsContig())
-        dataPtr = (union CE *)mContigBuf;
-    else
-        dataPtr = (union CE *)mDiscontigBuf->GetBuffer();
+        return (volatile union CE *)mContigBuf;
+    return (volatile union CE *)mDiscontigBuf->GetBuffer();
+}
 
-    for (uint32_t i = 0; i < GetNumEntries(); i++, dataPtr++) {
-        if (i == indexPtr)
-            return *dataPtr;
-    }
 
-    throw FrmwkEx(HERE, "Unable to locate index within Q");
+union CE
+CQ::PeekCE(uint16_t indexPtr)
+{
+    if (indexPtr >= GetNumEntries())
+        throw FrmwkEx(HERE, "Unable to locate index within Q");
+
+    union CE ce;
+    volatile union CE *dataPtr = &GetCEBuffer()[indexPtr];
+    ce.t.dw0 = dataPtr->t.dw0;
+    ce.t.dw1 = dataPtr->t.dw1;
+    ce.t.dw2 = dataPtr->t.dw2;
+    ce.t.dw3 = dataPtr->t.dw3;
+    return ce;
 }
 
 
@@ -223,11 +259,24 @@ void
 CQ::LogCE(uint16_t indexPtr)
 {
     union CE ce = PeekCE(indexPtr);
+    uint32_t dw[sizeof(ce) / sizeof(uint32_t)];
+    char prefix[64];           // Bounds each line, thus work never overflows
+    char work[1024];
+    int len = 0;
+
     LOG_NRM("Logging Completion Element (CE)...");
-    LOG_NRM("  CQ %d, CE %d, DWORD0: 0x%08X", GetQId(), indexPtr, ce.t.dw0);
-    LOG_NRM("  CQ %d, CE %d, DWORD1: 0x%08X", GetQId(), indexPtr, ce.t.dw1);
-    LOG_NRM("  CQ %d, CE %d, DWORD2: 0x%08X", GetQId(), indexPtr, ce.t.dw2);
-    LOG_NRM("  CQ %d, CE %d, DWORD3: 0x%08X", GetQId(), indexPtr, ce.t.dw3);
+    if (Logger::GetVerbosity() < LOGLVL_NRM)
+        return;
+
+    // All DWORDs within a single log statement, each line as LOG_NRM would be
+    memcpy(dw, &ce, sizeof(dw));
+    LOG_NRM_PREFIX(prefix, sizeof(prefix));
+    for (size_t i = 0; i < (sizeof(dw) / sizeof(dw[0])); i++) {
+        len += snprintf(&work[len], (sizeof(work) - len),
+            "%s  CQ %d, CE %d, DWORD%d: 0x%08X\n", prefix, GetQId(),
+            indexPtr, (int)i, dw[i]);
+    }
+    Logger::Write(LOGLVL_NRM, work, len);
 }
 
 
@@ -247,7 +296,7 @@ CQ::ReapInquiry(uint32_t &isrCount, bool reportOn0)
     struct nvme_reap_inquiry inq;
 
     inq.q_id = GetQId();
-    if ((rc = ioctl(mFd, NVME_IOCTL_REAP_INQUIRY, &inq)) < 0)
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_REAP_INQUIRY, &inq)) < 0)
         throw FrmwkEx(HERE, "Error during reap inquiry, rc =%d", rc);
 
     isrCount = inq.isr_count;
@@ -259,38 +308,62 @@ CQ::ReapInquiry(uint32_t &isrCount, bool reportOn0)
 }
 
 
+void
+CQ::SetWaitMode(WaitMode mode)
+{
+    if (mode >= WAITMODE_FENCE)
+        throw FrmwkEx(HERE, "Illegal wait mode: %d", mode);
+    else if ((mode == WAIT_EVENT) && (GetIrqEnabled() == false))
+        throw FrmwkEx(HERE, "CQ %d must have IRQ's enabled to wait on events",
+            GetQId());
+    mWaitMode = mode;
+}
+
+
+uint32_t
+CQ::ReapInquiryScan(bool reportOn0)
+{
+    uint32_t numCE = 0;
+    uint32_t idx = mScanHead;
+    uint8_t phase = mScanPhase;
+    volatile union CE *ceBuf = GetCEBuffer();
+
+    // Per NVME spec: 1 empty CE implies a full CQ, never more can be awaiting
+    while (numCE < (GetNumEntries() - 1)) {
+        if (ceBuf[idx].n.SF.t.P != phase)
+            break;
+        numCE++;
+        if (++idx >= GetNumEntries()) {
+            idx = 0;
+            phase ^= 1;
+        }
+    }
+
+    // Waits poll this repeatedly, only changes in the count are worth a log
+    if ((numCE && (numCE != mScanReported)) || reportOn0) {
+        LOG_NRM("%d CE's awaiting attention in CQ %d, scanned from head %d",
+            numCE, GetQId(), mScanHead);
+    }
+    mScanReported = numCE;
+    return numCE;
+}
+
+
 bool
 CQ::ReapInquiryWaitAny(uint32_t ms, uint32_t &numCE, uint32_t &isrCount)
 {
-    uint32_t delta;
-
     // Avoid a common mistake, waiting longer than a day?
     if (ms > 86400000)
         LOG_WARN("Waiting > 1 day, is this reasonable?");
 
-    struct timeval initial;
-    if (gettimeofday(&initial, NULL) != 0)
-        throw FrmwkEx(HERE, "Cannot retrieve system time");
-
-    while (CalcTimeout(ms, initial, delta) == false) {
-        if ((numCE = ReapInquiry(isrCount)) != 0) {
-            LOG_NRM("Waited for CE(s) approx: %d ms", delta);
-            return true;
-        }
-        usleep(10);
+    if (WaitWorker(ms, 1, numCE, isrCount)) {
+        LOG_NRM("Waited for CE(s) approx: %ld us", mLastWait_us);
+        return true;
     }
 
     LOG_ERR("Timed out waiting %d ms for any CE in CQ %d, found %d",
         ms, GetQId(), numCE);
-    struct nvme_gen_cq qMetrics = LogQMetrics();
-    LOG_NRM("qMetrics.head_ptr dump follows:");
-    LogCE(qMetrics.head_ptr);
-    LOG_NRM("qMetrics.tail_ptr dump follows:");
-    LogCE(qMetrics.tail_ptr);
-    LOG_NRM("qMetrics.head_ptr+1 dump follows:");
-    LogCE((qMetrics.head_ptr + 1) % qMetrics.elements);
-    LOG_NRM("qMetrics.tail_ptr+1 dump follows:");
-    LogCE((qMetrics.tail_ptr + 1) % qMetrics.elements);
+    LogTimeoutState();
     return false;
 }
 
@@ -299,28 +372,108 @@ bool
 CQ::ReapInquiryWaitSpecify(uint32_t ms, uint32_t numTil, uint32_t &numCE,
     uint32_t &isrCount)
 {
-    uint32_t delta;
-
     // Avoid a common mistake
     if (ms > 86400000)
         throw FrmwkEx(HERE, "Waiting > 1 day, is this reasonable?");
 
-    struct timeval initial;
-    if (gettimeofday(&initial, NULL) != 0)
+    if (WaitWorker(ms, numTil, numCE, isrCount)) {
+        LOG_NRM("Waited for CE(s) approx: %ld us", mLastWait_us);
+        return true;
+    }
+
+    LOG_ERR("Timed out waiting %d ms for %d CE's in CQ %d, found %d",
+        ms, numTil, GetQId(), numCE);
+    LogTimeoutState();
+    return false;
+}
+
+
+bool
+CQ::WaitWorker(uint32_t ms, uint32_t numTil, uint32_t &numCE,
+    uint32_t &isrCount)
+{
+    uint32_t spins = 0;
+    uint32_t lastNumCE = 0;
+    uint32_t backoff_us = WAIT_BACKOFF_MIN_us;
+
+    numCE = 0;
+    mLastWait_us = 0;
+    struct timespec initial;
+    if (clock_gettime(CLOCK_MONOTONIC, &initial) != 0)
         throw FrmwkEx(HERE, "Cannot retrieve system time");
 
-    while (CalcTimeout(ms, initial, delta) == false) {
-        if ((numCE = ReapInquiry(isrCount)) != 0) {
-            if (numCE >= numTil) {
-                LOG_NRM("Waited for CE(s) approx: %d ms", delta);
-                return true;
+    while (CalcTimeout(ms, initial, mLastWait_us) == false) {
+        // Polled CQ's are scanned from user space, only once enough CE's are
+        // seen does dnvme get asked, for it is the authority over the CQ.
+        if (GetIrqEnabled() || (ReapInquiryScan() >= numTil)) {
+            if ((numCE = ReapInquiry(isrCount)) != 0) {
+                if (numCE >= numTil) {
+                    clock_gettime(CLOCK_MONOTONIC, &mDetected);
+                    mDetectedValid = true;
+                    return true;
+                }
+            }
+        }
+
+        switch (mWaitMode) {
+        case WAIT_SLEEP:
+            usleep(10);
+            break;
+
+        case WAIT_ADAPTIVE:
+            if (spins < WAIT_SPIN_LIMIT) {
+                spins++;
+            } else {
+                usleep(backoff_us);
+                backoff_us = MIN((backoff_us * 2), WAIT_BACKOFF_MAX_us);
             }
+            break;
+
+        case WAIT_EVENT:
+            // dnvme may not signal readiness for every CE, nor even implement
+            // poll(); a ready fd while the inquiry above found no new CE's is
+            // treated as spurious and followed by a backoff so this never
+            // degrades to a busy spin.
+            if (WaitForEvent(backoff_us) && (numCE == lastNumCE))
+                usleep(backoff_us);
+            lastNumCE = numCE;
+            backoff_us = MIN((backoff_us * 2), WAIT_BACKOFF_MAX_us);
+            break;
+
+        default:
+            throw FrmwkEx(HERE, "Illegal wait mode: %d", mWaitMode);
         }
-        usleep(10);
     }
+    return false;
+}
 
-    LOG_ERR("Timed out waiting %d ms for %d CE's in CQ %d, found %d",
-        ms, numTil, GetQId(), numCE);
+
+bool
+CQ::WaitForEvent(uint32_t us)
+{
+    int rc;
+    struct pollfd pfd;
+    struct timespec period;
+
+    pfd.fd = mFd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    period.tv_sec = (us / 1000000);
+    period.tv_nsec = ((us % 1000000) * 1000);
+
+    if ((rc = ppoll(&pfd, 1, &period, NULL)) < 0) {
+        if (errno == EINTR)
+            return false;
+        throw FrmwkEx(HERE, "Error during poll on CQ %d, errno=%d",
+            GetQId(), errno);
+    }
+    return (rc > 0);
+}
+
+
+void
+CQ::LogTimeoutState()
+{
     struct nvme_gen_cq qMetrics = LogQMetrics();
     LOG_NRM("qMetrics.head_ptr dump follows:");
     LogCE(qMetrics.head_ptr);
@@ -330,23 +483,23 @@ CQ::ReapInquiryWaitSpecify(uint32_t ms, uint32_t numTil, uint32_t &numCE,
     LogCE((qMetrics.head_ptr + 1) % qMetrics.elements);
     LOG_NRM("qMetrics.tail_ptr+1 dump follows:");
     LogCE((qMetrics.tail_ptr + 1) % qMetrics.elements);
-    return false;
 }
 
 
 bool
-CQ::CalcTimeout(uint32_t ms, struct timeval &initial, uint32_t &delta)
+CQ::CalcTimeout(uint32_t ms, struct timespec &initial, uint64_t &delta_us)
 {
-    struct timeval current;
+    struct timespec current;
 
-    if (gettimeofday(&current, NULL) != 0)
+    if (clock_gettime(CLOCK_MONOTONIC, &current) != 0)
         throw FrmwkEx(HERE, "Cannot retrieve system time");
 
-    time_t initial_us = (((time_t)1000000 * initial.tv_sec) + initial.tv_usec);
-    time_t current_us = (((time_t)1000000 * current.tv_sec) + current.tv_usec);
-    time_t timeout_us = ((time_t)ms * (time_t)1000);
-    time_t delta_us = (current_us - initial_us);
-    delta = (delta_us / 1000UL);
+    uint64_t initial_us = (((uint64_t)1000000 * initial.tv_sec) +
+        (initial.tv_nsec / 1000));
+    uint64_t current_us = (((uint64_t)1000000 * current.tv_sec) +
+        (current.tv_nsec / 1000));
+    uint64_t timeout_us = ((uint64_t)ms * 1000);
+    delta_us = (current_us - initial_us);
     if (delta_us >= timeout_us) {
         LOG_NRM("Timeout: (cur - init) >= TO: (%ld - %ld) >= %ld",
             current_us, initial_us, timeout_us);
@@ -360,9 +513,42 @@ uint32_t
 CQ::Reap(uint32_t &ceRemain, SharedMemBufferPtr memBuffer, uint32_t &isrCount,
     uint32_t ceDesire, bool zeroMem)
 {
-    int rc;
-    struct nvme_reap reap;
+    ceDesire = CalcCEDesire(ceDesire);
+
+    // Allocate enough space to contain the CE's, reusing what already fits
+    if (memBuffer->GetBufSize() != (GetEntrySize() * ceDesire))
+        memBuffer->Init(GetEntrySize() * ceDesire);
+    if (zeroMem)
+        memBuffer->Zero();
+
+    return ReapWorker(ceDesire, memBuffer->GetBuffer(),
+        memBuffer->GetBufSize(), ceRemain, isrCount);
+}
 
+
+uint32_t
+CQ::ReapSpan(uint32_t &ceRemain, struct CESpan &span, uint32_t &isrCount,
+    uint32_t ceDesire)
+{
+    ceDesire = CalcCEDesire(ceDesire);
+
+    // Per NVME spec: 1 empty CE implies a full CQ, never need more than that
+    if (mReapBuf == MemBuffer::NullMemBufferPtr) {
+        mReapBuf = SharedMemBufferPtr(new MemBuffer());
+        mReapBuf->Init(GetEntrySize() * (GetNumEntries() - 1));
+    }
+
+    span.head = mScanHead;
+    span.ce = (union CE *)mReapBuf->GetBuffer();
+    span.num = ReapWorker(ceDesire, mReapBuf->GetBuffer(),
+        (GetEntrySize() * ceDesire), ceRemain, isrCount);
+    return span.num;
+}
+
+
+uint32_t
+CQ::CalcCEDesire(uint32_t ceDesire)
+{
     // The tough part of reaping all which can be reaped, indicated by
     // (ceDesire == 0), is that CE's can be arriving from hdw between the time
     // one calls ReapInquiry() and Reap(). In essence this indicates we really
@@ -377,19 +563,37 @@ CQ::Reap(uint32_t &ceRemain, SharedMemBufferPtr memBuffer, uint32_t &isrCount,
         LOG_NRM("Requested num of CE's exceeds max can fit, resizing");
         ceDesire = (GetNumEntries() - 1);
     }
+    return ceDesire;
+}
 
-    // Allocate enough space to contain the CE's
-    memBuffer->Init(GetEntrySize()*ceDesire);
-    if (zeroMem)
-        memBuffer->Zero();
+
+uint32_t
+CQ::ReapWorker(uint32_t ceDesire, uint8_t *buffer, uint32_t size,
+    uint32_t &ceRemain, uint32_t &isrCount)
+{
+    int rc;
+    struct nvme_reap reap;
 
     reap.q_id = GetQId();
     reap.elements = ceDesire;
-    reap.size = memBuffer->GetBufSize();
-    reap.buffer = memBuffer->GetBuffer();
-    if ((rc = ioctl(mFd, NVME_IOCTL_REAP, &reap)) < 0)
+    reap.size = size;
+    reap.buffer = buffer;
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_REAP, &reap, reap.size)) < 0)
         throw FrmwkEx(HERE, "Error during reaping CE's, rc =%d", rc);
 
+    // Cmd latency ends when the CE's were detected, or now if never waited
+    if (mDetectedValid == false)
+        clock_gettime(CLOCK_MONOTONIC, &mDetected);
+    mDetectedValid = false;
+    Latency::Reaped(buffer, GetEntrySize(), reap.num_reaped, mDetected);
+
+    // Keep the user space scanner in lock step with dnvme's head pointer
+    mScanHead += reap.num_reaped;
+    if (mScanHead >= GetNumEntries()) {
+        mScanHead %= GetNumEntries();
+        mScanPhase ^= 1;
+    }
+
     isrCount = reap.isr_count;
     ceRemain = reap.num_remaining;
     LOG_NRM("Reaped %d CE's, %d remain, from CQ %d, ISR count: %d",
@@ -402,8 +606,12 @@ void
 CQ::Dump(DumpFilename filename, string fileHdr)
 {
     FILE *fp;
-    union CE ce;
-    vector<string> desc;
+
+    if (BinDump::IsFramed()) {
+        BinDump::Write(filename, BINDUMP_CQ, GetQId(), GetEntrySize(),
+            GetQBuffer(), GetQSize(), fileHdr);
+        return;
+    }
 
     Queue::Dump(filename, fileHdr);
 
@@ -411,10 +619,22 @@ CQ::Dump(DumpFilename filename, string fileHdr)
     if ((fp = fopen(filename.c_str(), "a")) == NULL)
         throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
 
+    DumpDecoded(fp, GetQBuffer(), GetNumEntries(), GetEntrySize());
+    fclose(fp);
+}
+
+
+void
+CQ::DumpDecoded(FILE *fp, const uint8_t *buf, uint32_t numEntries,
+    uint16_t entrySize)
+{
+    union CE ce;
+    vector<string> desc;
+
     fprintf(fp, "\nFurther decoding details of the above raw dump follow:\n");
-    for (uint32_t i = 0; i < GetNumEntries(); i++) {
-        ce = PeekCE(i);
-        fprintf(fp, "CE %d @ 0x%08X:\n", i, (i * GetEntrySize()));
+    for (uint32_t i = 0; i < numEntries; i++) {
+        memcpy(&ce, (buf + (i * entrySize)), sizeof(ce));
+        fprintf(fp, "CE %d @ 0x%08X:\n", i, (i * entrySize));
         fprintf(fp, "  Cmd specific: 0x%08X\n", ce.n.cmdSpec);
         fprintf(fp, "  Reserved:     0x%08X\n", ce.n.reserved);
         fprintf(fp, "  SQ head ptr:  0x%04X\n", ce.n.SQHD);
@@ -425,8 +645,6 @@ CQ::Dump(DumpFilename filename, string fileHdr)
         for (size_t j = 0; j < desc.size(); j++ )
             fprintf(fp, "  %s\n", desc[j].c_str());
     }
-
-    fclose(fp);
 }
 
 
@@ -25,6 +25,16 @@ typedef boost::shared_ptr<CQ>               SharedCQPtr;
 #define CAST_TO_CQ(shared_trackable_ptr)    \
         boost::shared_polymorphic_downcast<CQ>(shared_trackable_ptr);
 
+/**
+ * A lightweight view of CE's reaped into a CQ owned buffer. The view is only
+ * valid until the next reap against the same CQ.
+ */
+struct CESpan {
+    union CE *ce;       // 1st reaped CE
+    uint32_t num;       // number of CE's reaped
+    uint16_t head;      // CQ index where the 1st reaped CE resided
+};
+
 
 /**
 * This class extends the base class. It is also not meant to be instantiated.
@@ -64,6 +74,29 @@ public:
     bool GetIrqEnabled() { return mIrqEnabled; }
     uint16_t GetIrqVector() { return mIrqVec; }
 
+    /**
+     * The strategies available to ReapInquiryWaitAny() and
+     * ReapInquiryWaitSpecify() while waiting for CE's to arrive. Every CQ
+     * defaults to WAIT_ADAPTIVE; WAIT_EVENT must be requested explicitly.
+     */
+    typedef enum {
+        WAIT_SLEEP,         // Inquire then sleep a fixed 10us between attempts
+        WAIT_ADAPTIVE,      // Spin on inquiries, then backoff exponentially
+        WAIT_EVENT,         // Block in poll() on the DUT's fd between attempts
+        WAITMODE_FENCE      // always must be last element
+    } WaitMode;
+
+    /**
+     * Select the strategy used while waiting for CE's to arrive.
+     * @param mode Pass the desired strategy; WAIT_EVENT requires this CQ to
+     *        have its IRQ enabled.
+     */
+    void SetWaitMode(WaitMode mode);
+    WaitMode GetWaitMode() { return mWaitMode; }
+
+    /// Returns the number of usec the last ReapInquiryWaitXxx() call waited
+    uint64_t GetLastWaitTime() { return mLastWait_us; }
+
     /**
      * Peek at a Completion Element (CE) at CQ position indicated by indexPtr.
      * Only dnvme can reap CE's from a CQ by calling Reap(), however user space
@@ -101,6 +134,16 @@ public:
      */
     virtual void Dump(DumpFilename filename, string fileHdr);
 
+    /**
+     * Append the decoding of every CE within a CQ's memory to an opened file.
+     * @param fp Pass the file to write
+     * @param buf Pass a copy of the CQ's memory
+     * @param numEntries Pass the number of CE's within buf
+     * @param entrySize Pass the number of bytes of each CE
+     */
+    static void DumpDecoded(FILE *fp, const uint8_t *buf, uint32_t numEntries,
+        uint16_t entrySize);
+
     /**
      * Inquire as to the number of CE's which are present in this CQ. Returns
      * immediately, does not block.
@@ -112,6 +155,18 @@ public:
      */
     uint32_t ReapInquiry(uint32_t &isrCount, bool reportOn0 = false);
 
+    /**
+     * Inquire as to the number of CE's which are present in this CQ without
+     * involving dnvme. The CQ's memory is scanned directly from user space by
+     * tracking the head and expected phase tag locally, these are only
+     * advanced upon calls to Reap(), thus no syscall is ever made. Returns
+     * immediately, does not block, never reports ISR counts. Only logs when
+     * the number awaiting differs from that seen by the previous call.
+     * @param reportOn0 Pass true to report when 0 CE's are awaiting in the CQ
+     * @return The number of unreap'd CE's awaiting
+     */
+    uint32_t ReapInquiryScan(bool reportOn0 = false);
+
     /**
      * Inquire as to the number of CE's which are present in this CQ. If the
      * number of CE's are 0, then a wait period is entered until such time
@@ -159,6 +214,24 @@ public:
     uint32_t Reap(uint32_t &ceRemain, SharedMemBufferPtr memBuffer,
         uint32_t &isrCount, uint32_t ceDesire = 0, bool zeroMem = false);
 
+    /**
+     * Reap a specified number of Completion Elements (CE) from this CQ into
+     * a buffer owned by this CQ. The buffer is allocated once at a capacity
+     * of a full CQ and reused by every subsequent reap, thus no heap activity
+     * nor any extra syscall to learn the head ptr is involved.
+     * @param ceRemain Returns the number of CE's left in the CQ after reaping
+     * @param span Returns a view of the reaped CE's and the CQ index of the
+     *      1st one; only valid until the next reap against this CQ.
+     * @param isrCount Returns the number of ISR's which fired and were counted
+     *        that are assoc with this CQ. If this CQ does not use IRQ's, then
+     *        this value will remain 0.
+     * @param ceDesire Pass the number of CE's desired to be reaped, 0 indicates
+     *      reap all which can be reaped.
+     * @return Returns the actual number of CE's reaped
+     */
+    uint32_t ReapSpan(uint32_t &ceRemain, struct CESpan &span,
+        uint32_t &isrCount, uint32_t ceDesire = 0);
+
 
 protected:
     /**
@@ -193,6 +266,37 @@ private:
 
     bool mIrqEnabled;
     uint16_t mIrqVec;
+    WaitMode mWaitMode;
+    uint64_t mLastWait_us;
+
+    /// The locally tracked CQ head and the phase tag expected at that head
+    uint32_t mScanHead;
+    uint8_t mScanPhase;
+    /// The number of CE's seen awaiting by the previous ReapInquiryScan()
+    uint32_t mScanReported;
+
+    /// When the last wait detected CE's, consumed by the next reap
+    struct timespec mDetected;
+    bool mDetectedValid;
+
+    /// Persistent buffer backing ReapSpan(), sized to hold a full CQ
+    SharedMemBufferPtr mReapBuf;
+
+    /**
+     * Issue the reap ioctl and advance the local head/phase tracking.
+     * @return Returns the actual number of CE's reaped
+     */
+    uint32_t ReapWorker(uint32_t ceDesire, uint8_t *buffer, uint32_t size,
+        uint32_t &ceRemain, uint32_t &isrCount);
+
+    /// Clamps ceDesire to what a CQ can hold, 0 indicates all that can be
+    uint32_t CalcCEDesire(uint32_t ceDesire);
+
+    /// Resets the local head/phase tracking to that of a newly created CQ
+    void ResetScan();
+
+    /// Returns the start of the CQ's content memory, contig or discontig
+    volatile union CE *GetCEBuffer();
 
     /**
      * Create an IOCQ
@@ -200,14 +304,38 @@ private:
      */
     void CreateIOCQ(struct nvme_prep_cq &q);
 
+    /**
+     * Wait until at least numTil CE's, and never 0, become available or until
+     * a time out period expires. The strategy is dictated by mWaitMode.
+     * @param ms Pass the max number of ms to wait until numTil CE's arrive.
+     * @param numTil Pass the number of CE's that need to become available
+     * @param numCE Returns the number of unreap'd CE's awaiting
+     * @param isrCount Returns the number of ISR's which fired and were counted
+     * @return true when CE's are awaiting to be reaped, otherwise a timeout
+     */
+    bool WaitWorker(uint32_t ms, uint32_t numTil, uint32_t &numCE,
+        uint32_t &isrCount);
+
+    /**
+     * Block on the DUT's fd until dnvme signals readiness or the period
+     * expires, whichever comes first.
+     * @param us Pass the max number of usec to block
+     * @return true if the fd became ready, false if the period expired
+     */
+    bool WaitForEvent(uint32_t us);
+
+    /// Log the CQ metrics and CE's surrounding head/tail after a timeout
+    void LogTimeoutState();
+
     /**
      * Calculate if a timeout (TO) period has expired
      * @param ms Pass the number of ms indicating the TO period
-     * @param initial Pass the time when the period starting
-     * @param delta Return the calc'd time passage as the number of ms.
+     * @param initial Pass the CLOCK_MONOTONIC time when the period started
+     * @param delta_us Return the calc'd time passage as the number of usec.
      * @return true if the TO has expired, false otherwise
      */
-    bool CalcTimeout(uint32_t ms, struct timeval &initial, uint32_t &delta);
+    bool CalcTimeout(uint32_t ms, struct timespec &initial,
+        uint64_t &delta_us);
 };
 
 
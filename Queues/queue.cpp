@@ -16,6 +16,7 @@
 
 #include "queue.h"
 #include "../Utils/buffers.h"
+#include "../Utils/binDump.h"
 
 
 Queue::Queue() : Trackable(Trackable::OBJTYPE_FENCE)
@@ -97,5 +98,10 @@ Queue::Log(uint32_t bufOffset, unsigned long length)
 void
 Queue::Dump(DumpFilename filename, string fileHdr)
 {
+    if (BinDump::IsFramed()) {
+        BinDump::Write(filename, BINDUMP_QUEUE, GetQId(), GetEntrySize(),
+            GetQBuffer(), GetQSize(), fileHdr);
+        return;
+    }
     Buffers::Dump(filename, GetQBuffer(), 0, ULONG_MAX, GetQSize(), fileHdr);
 }
@@ -14,9 +14,11 @@
  *  limitations under the License.
  */
 
+#include <string.h>
 #include "sq.h"
 #include "globals.h"
 #include "../Utils/kernelAPI.h"
+#include "../Utils/latency.h"
 
 SharedSQPtr SQ::NullSQPtr;
 
@@ -94,7 +96,7 @@ SQ::Init(uint16_t qId, uint16_t entrySize, uint32_t numEntries, uint16_t cqId)
             "(%d, %d, %d, %d)", GetQId(), GetCqId(), GetEntrySize(),
             GetNumEntries());
 
-        if ((ret = ioctl(mFd, NVME_IOCTL_CREATE_ADMN_Q, &q)) < 0) {
+        if ((ret = KernelAPI::ioctl(mFd, NVME_IOCTL_CREATE_ADMN_Q, &q)) < 0) {
             throw FrmwkEx(HERE, 
                 "Q Creation failed by dnvme with error: 0x%02X", ret);
         }
@@ -183,7 +185,7 @@ SQ::CreateIOSQ(struct nvme_prep_sq &q)
 {
     int ret;
 
-    if ((ret = ioctl(mFd, NVME_IOCTL_PREPARE_SQ_CREATION, &q)) < 0) {
+    if ((ret = KernelAPI::ioctl(mFd, NVME_IOCTL_PREPARE_SQ_CREATION, &q)) < 0) {
         throw FrmwkEx(HERE, 
             "Q Creation failed by dnvme with error: 0x%02X", ret);
     }
@@ -202,7 +204,8 @@ SQ::GetQMetrics()
     getQMetrics.nBytes = sizeof(qMetrics);
     getQMetrics.buffer = (uint8_t *)&qMetrics;
 
-    if ((ret = ioctl(mFd, NVME_IOCTL_GET_Q_METRICS, &getQMetrics)) < 0) {
+    if ((ret = KernelAPI::ioctl(mFd, NVME_IOCTL_GET_Q_METRICS, &getQMetrics,
+        getQMetrics.nBytes)) < 0) {
         throw FrmwkEx(HERE, 
             "Get Q metrics failed by dnvme with error: 0x%02X", ret);
     }
@@ -233,65 +236,107 @@ void
 SQ::LogSE(uint16_t indexPtr)
 {
     union SE se = PeekSE(indexPtr);
+    uint32_t dw[sizeof(se) / sizeof(uint32_t)];
+    char prefix[64];           // Bounds each line, thus work never overflows
+    char work[2048];
+    int len = 0;
+
     LOG_NRM("Logging Submission Element (SE)...");
-    LOG_NRM("SQ %d, SE %d, DWORD0:  0x%08X", GetQId(), indexPtr, se.d.dw0);
-    LOG_NRM("SQ %d, SE %d, DWORD1:  0x%08X", GetQId(), indexPtr, se.d.dw1);
-    LOG_NRM("SQ %d, SE %d, DWORD2:  0x%08X", GetQId(), indexPtr, se.d.dw2);
-    LOG_NRM("SQ %d, SE %d, DWORD3:  0x%08X", GetQId(), indexPtr, se.d.dw3);
-    LOG_NRM("SQ %d, SE %d, DWORD4:  0x%08X", GetQId(), indexPtr, se.d.dw4);
-    LOG_NRM("SQ %d, SE %d, DWORD5:  0x%08X", GetQId(), indexPtr, se.d.dw5);
-    LOG_NRM("SQ %d, SE %d, DWORD6:  0x%08X", GetQId(), indexPtr, se.d.dw6);
-    LOG_NRM("SQ %d, SE %d, DWORD7:  0x%08X", GetQId(), indexPtr, se.d.dw7);
-    LOG_NRM("SQ %d, SE %d, DWORD8:  0x%08X", GetQId(), indexPtr, se.d.dw8);
-    LOG_NRM("SQ %d, SE %d, DWORD9:  0x%08X", GetQId(), indexPtr, se.d.dw9);
-    LOG_NRM("SQ %d, SE %d, DWORD10: 0x%08X", GetQId(), indexPtr, se.d.dw10);
-    LOG_NRM("SQ %d, SE %d, DWORD11: 0x%08X", GetQId(), indexPtr, se.d.dw11);
-    LOG_NRM("SQ %d, SE %d, DWORD12: 0x%08X", GetQId(), indexPtr, se.d.dw12);
-    LOG_NRM("SQ %d, SE %d, DWORD13: 0x%08X", GetQId(), indexPtr, se.d.dw13);
-    LOG_NRM("SQ %d, SE %d, DWORD14: 0x%08X", GetQId(), indexPtr, se.d.dw14);
-    LOG_NRM("SQ %d, SE %d, DWORD15: 0x%08X", GetQId(), indexPtr, se.d.dw15);
+    if (Logger::GetVerbosity() < LOGLVL_NRM)
+        return;
+
+    // All DWORDs within a single log statement, each line as LOG_NRM would be
+    memcpy(dw, &se, sizeof(dw));
+    LOG_NRM_PREFIX(prefix, sizeof(prefix));
+    for (size_t i = 0; i < (sizeof(dw) / sizeof(dw[0])); i++) {
+        len += snprintf(&work[len], (sizeof(work) - len),
+            "%sSQ %d, SE %d, DWORD%d:%s0x%08X\n", prefix, GetQId(),
+            indexPtr, (int)i, ((i < 10) ? "  " : " "), dw[i]);
+    }
+    Logger::Write(LOGLVL_NRM, work, len);
 }
 
 
 void
 SQ::Send(SharedCmdPtr cmd, uint16_t &uniqueId)
 {
-    int rc;
-    struct nvme_64b_send io;
+    // Detect if doing something that looks suspicious/incorrect/illegal
+    if (gCtrlrConfig->IsStateEnabled() == false)
+        LOG_WARN("Sending cmds to a disabled DUT is suspicious");
+
+    LOG_NRM("Send cmd opcode 0x%02X, payload size 0x%04X, to SQ id 0x%02X",
+        cmd->GetOpcode(), (uint32_t)cmd->GetPrpBufferSize(), GetQId());
+    SendWorker(cmd, uniqueId);
+}
 
 
+void
+SQ::SendBatch(const vector<SharedCmdPtr> &cmds, vector<uint16_t> &uniqueIds)
+{
+    uniqueIds.clear();
+    if (cmds.empty())
+        return;
+
+    // Per NVME spec: 1 empty SE implies a full SQ, can't truly fill all
+    if (cmds.size() > (GetNumEntries() - 1)) {
+        throw FrmwkEx(HERE, "Batch of %ld cmds exceeds SQ %d capacity of %d",
+            cmds.size(), GetQId(), (GetNumEntries() - 1));
+    }
+
     // Detect if doing something that looks suspicious/incorrect/illegal
     if (gCtrlrConfig->IsStateEnabled() == false)
         LOG_WARN("Sending cmds to a disabled DUT is suspicious");
 
+    LOG_NRM("Send batch of %ld cmds, 1st opcode 0x%02X, to SQ id 0x%02X",
+        cmds.size(), cmds[0]->GetOpcode(), GetQId());
+
+    uniqueIds.resize(cmds.size());
+    for (size_t i = 0; i < cmds.size(); i++)
+        SendWorker(cmds[i], uniqueIds[i]);
+}
+
+
+void
+SQ::SendWorker(SharedCmdPtr cmd, uint16_t &uniqueId)
+{
+    int rc;
+    struct nvme_64b_send io;
+
     io.q_id = GetQId();
     io.bit_mask = (send_64b_bitmask)(cmd->GetPrpBitmask() |
         cmd->GetMetaBitmask());
     io.meta_buf_id = cmd->GetMetaBufferID();
     io.data_buf_size = cmd->GetPrpBufferSize();
     io.data_buf_ptr = cmd->GetROPrpBuffer();
-    io.cmd_buf_ptr = cmd->GetCmd()->GetBuffer();
+    io.cmd_buf_ptr = cmd->GetCmd();
     io.data_dir = cmd->GetDataDir();
 
-    LOG_NRM("Send cmd opcode 0x%02X, payload size 0x%04X, to SQ id 0x%02X",
-        cmd->GetOpcode(), io.data_buf_size, io.q_id);
-
-    if ((rc = ioctl(mFd, NVME_IOCTL_SEND_64B_CMD, &io)) < 0)
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_SEND_64B_CMD, &io,
+        (cmd->GetCmdSizeB() + io.data_buf_size))) < 0)
         throw FrmwkEx(HERE, "Error sending cmd, rc =%d", rc);
 
     // Allow tnvme to learn of the unique cmd ID which was assigned by dnvme
     uniqueId = io.unique_id;
     cmd->SetCID(io.unique_id);
+    Latency::Sent(GetQId(), GetNumEntries(), uniqueId, *cmd);
 }
 
 
 void
 SQ::Ring()
+{
+    LOG_NRM("Ring doorbell for SQ %d", GetQId());
+    RingQuiet();
+}
+
+
+void
+SQ::RingQuiet()
 {
     int rc;
     uint16_t sqId = GetQId();
 
-    LOG_NRM("Ring doorbell for SQ %d", sqId);
-    if ((rc = ioctl(mFd, NVME_IOCTL_RING_SQ_DOORBELL, sqId)) < 0)
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_RING_SQ_DOORBELL, sqId)) < 0)
         throw FrmwkEx(HERE, "Error ringing doorbell, rc =%d", rc);
+    Latency::Rung(sqId);
 }
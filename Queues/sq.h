@@ -80,12 +80,37 @@ public:
      */
     virtual void Send(SharedCmdPtr cmd, uint16_t &uniqueId);
 
+    /**
+     * Issue the specified cmds to this queue in order, but does not ring any
+     * doorbell. The outcome is identical to calling Send() for each cmd,
+     * however the sanity checks and logging are performed once for the entire
+     * batch rather than once per cmd. Follow with a single call to Ring().
+     * @note dnvme accepts only 1 cmd per NVME_IOCTL_SEND_64B_CMD, thus each
+     *       cmd still requires 1 ioctl.
+     * @param cmds Pass the cmds to send to this queue, the same cmd may be
+     *      listed more than once.
+     * @param uniqueIds Returns the dnvme assigned unique cmd ID's, where
+     *      uniqueIds[i] corresponds to cmds[i]
+     */
+    virtual void SendBatch(const vector<SharedCmdPtr> &cmds,
+        vector<uint16_t> &uniqueIds);
+
     /**
      * Ring the doorbell assoc with this SQ. This will commit to hardware all
      * prior cmds which were sent via Send().
      */
     void Ring();
 
+    /**
+     * Identical to Send() and Ring() respectively, but without any sanity
+     * checks or logging. Meant for IOEngine, which keeps so many cmds in
+     * flight that logging each one would dominate its cost; the caller is
+     * responsible for logging its activity as a whole.
+     */
+    void SendQuiet(SharedCmdPtr cmd, uint16_t &uniqueId)
+        { SendWorker(cmd, uniqueId); }
+    void RingQuiet();
+
 
 protected:
     /**
@@ -118,6 +143,14 @@ private:
 
     uint16_t mCqId;
 
+    /**
+     * Perform the underlying NVME_IOCTL_SEND_64B_CMD for Send() and
+     * SendBatch() without any logging.
+     * @param cmd Pass the cmd to send to this queue.
+     * @param uniqueId Returns the dnvme assigned unique cmd ID
+     */
+    void SendWorker(SharedCmdPtr cmd, uint16_t &uniqueId);
+
     /**
      * Create an IOSQ
      * @param q Pass the IOSQ's definition
@@ -16,6 +16,7 @@
 
 #include "ctrlrConfig.h"
 #include "globals.h"
+#include "../Utils/kernelAPI.h"
 #include "../Exception/frmwkEx.h"
 
 const uint16_t CtrlrConfig::MAX_MSI_SINGLE_IRQ_VEC = 0;
@@ -122,7 +123,7 @@ CtrlrConfig::GetIrqScheme(enum nvme_irq_type &irq, uint16_t &numIrqs)
 {
     public_metrics_dev state;
 
-    if (ioctl(mFd, NVME_IOCTL_GET_DEVICE_METRICS, &state) < 0) {
+    if (KernelAPI::ioctl(mFd, NVME_IOCTL_GET_DEVICE_METRICS, &state) < 0) {
         LOG_ERR("Unable to get IRQ scheme");
         return false;
     }
@@ -158,7 +159,7 @@ CtrlrConfig::SetIrqScheme(enum nvme_irq_type newIrq, uint16_t numIrqs)
     struct interrupts state;
     state.irq_type = newIrq;
     state.num_irqs = numIrqs;
-    if (ioctl(mFd, NVME_IOCTL_SET_IRQ, &state) < 0) {
+    if (KernelAPI::ioctl(mFd, NVME_IOCTL_SET_IRQ, &state) < 0) {
         LOG_ERR("%s", irqDesc.c_str());
         return false;
     }
@@ -233,7 +234,7 @@ CtrlrConfig::SetState(enum nvme_state state)
     }
 
     LOG_NRM("%s the NVME device", toState.c_str());
-    if (ioctl(mFd, NVME_IOCTL_DEVICE_STATE, state) < 0) {
+    if (KernelAPI::ioctl(mFd, NVME_IOCTL_DEVICE_STATE, state) < 0) {
         LOG_ERR("Could not set state, currently %s",
             IsStateEnabled() ? "enabled" : "disabled");
         LOG_NRM("dnvme waits a TO period for CC.RDY to indicate ready" );
@@ -17,8 +17,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <errno.h>
 #include "memBuffer.h"
 #include "../Utils/buffers.h"
+#include "../Utils/bufferPool.h"
+#include "../Utils/patternGen.h"
 #include "../Exception/frmwkEx.h"
 
 SharedMemBufferPtr MemBuffer::NullMemBufferPtr;
@@ -50,8 +53,9 @@ MemBuffer::~MemBuffer()
 void
 MemBuffer::InitMemberVariables()
 {
-    mAllocByNewOperator = true;
+    mAllocType = ALLOC_NEW;
     mRealBaseAddr = NULL;
+    mRealBufSize = 0;
     mVirBaseAddr = NULL;
     mVirBufSize = 0;
     mAlignment = 0;
@@ -61,13 +65,18 @@ MemBuffer::InitMemberVariables()
 void
 MemBuffer::DeallocateResources()
 {
-    // Either new or posix_memalign() was used to allocate memory
-    if (mAllocByNewOperator) {
-        if (mRealBaseAddr)
+    if (mRealBaseAddr) {
+        switch (mAllocType) {
+        case ALLOC_NEW:
             delete [] mRealBaseAddr;
-    } else {
-        if (mRealBaseAddr)
+            break;
+        case ALLOC_MEMALIGN:
             free(mRealBaseAddr);
+            break;
+        case ALLOC_POOL:
+            BufferPool::Free(mRealBaseAddr, mRealBufSize);
+            break;
+        }
     }
     InitMemberVariables();
 }
@@ -77,11 +86,8 @@ void
 MemBuffer::InitOffset1stPage(uint32_t bufSize, uint32_t offset1stPg,
     bool initMem, uint8_t initVal)
 {
-    int err;
-    uint32_t realBufSize;
     uint32_t align = sysconf(_SC_PAGESIZE);
 
-
     LOG_NRM(
         "Init buffer; size: 0x%08X, offset: 0x%08X, init: %d, value: 0x%02X",
         bufSize, offset1stPg, initMem, initVal);
@@ -93,18 +99,17 @@ MemBuffer::InitOffset1stPage(uint32_t bufSize, uint32_t offset1stPg,
     // Support resizing/reallocation
     if (mRealBaseAddr != NULL)
         DeallocateResources();
-    mAllocByNewOperator = false;  // using posix_memalign()
+    mAllocType = ALLOC_POOL;
 
     // All memory is allocated page aligned, offsets into the 1st page requires
     // asking for more memory than the caller desires and then tracking the
     // virtual pointer into the real allocation as a side affect.
     mVirBufSize = bufSize;
-    realBufSize = (bufSize + offset1stPg);
-    err = posix_memalign((void **)&mRealBaseAddr, align, realBufSize);
-    if (err) {
+    mRealBufSize = (bufSize + offset1stPg);
+    mRealBaseAddr = BufferPool::Alloc(mRealBufSize);
+    if (mRealBaseAddr == NULL) {
         InitMemberVariables();
-        throw FrmwkEx(HERE, "Memory allocation failed with error code: 0x%02X",
-            err);
+        throw FrmwkEx(HERE, "Memory allocation failed");
     }
     mVirBaseAddr = (mRealBaseAddr + offset1stPg);
     if (offset1stPg)
@@ -133,10 +138,18 @@ MemBuffer::InitAlignment(uint32_t bufSize, uint32_t align, bool initMem,
     // Support resizing/reallocation
     if (mRealBaseAddr != NULL)
         DeallocateResources();
-    mAllocByNewOperator = false;  // using posix_memalign()
 
+    // Any alignment which divides a page is satisfied by page aligned memory
     mVirBufSize = bufSize;
-    err = posix_memalign((void **)&mRealBaseAddr, align, mVirBufSize);
+    mRealBufSize = bufSize;
+    if (align && ((sysconf(_SC_PAGESIZE) % align) == 0)) {
+        mAllocType = ALLOC_POOL;
+        mRealBaseAddr = BufferPool::Alloc(mRealBufSize);
+        err = (mRealBaseAddr == NULL) ? ENOMEM : 0;
+    } else {
+        mAllocType = ALLOC_MEMALIGN;
+        err = posix_memalign((void **)&mRealBaseAddr, align, mRealBufSize);
+    }
     if (err) {
         InitMemberVariables();
         throw FrmwkEx(HERE, "Memory allocation failed with error code: 0x%02X",
@@ -159,9 +172,10 @@ MemBuffer::Init(uint32_t bufSize, bool initMem, uint8_t initVal)
     // Support resizing/reallocation
     if (mRealBaseAddr != NULL)
         DeallocateResources();
-    mAllocByNewOperator = true;
+    mAllocType = ALLOC_NEW;
 
     mVirBufSize = bufSize;
+    mRealBufSize = bufSize;
     mRealBaseAddr = new (nothrow) uint8_t[mVirBufSize];
     if (mRealBaseAddr == NULL) {
         InitMemberVariables();
@@ -201,7 +215,7 @@ void
 MemBuffer::SetDataPattern(DataPattern dataPat, uint64_t initVal,
     uint32_t offset, uint32_t length)
 {
-    LOG_NRM("Write data pattern: initial value = 0x%016llX",
+    LOG_NRM("Write data pattern %d: initial value = 0x%016llX", dataPat,
         (long long unsigned int)initVal);
 
     if (mRealBaseAddr == NULL)
@@ -211,80 +225,117 @@ MemBuffer::SetDataPattern(DataPattern dataPat, uint64_t initVal,
     if ((length + offset) > GetBufSize())
         throw FrmwkEx(HERE, "Length exceeds total buffer size");
 
-    switch (dataPat)
-    {
-    case DATAPAT_CONST_8BIT:
-        {
-            LOG_NRM("Write data pattern: constant 8 bit");
-            uint8_t *rawPtr = (uint8_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < length; i++)
-                *rawPtr++ = (uint8_t)initVal;
-        }
-        break;
-
-    case DATAPAT_CONST_16BIT:
-        {
-            LOG_NRM("Write data pattern: constant 16 bit");
-            uint16_t *rawPtr = (uint16_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint16_t)); i++)
-                *rawPtr++ = (uint16_t)initVal;
-        }
-        break;
-
-    case DATAPAT_CONST_32BIT:
-        {
-            LOG_NRM("Write data pattern: constant 32 bit");
-            uint32_t *rawPtr = (uint32_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint32_t)); i++)
-                *rawPtr++ = (uint32_t)initVal;
-        }
-        break;
-
-    case DATAPAT_INC_8BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 8 bit");
-            uint8_t *rawPtr = (uint8_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < length; i++)
-                *rawPtr++ = (uint8_t)initVal++;
-        }
-        break;
-
-    case DATAPAT_INC_16BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 16 bit");
-            uint16_t *rawPtr = (uint16_t *)(GetBuffer() + offset);
-            LOG_NRM("Length = %d GetBufSize = %d, offset = %d", length,
-                GetBufSize(), offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint16_t)); i++)
-                *rawPtr++ = (uint16_t)initVal++;
-        }
-        break;
-
-    case DATAPAT_INC_32BIT:
-        {
-            LOG_NRM("Write data pattern: incrementing 32 bit");
-            uint32_t *rawPtr = (uint32_t *)(GetBuffer() + offset);
-            for (uint64_t i = 0; i < (length / sizeof(uint32_t)); i++)
-                *rawPtr++ = (uint32_t)initVal++;
-        }
-        break;
+    if (PatternGen::Fill(dataPat, initVal, (GetBuffer() + offset),
+        length) == false) {
+        throw FrmwkEx(HERE, "Unsupported data pattern %d", dataPat);
+    }
+}
+
+
+void
+MemBuffer::SetDataPattern(const BlkTagParams &params)
+{
+    LOG_NRM("Write tagged blks: NSID 0x%08X, SLBA 0x%016llX, generation %d",
+        params.nsid, (long long unsigned int)params.slba, params.generation);
+
+    if (mRealBaseAddr == NULL)
+        return;
+
+    if ((params.lbaDataSize == 0) || (GetBufSize() % params.lbaDataSize)) {
+        throw FrmwkEx(HERE, "Buffer size 0x%08X is not modulo LBA size 0x%X",
+            GetBufSize(), params.lbaDataSize);
+    }
+    if (BlkTag::Fill(params, GetBuffer(), (GetBufSize() / params.lbaDataSize))
+        == false) {
+        throw FrmwkEx(HERE, "Unable to write tagged blks");
+    }
+}
+
+
+bool
+MemBuffer::VerifyDataPattern(const BlkTagParams &params)
+{
+    BlkTagResult result;
+    return VerifyDataPattern(params, result);
+}
 
-    default:
+
+bool
+MemBuffer::VerifyDataPattern(const BlkTagParams &params,
+    BlkTagResult &result)
+{
+    LOG_NRM("Verify tagged blks: NSID 0x%08X, SLBA 0x%016llX, generation %d",
+        params.nsid, (long long unsigned int)params.slba, params.generation);
+
+    if ((params.lbaDataSize == 0) || (GetBufSize() % params.lbaDataSize)) {
+        throw FrmwkEx(HERE, "Buffer size 0x%08X is not modulo LBA size 0x%X",
+            GetBufSize(), params.lbaDataSize);
+    }
+
+    uint32_t numBlks = (GetBufSize() / params.lbaDataSize);
+    if (BlkTag::Verify(params, GetBuffer(), numBlks, result) == false) {
+        if (result.numBlks != numBlks)
+            throw FrmwkEx(HERE, "Unable to verify tagged blks");
+        BlkTag::Log(result);
+        return false;
+    }
+    return true;
+}
+
+
+bool
+MemBuffer::VerifyDataPattern(DataPattern dataPat, uint64_t initVal,
+    uint32_t offset, uint32_t length)
+{
+    Miscompare result;
+    return VerifyDataPattern(dataPat, initVal, offset, length, 0, result);
+}
+
+
+bool
+MemBuffer::VerifyDataPattern(DataPattern dataPat, uint64_t initVal,
+    uint32_t offset, uint32_t length, uint32_t granule, Miscompare &result)
+{
+    LOG_NRM("Verify data pattern %d: initial value = 0x%016llX", dataPat,
+        (long long unsigned int)initVal);
+
+    if (offset > GetBufSize())
+        throw FrmwkEx(HERE, "Offset exceeds total buffer size");
+    length = (length == UINT32_MAX) ? (GetBufSize() - offset) : length;
+    if ((length + offset) > GetBufSize())
+        throw FrmwkEx(HERE, "Length exceeds total buffer size");
+    if (dataPat >= DATAPATTERN_FENCE)
         throw FrmwkEx(HERE, "Unsupported data pattern %d", dataPat);
+
+    if (BufCompare::Verify(dataPat, initVal, (GetBuffer() + offset), length,
+        granule, result) == false) {
+        BufCompare::Log(result);
+        return false;
     }
+    return true;
 }
 
 
 bool
 MemBuffer::Compare(const SharedMemBufferPtr compTo)
+{
+    Miscompare result;
+    return Compare(compTo, 0, result);
+}
+
+
+bool
+MemBuffer::Compare(const SharedMemBufferPtr compTo, uint32_t granule,
+    Miscompare &result)
 {
     if (compTo->GetBufSize() != GetBufSize()) {
         throw FrmwkEx(HERE, "Compare buffers not same size: %d != %d",
             compTo->GetBufSize(), GetBufSize());
     }
 
-    if (memcmp(compTo->GetBuffer(), GetBuffer(), GetBufSize()) != 0) {
-        LOG_ERR("Detected data miscompare");
+    if (BufCompare::Compare(compTo->GetBuffer(), GetBuffer(), GetBufSize(),
+        granule, result) == false) {
+        BufCompare::Log(result);
         return false;
     }
     return true;
@@ -294,18 +345,17 @@ MemBuffer::Compare(const SharedMemBufferPtr compTo)
 bool
 MemBuffer::Compare(const vector<uint8_t> &compTo)
 {
+    Miscompare result;
+
     if (compTo.size() != GetBufSize()) {
         throw FrmwkEx(HERE, "Compare buffers not same size: %d != %d",
             compTo.size(), GetBufSize());
     }
 
-    vector<uint8_t>::const_iterator iterCompTo = compTo.begin();
-    uint8_t *iterThis = GetBuffer();
-    for (size_t i = 0; i < GetBufSize(); i++, iterCompTo++, iterThis++) {
-        if (*iterCompTo != *iterThis) {
-            LOG_ERR("Detected data miscompare @ index = %ld(0x%08lX)", i, i);
-            return false;
-        }
+    if (GetBufSize() && (BufCompare::Compare(&compTo[0], GetBuffer(),
+        GetBufSize(), 0, result) == false)) {
+        BufCompare::Log(result);
+        return false;
     }
     return true;
 }
@@ -22,6 +22,8 @@
 #include "trackable.h"
 #include "limits.h"
 #include "../Utils/fileSystem.h"
+#include "../Utils/bufCompare.h"
+#include "../Utils/blkTag.h"
 
 #define PRP_BUFFER_ALIGNMENT        128
 
@@ -60,7 +62,8 @@ public:
      * may be allocated than requested to satisfy the request. If a specific
      * offset into a page is not strictly necessary then calling
      * InitAlignment() should be more efficient at allocations, because entire
-     * pages of memory may not be required to satisfy the request.
+     * pages of memory may not be required to satisfy the request. Memory is
+     * drawn from, and later returned to, the BufferPool.
      * @param bufSize Pass the minimum number of bytes for buffer creation
      * @param offset1stPg Pass the byte offset into the 1st page of allocated
      *        memory which the buffer is intended to start. offset == 0 implies
@@ -77,7 +80,8 @@ public:
      * not the offset into the 1st page of the allocation. Residual memory
      * may be consumed to satisfy this request since entire pages of memory
      * may not be necessary, and therefore the allocation of > what was
-     * requested will not be necessary.
+     * requested will not be necessary. Memory is drawn from the BufferPool
+     * when align divides evenly into a page.
      * @param bufSize Pass the number of bytes for buffer creation
      * @param align Pass the alignment requirements of the buffer. This value
      *        is enforced to a multiple of sizeof(void *) alignment at min.
@@ -124,11 +128,59 @@ public:
     void SetDataPattern(DataPattern dataPat, uint64_t initVal = 0,
         uint32_t offset = 0, uint32_t length = UINT32_MAX);
 
+    /**
+     * Fill the entire buffer with consecutive self describing logical blocks,
+     * see class BlkTag. The buffer size must be modulo params.lbaDataSize.
+     * @param params Pass the tag of the series, params.slba is the LBA of the
+     *        1st block within the buffer
+     */
+    void SetDataPattern(const BlkTagParams &params);
+
+    /**
+     * Verify the entire buffer contains the logical blocks which
+     * SetDataPattern() would have written given the same params. Upon
+     * failure the details are logged.
+     * @param params Pass the tag of the series which is expected
+     * @param result Returns the details of every block which didn't verify
+     * @return true when every block verified, false upon any bad block,
+     *      throws upon the inability to verify.
+     */
+    bool VerifyDataPattern(const BlkTagParams &params);
+    bool VerifyDataPattern(const BlkTagParams &params, BlkTagResult &result);
+
+    /**
+     * Verify a segment of the data buffer contains the data pattern/series
+     * which SetDataPattern() would have written given the same parameters.
+     * The expected data is generated on the fly rather than retained in a
+     * 2nd buffer. Upon miscompare the details are logged.
+     * @param dataPat Pass the expected data pattern/series
+     * @param initVal Pass the 1st value of the pattern/series
+     * @param offset Pass offset into the data buf which is start of segment
+     * @param length Pass the number of bytes of the segment length, value
+     *        of UINT32_MAX implies infinite length.
+     * @return true when the segment contains the pattern, false upon
+     *      miscompare, throws upon the inability to verify.
+     */
+    bool VerifyDataPattern(DataPattern dataPat, uint64_t initVal = 0,
+        uint32_t offset = 0, uint32_t length = UINT32_MAX);
+
+    /**
+     * Same as above, but also returning where the segment differs.
+     * @param granule Pass the bytes per granule into which miscompares are
+     *        grouped into ranges, i.e. the LBA data size.
+     * @param result Returns the details of where the segment differs,
+     *        offsets are relative to the start of the segment.
+     */
+    bool VerifyDataPattern(DataPattern dataPat, uint64_t initVal,
+        uint32_t offset, uint32_t length, uint32_t granule,
+        Miscompare &result);
+
     /// Zero out all memory bytes
     void Zero() { SetDataPattern(DATAPAT_CONST_8BIT, 0); }
 
     /**
-     * Compare a specified MemBuffer to this one.
+     * Compare a specified MemBuffer to this one. Upon miscompare the 1st
+     * offset, number of bytes and ranges which differ are logged.
      * @param compTo Pass a reference to the memory to compare against
      * @return true upon all data exactly identical, false is miscompare, and
      *      throws when buffers are not of same size or other serious error
@@ -137,6 +189,15 @@ public:
     bool Compare(const SharedMemBufferPtr compTo);
     bool Compare(const vector<uint8_t> &compTo);
 
+    /**
+     * Same as above, but also returning where the buffers differ.
+     * @param granule Pass the bytes per granule into which miscompares are
+     *        grouped into ranges, i.e. the LBA data size.
+     * @param result Returns the details of where the buffers differ
+     */
+    bool Compare(const SharedMemBufferPtr compTo, uint32_t granule,
+        Miscompare &result);
+
     /**
      * Send the entire contents of this buffer to the logging endpoint
      * @param bufOffset Pass the offset byte for which to start dumping
@@ -154,8 +215,15 @@ public:
 
 
 private:
-    bool mAllocByNewOperator;
-    uint8_t *mRealBaseAddr;     // System address returned by posix_memalign()
+    typedef enum {
+        ALLOC_NEW,              // new []
+        ALLOC_MEMALIGN,         // posix_memalign()
+        ALLOC_POOL              // BufferPool::Alloc()
+    } AllocType;
+
+    AllocType mAllocType;
+    uint8_t *mRealBaseAddr;     // System address returned by the allocator
+    uint32_t mRealBufSize;      // Bytes reserved at mRealBaseAddr
     uint8_t *mVirBaseAddr;      // User buffer address to satisfy mOffset1stPg
     uint32_t mVirBufSize;       // User request buffer size
     uint32_t mAlignment;
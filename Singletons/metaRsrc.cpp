@@ -56,7 +56,8 @@ MetaRsrc::SetMetaAllocSize(uint32_t allocSize)
         LOG_ERR("Requested meta data alloc size is not modulo %ld",
             sizeof(uint32_t));
         return false;
-    } else if ((rc = ioctl(mFd, NVME_IOCTL_METABUF_CREATE, allocSize)) < 0) {
+    } else if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_METABUF_CREATE,
+        allocSize)) < 0) {
         LOG_ERR("Meta data size request denied with error: %d", rc);
         return false;
     }
@@ -69,108 +70,103 @@ MetaRsrc::SetMetaAllocSize(uint32_t allocSize)
 
 bool
 MetaRsrc::ReserveMetaBuf(MetaDataBuf &metaBuf)
+{
+    // If meta buffers were previously alloc'd and then subsequently released,
+    // we can quickly turn them back into usability again; saves calls to dnvme
+    if (mMetaReleased.empty() && (AllocMetaBuf() == false))
+        return false;
+
+    uint32_t id = mMetaReleased.back();
+    mMetaReleased.pop_back();
+    mMetaReserved[id] = true;
+    metaBuf = mMetaBufs[id];
+    LOG_NRM("Alloc meta data buf: size: 0x%08X, ID: 0x%06X",
+        metaBuf.size, metaBuf.ID);
+    return true;
+}
+
+
+bool
+MetaRsrc::AllocMetaBuf()
 {
     int rc;
-    metaBuf.ID = 0;
-    metaBuf.size = mMetaAllocSize;
-    deque<MetaDataBuf>::iterator resIter = mMetaReserved.begin();
-    deque<MetaDataBuf>::iterator relIter = mMetaReleased.begin();
+    MetaDataBuf metaBuf(NULL, mMetaAllocSize, mMetaBufs.size());
 
+    // Is the next ID within dnvme's max allowed range?
+    if (metaBuf.ID >= (1 << METADATA_UNIQUE_ID_BITS))
+        return false;
 
-    // If meta buffers were previously alloc'd and then subsequently released,
-    // we can quickly turn them back into usability again; saves calls to dnvme
-    if (relIter != mMetaReleased.end()) {
-        // Search the ordered elements for a place to insert into Reserved
-        while (resIter != mMetaReserved.end()) {
-            if ((*resIter).ID > (*relIter).ID)
-                break;
-            resIter++;
-        }
+    // Request dnvme to reserve us some contiguous memory
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_METABUF_ALLOC,
+        metaBuf.ID)) < 0) {
+        throw FrmwkEx(HERE,
+            "Meta data alloc request denied with error: %d", rc);
+    }
 
-        metaBuf = *relIter;
-        LOG_NRM("Alloc meta data buf: size: 0x%08X, ID: 0x%06X",
-            metaBuf.size, metaBuf.ID);
-
-        mMetaReserved.insert(resIter, metaBuf);
-        mMetaReleased.erase(relIter);
-        return true;
-
-    } else {
-        // Search the ordered elements, need to find a unique ID
-        while (resIter != mMetaReserved.end()) {
-            if ((*resIter).ID == metaBuf.ID)
-                metaBuf.ID++;
-            else if ((*resIter).ID > metaBuf.ID)
-                break;
-            resIter++;
-        }
+    // Map that memory back to user space for RW access
+    metaBuf.buf = KernelAPI::mmap(metaBuf.size, metaBuf.ID,
+        KernelAPI::MMR_META);
+    if (metaBuf.buf == NULL) {
+        LOG_ERR("Unable to mmap contig memory to user space");
+        // Have to free the memory, not useful if we can't access it
+        if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_METABUF_DELETE,
+            metaBuf.ID)) < 0)
+            LOG_ERR("Meta data free request denied with error: %d", rc);
+        throw FrmwkEx(HERE);
+    }
 
-        // Is the found ID within dnvme's max allowed range?
-        if (metaBuf.ID < (1 << METADATA_UNIQUE_ID_BITS)) {
-            LOG_NRM("Alloc meta data buf: size: 0x%08X, ID: 0x%06X",
-                metaBuf.size, metaBuf.ID);
-
-            // Request dnvme to reserve us some contiguous memory
-            if ((rc = ioctl(mFd, NVME_IOCTL_METABUF_ALLOC, metaBuf.ID)) < 0) {
-                throw FrmwkEx(HERE,
-                    "Meta data alloc request denied with error: %d", rc);
-            }
-
-            // Map that memory back to user space for RW access
-            metaBuf.buf = KernelAPI::mmap(metaBuf.size, metaBuf.ID,
-                KernelAPI::MMR_META);
-            if (metaBuf.buf == NULL) {
-                LOG_ERR("Unable to mmap contig memory to user space");
-                // Have to free the memory, not useful if we can't access it
-                if ((rc =ioctl(mFd, NVME_IOCTL_METABUF_DELETE, metaBuf.ID)) < 0)
-                    LOG_ERR("Meta data free request denied with error: %d", rc);
-                throw FrmwkEx(HERE);
-            }
-
-            mMetaReserved.insert(resIter, metaBuf);
-            return true;
+    mMetaBufs.push_back(metaBuf);
+    mMetaReserved.push_back(false);
+    mMetaReleased.push_back(metaBuf.ID);
+    return true;
+}
+
+
+bool
+MetaRsrc::PreallocMetaBuf(uint32_t num)
+{
+    if (mMetaAllocSize == 0) {
+        LOG_ERR("Meta data alloc size has not been set");
+        return false;
+    }
+
+    LOG_NRM("Prealloc %d meta data bufs", num);
+    mMetaReleased.reserve(num);
+    while (mMetaReleased.size() < num) {
+        if (AllocMetaBuf() == false) {
+            LOG_ERR("Only %ld meta data bufs could be preallocated",
+                mMetaReleased.size());
+            return false;
         }
     }
-    return false;
+    return true;
 }
 
 
 void
 MetaRsrc::ReleaseMetaBuf(MetaDataBuf metaBuf)
 {
-    deque<MetaDataBuf>::iterator resIter = mMetaReserved.begin();
-
     // Are we trying to release a default constructed MetaDataBuf, or illegal 1
     if (metaBuf == MetaDataBuf())
         return;
 
-    // Search the ordered elements
-    while (resIter != mMetaReserved.end()) {
-        if ((*resIter).ID == metaBuf.ID) {
-            mMetaReleased.push_back(*resIter);
-            mMetaReserved.erase(resIter);
-            break;
-        }
-        resIter++;
+    // The ID may have been freed en masse by a ctrlr disable since reserved
+    if ((metaBuf.ID >= mMetaBufs.size()) || (mMetaReserved[metaBuf.ID] == false)
+        || (mMetaBufs[metaBuf.ID] != metaBuf)) {
+        return;
     }
+
+    mMetaReserved[metaBuf.ID] = false;
+    mMetaReleased.push_back(metaBuf.ID);
 }
 
 
 void
 MetaRsrc::FreeAllMetaBuf()
 {
-    deque<MetaDataBuf>::iterator resIter = mMetaReserved.begin();
-
-    // Search the ordered elements, moves every reserved item into released
-    while (resIter != mMetaReserved.end()) {
-        ReleaseMetaBuf(*resIter);
-        resIter = mMetaReserved.begin();
-    }
-
-    // Now we have to free all the elements in the released list
-    while (mMetaReleased.size()) {
-        MetaDataBuf tmp = mMetaReleased.back();
-        mMetaReleased.pop_back();
+    // Every reserved and released ID is freed alike
+    for (size_t i = 0; i < mMetaBufs.size(); i++) {
+        MetaDataBuf &tmp = mMetaBufs[i];
 
         // Undo all which was done to create/reserve kernel meta data buffers
         KernelAPI::munmap(tmp.buf, tmp.size);
@@ -179,11 +175,11 @@ MetaRsrc::FreeAllMetaBuf()
         // been deleted by a prior NVME_IOCTL_DEVICE_STATE call to dnvme. The
         // act of not freeing causes memory leak, the act of freeing to many
         // times is of no harm.
-        ioctl(mFd, NVME_IOCTL_METABUF_DELETE, tmp.ID);
+        KernelAPI::ioctl(mFd, NVME_IOCTL_METABUF_DELETE, tmp.ID);
     }
 
+    mMetaBufs.clear();
+    mMetaReserved.clear();
+    mMetaReleased.clear();
     mMetaAllocSize = 0;
-
-    if ((mMetaReserved.empty() == false) || (mMetaReleased.empty() == false))
-        throw FrmwkEx(HERE, "Internal program error: meta list not empty");
 }
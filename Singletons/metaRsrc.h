@@ -17,7 +17,7 @@
 #ifndef _METARSRC_H_
 #define _METARSRC_H_
 
-#include <deque>
+#include <vector>
 #include "tnvme.h"
 
 #define METADATA_UNIQUE_ID_BITS         18      // 18 bits to rep a unique ID
@@ -57,6 +57,13 @@ struct MetaDataBuf {
 * memory to it. Remember to release previously reserved ID's/buffers because
 * they are limited in number.
 *
+* ID's are handed out densely from 0 and are only ever returned to dnvme all
+* at once, thus mMetaBufs[ID] describes the mapped buffer of every ID below
+* mMetaBufs.size(), and the next new ID is always mMetaBufs.size(). Among those
+* ID's, mMetaReserved marks the reserved ones and mMetaReleased stacks the
+* rest, making both reserving and releasing constant time regardless of how
+* many are in use.
+*
 * Allocations occur in the kernel and the kernel always enforces DWORD
 * alignment. There is nothing to be gained by testing non properly aligned meta
 * data buffers, but it will most certainly cause tnvme to eg fault or core dump.
@@ -99,6 +106,16 @@ public:
     bool ReserveMetaBuf(MetaDataBuf &metaBuf);
     void ReleaseMetaBuf(MetaDataBuf metaBuf);
 
+    /**
+     * Allocate and map meta data buffers ahead of time so that subsequent
+     * calls to ReserveMetaBuf() need not call into dnvme, e.g. before
+     * building a queue depth's worth of cmds which use meta data. The meta
+     * data alloc size must have already been set.
+     * @param num Pass the number of unreserved buffers which should exist
+     * @return true when that many are ready for reservation, otherwise false
+     */
+    bool PreallocMetaBuf(uint32_t num);
+
 
 protected:
     /// Releases all kernel meta data memory back to the system
@@ -114,10 +131,19 @@ private:
     /// Stores the size of each meta data allocation
     uint32_t mMetaAllocSize;
 
-    /// Track all outstanding/reserved meta data unique IDs
-    deque<MetaDataBuf> mMetaReserved;
+    /// Every buffer allocated from dnvme, indexed by its unique ID
+    vector<MetaDataBuf> mMetaBufs;
+    /// Bitmap indexed by unique ID, set while that ID is reserved
+    vector<bool> mMetaReserved;
     /// Previously reserved, but no longer in use, can be easily reserved again
-    deque<MetaDataBuf> mMetaReleased;
+    vector<uint32_t> mMetaReleased;
+
+    /**
+     * Request dnvme to allocate the next unique ID's buffer and map it to user
+     * space, leaving it unreserved.
+     * @return true upon success, false when all ID's have been allocated
+     */
+    bool AllocMetaBuf();
 };
 
 
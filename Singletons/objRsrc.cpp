@@ -70,6 +70,7 @@ typedef pair<string, SharedTrackablePtr> TrackablePair;
 ObjRsrc::ObjRsrc()
 {
     mFd = 0;
+    mObjByType.resize(Trackable::OBJTYPE_FENCE);
 }
 
 
@@ -78,6 +79,8 @@ ObjRsrc::ObjRsrc(int fd)
     mFd = fd;
     if (mFd < 0)
         throw FrmwkEx("Object created with a bad FD=%d", fd);
+
+    mObjByType.resize(Trackable::OBJTYPE_FENCE);
 }
 
 
@@ -153,8 +156,9 @@ ObjRsrc::AllocObj(Trackable::ObjType type, string lookupName)
             lookupName.c_str());
         return Trackable::NullTrackablePtr;
     }
+    mObjByType[newObj->GetObjType()].insert(lookupName);
 
-    return GetObj(lookupName);
+    return newObj;
 }
 
 
@@ -185,6 +189,8 @@ ObjRsrc::FreeAllObj()
      */
     LOG_NRM("Group level resources are being freed: %ld", mObjGrpLife.size());
     mObjGrpLife.clear();
+    for (size_t i = 0; i < mObjByType.size(); i++)
+        mObjByType[i].clear();
 }
 
 
@@ -199,18 +205,25 @@ ObjRsrc::FreeAllObjNotASQACQ()
      * objects on behalf of tests and all test objects within a group are
      * deleted after they complete, thus removing localized share_ptr's.
      */
-    TrackableMap::iterator item;
     size_t numB4 = mObjGrpLife.size();
 
-    item = mObjGrpLife.begin();
-    while (item != mObjGrpLife.end()) {
-        SharedTrackablePtr tPtr = (*item).second;
-        Trackable::ObjType obj = tPtr->GetObjType();
-        if ((obj != Trackable::OBJ_ACQ) && (obj != Trackable::OBJ_ASQ))
-            mObjGrpLife.erase(item);
-        item++;
+    for (int type = 0; type < Trackable::OBJTYPE_FENCE; type++) {
+        if ((type != Trackable::OBJ_ACQ) && (type != Trackable::OBJ_ASQ))
+            FreeAllObj((Trackable::ObjType)type);
     }
     LOG_NRM("Group level resources are being freed: %ld",
         (numB4 - mObjGrpLife.size()));
     LOG_NRM("Group level resources remaining: %ld", mObjGrpLife.size());
 }
+
+
+void
+ObjRsrc::FreeAllObj(Trackable::ObjType type)
+{
+    // Only the objects of the requested type are visited, not every object
+    LookupNameSet &names = mObjByType[type];
+    LookupNameSet::iterator name;
+    for (name = names.begin(); name != names.end(); name++)
+        mObjGrpLife.erase(*name);
+    names.clear();
+}
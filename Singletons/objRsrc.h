@@ -17,14 +17,20 @@
 #ifndef _OBJRSRC_H_
 #define _OBJRSRC_H_
 
-#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include "trackable.h"
 #include "tnvme.h"
 
 
 /**
-* This base class will handle object resources.
+* This base class will handle object resources. Objects are hashed by their
+* lookup name and additionally indexed by their Trackable::ObjType, so that
+* tests which allocate many thousands of objects, e.g. 1 per IOQ, neither pay
+* for ordered lookups nor for scans of every object when a subset of types is
+* freed upon ctrlr state transitions.
 */
 class ObjRsrc
 {
@@ -65,6 +71,12 @@ protected:
     /// Free all objects which were allocated, except ACQ/ASQ
     void FreeAllObjNotASQACQ();
 
+    /**
+     * Free all objects which were allocated of a single type.
+     * @param type Pass the type of object to free
+     */
+    void FreeAllObj(Trackable::ObjType type);
+
 
 private:
     // Implement singleton design pattern
@@ -74,9 +86,13 @@ private:
     int mFd;
 
     /// Storehouse for Group:: lifetime objects
-    typedef map<string, SharedTrackablePtr> TrackableMap;
+    typedef unordered_map<string, SharedTrackablePtr> TrackableMap;
     TrackableMap mObjGrpLife;
 
+    /// The lookup names within mObjGrpLife, indexed by Trackable::ObjType
+    typedef unordered_set<string> LookupNameSet;
+    vector<LookupNameSet> mObjByType;
+
     /**
      * Perform all the underlying allocation tasks for this class.
      * @param type Pass the type of default object to allocate/construct
@@ -16,6 +16,7 @@
 
 #include "registers.h"
 #include "tnvme.h"
+#include "../Utils/kernelAPI.h"
 #include "../Exception/frmwkEx.h"
 
 
@@ -116,7 +117,8 @@ Registers::Read(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     } else if (rsize > MAX_SUPPORTED_REG_SIZE) {
         LOG_ERR("Size of %s is larger than supplied buffer", rdesc);
         return false;
-    } else if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+    } else if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io,
+        io.nBytes)) < 0) {
         LOG_ERR("Error reading %s: %d returned", rdesc, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
@@ -147,7 +149,8 @@ Registers::Read(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     case 8: io.acc_type = QUAD_LEN;         break;
     }
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io,
+        io.nBytes)) < 0) {
         LOG_ERR("Error reading reg offset 0x%08X: %d returned", roffset, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
@@ -170,7 +173,8 @@ Registers::Read(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     int rc;
     struct rw_generic io = { regSpc, roffset, rsize, racc, value };
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io,
+        io.nBytes)) < 0) {
         LOG_ERR("Error reading reg offset 0x%08X: %d returned", roffset, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
@@ -234,7 +238,8 @@ Registers::Write(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     } else if (rsize > MAX_SUPPORTED_REG_SIZE) {
         LOG_ERR("Size of %s is larger than supplied buffer", rdesc);
         return false;
-    } else if ((rc = ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
+    } else if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io,
+        io.nBytes)) < 0) {
         LOG_ERR("Error writing %s: %d returned", rdesc, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
@@ -265,7 +270,8 @@ Registers::Write(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     case 8: io.acc_type = QUAD_LEN;         break;
     }
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io,
+        io.nBytes)) < 0) {
         LOG_ERR("Error writing reg offset 0x%08X: %d returned", roffset, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
@@ -288,7 +294,8 @@ Registers::Write(nvme_io_space regSpc, uint16_t rsize, uint16_t roffset,
     int rc;
     struct rw_generic io = { regSpc, roffset, rsize, racc, value };
 
-    if ((rc = ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io)) < 0) {
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_WRITE_GENERIC, &io,
+        io.nBytes)) < 0) {
         LOG_ERR("Error writing reg offset 0x%08X: %d returned", roffset, rc);
         LOG_ERR("io.{type,offset,nBytes,acc_type,buffer} = "
             "{%d, 0x%04X, 0x%04X, 0x%04X, %p}",
@@ -416,7 +423,8 @@ Registers::DiscoverPciCapabilities()
     // becomes 0, then that is the capabilities among many.
     while (REGMASK((nextCap >> 8), 1)) {
         io.offset = (uint16_t)REGMASK((nextCap >> 8), 1);
-        if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+        if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io,
+        io.nBytes)) < 0) {
             LOG_ERR("Error reading offset 0x%08X from PCI space: %d returned",
                 io.offset, rc);
             return;
@@ -476,7 +484,8 @@ Registers::DiscoverPciCapabilities()
     // Only one of these is possible, i.e. the AERCAP capabilities.
     io.offset = 0x100;
     io.nBytes = 4;
-    if ((rc = ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io)) < 0) {
+    if ((rc = KernelAPI::ioctl(mFd, NVME_IOCTL_READ_GENERIC, &io,
+        io.nBytes)) < 0) {
         LOG_ERR("Error reading offset 0x%08X from PCI space: %d returned",
             io.offset, rc);
         return;
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "binDump.h"
+#include "flightRec.h"
+#include "dumpArchive.h"
+#include "buffers.h"
+#include "../Queues/cq.h"
+#include "../Cmds/identify.h"
+#include "../Cmds/getLogPage.h"
+#include "../Exception/frmwkEx.h"
+
+#define FILENAME_FLAGS         (O_WRONLY | O_APPEND | O_CREAT)
+#define FILENAME_MODE          (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH)
+
+bool BinDump::mEnabled = false;
+
+
+BinDump::BinDump()
+{
+}
+
+
+BinDump::~BinDump()
+{
+}
+
+
+bool
+BinDump::IsFramed()
+{
+    return (mEnabled || FlightRec::IsRecording() || DumpArchive::IsOpen());
+}
+
+
+void
+BinDump::Write(DumpFilename filename, BinDumpObj obj, uint16_t qId,
+    uint32_t param, const uint8_t *buf, uint32_t length, string label)
+{
+    struct BinDumpHdr hdr;
+    struct timespec now;
+
+    if (label.length() > UINT16_MAX)
+        label.resize(UINT16_MAX);
+
+    memcpy(hdr.magic, BINDUMP_MAGIC, sizeof(hdr.magic));
+    hdr.version = BINDUMP_VERSION;
+    hdr.obj = obj;
+    hdr.qId = qId;
+    hdr.labelLen = label.length();
+    hdr.param = param;
+    hdr.length = (buf == NULL) ? 0 : length;
+    clock_gettime(CLOCK_REALTIME, &now);
+    hdr.timestamp_ns = ((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+
+    if (FlightRec::IsRecording())
+        FlightRec::Capture(filename, hdr, label, buf);
+    else
+        WriteFrame(filename, hdr, label, buf);
+}
+
+
+void
+BinDump::WriteFrame(DumpFilename filename, const BinDumpHdr &hdr,
+    const string &label, const uint8_t *payload)
+{
+    struct iovec iov[3];
+    ssize_t total;
+    int fd;
+
+    iov[0].iov_base = (void *)&hdr;
+    iov[0].iov_len = sizeof(hdr);
+    iov[1].iov_base = (void *)label.data();
+    iov[1].iov_len = hdr.labelLen;
+    iov[2].iov_base = (void *)payload;
+    iov[2].iov_len = hdr.length;
+    total = (iov[0].iov_len + iov[1].iov_len + iov[2].iov_len);
+
+    LOG_NRM("Dumping to filename: %s", filename.c_str());
+    if (DumpArchive::IsOpen()) {
+        DumpArchive::Append(filename, hdr, label, payload);
+        return;
+    }
+    if ((fd = open(filename.c_str(), FILENAME_FLAGS, FILENAME_MODE)) < 0)
+        throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
+    if (writev(fd, iov, 3) != total) {
+        close(fd);
+        throw FrmwkEx(HERE, "Failed to write file: %s", filename.c_str());
+    }
+    close(fd);
+}
+
+
+bool
+BinDump::Parse(const uint8_t *data, size_t size, size_t &pos,
+    BinDumpHdr &hdr, string &label, const uint8_t *&payload)
+{
+    if ((size - pos) < sizeof(hdr))
+        return false;
+    memcpy(&hdr, (data + pos), sizeof(hdr));
+
+    if (memcmp(hdr.magic, BINDUMP_MAGIC, sizeof(hdr.magic)) ||
+        (hdr.version != BINDUMP_VERSION) || (hdr.obj >= BINDUMP_FENCE)) {
+        return false;
+    } else if ((size - pos - sizeof(hdr)) <
+        ((size_t)hdr.labelLen + hdr.length)) {
+        return false;
+    }
+
+    label.assign((const char *)(data + pos + sizeof(hdr)), hdr.labelLen);
+    payload = (data + pos + sizeof(hdr) + hdr.labelLen);
+    pos += (sizeof(hdr) + hdr.labelLen + hdr.length);
+    return true;
+}
+
+
+void
+BinDump::Render(FILE *fp, string filename, const BinDumpHdr &hdr,
+    const string &label, const uint8_t *payload)
+{
+    switch (hdr.obj) {
+    case BINDUMP_BUF:
+    case BINDUMP_QUEUE:
+    case BINDUMP_CQ:
+        fprintf(fp, "%s\n", label.c_str());
+        if (((hdr.obj == BINDUMP_BUF) && hdr.param) || (hdr.length == 0))
+            fprintf(fp, "0x00000000: BUFFER IS EMPTY\n");
+        else
+            Buffers::Dump(fp, payload, hdr.length);
+
+        if ((hdr.obj == BINDUMP_CQ) && hdr.param) {
+            CQ::DumpDecoded(fp, payload, (hdr.length / hdr.param),
+                hdr.param);
+        }
+        break;
+
+    case BINDUMP_CMD:
+        fprintf(fp, "This file: %s\n", filename.c_str());
+        fprintf(fp, "%s\n\n", label.c_str());
+        fprintf(fp, "Cmd contents:\n");
+        Buffers::Dump(fp, payload, hdr.length);
+        break;
+
+    case BINDUMP_IDENTIFY:
+        // The decoders throw upon truncated payloads, they can't be decoded
+        if (hdr.length < Identify::IDEAL_DATA_SIZE) {
+            fprintf(fp, "\nUnable to decode truncated identify payload\n");
+            break;
+        }
+        Identify::DumpDecoded(fp, payload, hdr.length, hdr.param);
+        break;
+
+    case BINDUMP_LOGPAGE:
+        if (((hdr.param == GetLogPage::LOGID_ERROR_INFO) &&
+            (hdr.length < GetLogPage::ERRINFO_DATA_SIZE)) ||
+            ((hdr.param == GetLogPage::LOGID_SMART_HEALTH) &&
+            (hdr.length < GetLogPage::SMART_DATA_SIZE)) ||
+            ((hdr.param == GetLogPage::LOGID_FW_SLOT) &&
+            (hdr.length < GetLogPage::FIRMSLOT_DATA_SIZE))) {
+            fprintf(fp, "\nUnable to decode truncated log page payload\n");
+            break;
+        }
+        GetLogPage::DumpDecoded(fp, payload, hdr.length, hdr.param);
+        break;
+
+    case BINDUMP_TEXT:
+        fprintf(fp, "%s\n", label.c_str());
+        fwrite(payload, 1, hdr.length, fp);
+        break;
+
+    default:
+        fprintf(fp, "Unknown binary dump object type: %d\n", hdr.obj);
+        break;
+    }
+}
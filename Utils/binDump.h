@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _BINDUMP_H_
+#define _BINDUMP_H_
+
+#include "tnvme.h"
+#include "fileSystem.h"
+
+#define BINDUMP_MAGIC           "TNVMEDMP"
+#define BINDUMP_VERSION         1
+
+/**
+ * Identifies how the tnvme-dump decoder is to render a frame's payload, and
+ * thus the meaning of BinDumpHdr::param.
+ */
+typedef enum {
+    BINDUMP_BUF,            // Hex as Buffers::Dump(); param=1 for empty buf
+    BINDUMP_QUEUE,          // Hex as Queue::Dump(); param=entry size
+    BINDUMP_CQ,             // Hex and CE decoding as CQ::Dump(); param=ditto
+    BINDUMP_CMD,            // Hex of the cmd bytes as Cmd::Dump()
+    BINDUMP_IDENTIFY,       // Decoding of an identify payload; param=CNS
+    BINDUMP_LOGPAGE,        // Decoding of a log page payload; param=LID
+    BINDUMP_TEXT,           // Text already rendered, e.g. Latency::Dump()
+    BINDUMP_FENCE           // always must be last element
+} BinDumpObj;
+
+/// Precedes the label and the payload of every frame within a binary dump
+struct BinDumpHdr {
+    char     magic[8];      // BINDUMP_MAGIC, not NULL terminated
+    uint16_t version;       // BINDUMP_VERSION
+    uint16_t obj;           // BinDumpObj
+    uint16_t qId;           // Queue ID of BINDUMP_QUEUE/BINDUMP_CQ, else 0
+    uint16_t labelLen;      // Bytes of label text following this hdr
+    uint32_t param;         // Meaning depends upon obj
+    uint32_t length;        // Bytes of payload following the label
+    uint64_t timestamp_ns;  // CLOCK_REALTIME at which the frame was written
+} __attribute__((packed));
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. When enabled, the Dump() methods throughout the framework
+* do not render their objects as text. They instead append a single frame per
+* object to the very same dump file, consisting of a BinDumpHdr, the label
+* text which would otherwise have been written, and the raw bytes of the
+* object, all with a single writev(). The tnvme-dump tool renders such files
+* back into the text which would otherwise have been written.
+*
+* While the flight recorder is recording, see class FlightRec, the frames are
+* handed to it instead of being written, and it decides whether they ever
+* reach the dump files; as frames or as the text rendered by Render().
+*
+* @note This class may throw exceptions.
+*/
+class BinDump
+{
+public:
+    BinDump();
+    virtual ~BinDump();
+
+    static void SetEnabled(bool enabled) { mEnabled = enabled; }
+    static bool IsEnabled() { return mEnabled; }
+
+    /**
+     * Dump() methods must hand their objects to Write() rather than render
+     * text whenever this returns true.
+     * @return true if binary dumps are enabled, the flight recorder is
+     *      recording or a dump archive is open, otherwise false.
+     */
+    static bool IsFramed();
+
+    /**
+     * Append a single frame to a dump file, or to the flight recorder.
+     * @param filename Pass the filename as generated by macro
+     *      FileSystem::PrepDumpFile().
+     * @param obj Pass the type of object being dumped
+     * @param qId Pass the queue ID of a queue being dumped, otherwise 0
+     * @param param Pass the value required by obj, see BinDumpHdr
+     * @param buf Pass the raw bytes of the object
+     * @param length Pass the number of bytes within buf
+     * @param label Pass the header text which accompanies the object
+     */
+    static void Write(DumpFilename filename, BinDumpObj obj, uint16_t qId,
+        uint32_t param, const uint8_t *buf, uint32_t length, string label);
+
+    /**
+     * Append an already constructed frame to a dump file, or to the dump
+     * archive when one is open, see class DumpArchive.
+     * @param filename Pass the filename as generated by macro
+     *      FileSystem::PrepDumpFile().
+     * @param hdr Pass the frame's header
+     * @param label Pass the frame's label text, of hdr.labelLen bytes
+     * @param payload Pass the frame's raw bytes, of hdr.length bytes
+     */
+    static void WriteFrame(DumpFilename filename, const BinDumpHdr &hdr,
+        const string &label, const uint8_t *payload);
+
+    /**
+     * Render a single frame as the text the framework would have written.
+     * @param fp Pass the file to write
+     * @param filename Pass the name of the dump file being rendered
+     * @param hdr Pass the frame's header
+     * @param label Pass the frame's label text
+     * @param payload Pass the frame's raw bytes
+     */
+    static void Render(FILE *fp, string filename, const BinDumpHdr &hdr,
+        const string &label, const uint8_t *payload);
+
+    /**
+     * Locate the next frame within the contents of a binary dump file.
+     * @param data Pass the entire contents of the file
+     * @param size Pass the number of bytes within data
+     * @param pos Pass the offset of the frame, returns that of the next one
+     * @param hdr Returns the frame's header
+     * @param label Returns the frame's label text
+     * @param payload Returns a pointer to the frame's raw bytes within data
+     * @return true if a valid frame was found, false upon the end of data or
+     *      upon a malformed frame, where pos != size indicates the latter.
+     */
+    static bool Parse(const uint8_t *data, size_t size, size_t &pos,
+        BinDumpHdr &hdr, string &label, const uint8_t *&payload);
+
+
+private:
+    static bool mEnabled;
+};
+
+
+#endif
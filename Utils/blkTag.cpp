@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include "blkTag.h"
+
+
+BlkTag::BlkTag()
+{
+}
+
+
+BlkTag::~BlkTag()
+{
+}
+
+
+/// The state of a xoshiro256** PRNG
+struct Xoshiro {
+    uint64_t s[4];
+};
+
+
+static inline uint64_t
+Rotl(uint64_t x, int k)
+{
+    return ((x << k) | (x >> (64 - k)));
+}
+
+
+/// One step of splitmix64, used to expand a seed into the PRNG state
+static inline uint64_t
+SplitMix64(uint64_t &x)
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = ((z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL);
+    z = ((z ^ (z >> 27)) * 0x94d049bb133111ebULL);
+    return (z ^ (z >> 31));
+}
+
+
+static inline uint64_t
+Next(Xoshiro &rng)
+{
+    uint64_t result = (Rotl(rng.s[1] * 5, 7) * 9);
+    uint64_t t = (rng.s[1] << 17);
+
+    rng.s[2] ^= rng.s[0];
+    rng.s[3] ^= rng.s[1];
+    rng.s[1] ^= rng.s[2];
+    rng.s[0] ^= rng.s[3];
+    rng.s[2] ^= t;
+    rng.s[3] = Rotl(rng.s[3], 45);
+    return result;
+}
+
+
+/// Every block's body is a unique stream seeded from all fields of its tag
+static void
+SeedBody(const BlkTagHdr &hdr, Xoshiro &rng)
+{
+    uint64_t x = (hdr.seed ^ (hdr.lba * 0xd1342543de82ef95ULL) ^
+        (((uint64_t)hdr.nsid << 32) | hdr.generation));
+    for (int i = 0; i < 4; i++)
+        rng.s[i] = SplitMix64(x);
+}
+
+
+static void
+MakeHdr(const BlkTagParams &params, uint32_t blk, BlkTagHdr &hdr)
+{
+    hdr.magic = BLKTAG_MAGIC;
+    hdr.lba = (params.slba + blk);
+    hdr.nsid = params.nsid;
+    hdr.generation = params.generation;
+    hdr.seed = params.seed;
+}
+
+
+static bool
+SupportedSize(uint32_t lbaDataSize)
+{
+    if ((lbaDataSize < sizeof(BlkTagHdr)) ||
+        (lbaDataSize % sizeof(uint64_t))) {
+
+        LOG_ERR("LBA data size %d is not supported by tagged blocks",
+            lbaDataSize);
+        return false;
+    }
+    return true;
+}
+
+
+bool
+BlkTag::Fill(const BlkTagParams &params, uint8_t *buf, uint32_t numBlks)
+{
+    if (SupportedSize(params.lbaDataSize) == false)
+        return false;
+
+    for (uint32_t blk = 0; blk < numBlks; blk++) {
+        BlkTagHdr hdr;
+        Xoshiro rng;
+
+        MakeHdr(params, blk, hdr);
+        memcpy(buf, &hdr, sizeof(hdr));
+        SeedBody(hdr, rng);
+        for (uint32_t i = sizeof(hdr); i < params.lbaDataSize;
+            i += sizeof(uint64_t)) {
+
+            uint64_t val = Next(rng);
+            memcpy(buf + i, &val, sizeof(val));
+        }
+        buf += params.lbaDataSize;
+    }
+    return true;
+}
+
+
+/**
+ * Classify a single block.
+ * @param params Pass what is expected of the series
+ * @param blk Pass the index of the block within the series
+ * @param buf Pass the start of the block
+ * @param bad Returns the details when the block doesn't verify
+ * @return The status of the block
+ */
+static BlkTagStatus
+VerifyBlk(const BlkTagParams &params, uint32_t blk, const uint8_t *buf,
+    BlkTagBad &bad)
+{
+    BlkTagHdr expected;
+    Xoshiro rng;
+
+    MakeHdr(params, blk, expected);
+    memcpy(&bad.found, buf, sizeof(bad.found));
+    bad.blk = blk;
+    bad.bodyOffset = 0;
+
+    if (bad.found.magic != BLKTAG_MAGIC)
+        return BLKTAG_UNTAGGED;
+    if ((bad.found.nsid != expected.nsid) || (bad.found.lba != expected.lba))
+        return BLKTAG_MISDIRECTED;
+    if ((bad.found.generation != expected.generation) ||
+        (bad.found.seed != expected.seed)) {
+        return BLKTAG_STALE;
+    }
+
+    SeedBody(expected, rng);
+    for (uint32_t i = sizeof(expected); i < params.lbaDataSize;
+        i += sizeof(uint64_t)) {
+
+        uint64_t val = Next(rng);
+        if (memcmp(buf + i, &val, sizeof(val)) != 0) {
+            bad.bodyOffset = i;
+            return BLKTAG_TORN;
+        }
+    }
+    return BLKTAG_OK;
+}
+
+
+bool
+BlkTag::Verify(const BlkTagParams &params, const uint8_t *buf,
+    uint32_t numBlks, BlkTagResult &result)
+{
+    result.numBlks = 0;
+    result.numBad = 0;
+    memset(result.count, 0, sizeof(result.count));
+    result.bad.clear();
+
+    if (SupportedSize(params.lbaDataSize) == false)
+        return false;
+    result.numBlks = numBlks;
+
+    for (uint32_t blk = 0; blk < numBlks; blk++) {
+        BlkTagBad bad;
+        BlkTagStatus status = VerifyBlk(params, blk, buf, bad);
+
+        result.count[status]++;
+        if (status != BLKTAG_OK) {
+            bad.status = status;
+            if (result.numBad++ < BLKTAG_MAX_DETAILS)
+                result.bad.push_back(bad);
+        }
+        buf += params.lbaDataSize;
+    }
+    return (result.numBad == 0);
+}
+
+
+void
+BlkTag::Log(const BlkTagResult &result)
+{
+    if (result.numBad == 0) {
+        LOG_NRM("All %d tagged blocks verified", result.numBlks);
+        return;
+    }
+
+    LOG_ERR("%d of %d tagged blocks failed to verify:", result.numBad,
+        result.numBlks);
+    for (int i = (BLKTAG_OK + 1); i < BLKTAGSTATUS_FENCE; i++) {
+        if (result.count[i]) {
+            LOG_ERR("  %s: %d", GetStatusName((BlkTagStatus)i),
+                result.count[i]);
+        }
+    }
+    for (size_t i = 0; i < result.bad.size(); i++) {
+        const BlkTagBad &bad = result.bad[i];
+        if (bad.status == BLKTAG_UNTAGGED) {
+            LOG_ERR("  blk %d: %s", bad.blk, GetStatusName(bad.status));
+        } else {
+            LOG_ERR("  blk %d: %s; found NSID 0x%08X, LBA 0x%016lX, "
+                "generation %d, seed 0x%016lX, body offset 0x%04X", bad.blk,
+                GetStatusName(bad.status), bad.found.nsid, bad.found.lba,
+                bad.found.generation, bad.found.seed, bad.bodyOffset);
+        }
+    }
+    if (result.numBad > result.bad.size()) {
+        LOG_ERR("  %ld further bad block(s) not listed",
+            (result.numBad - result.bad.size()));
+    }
+}
+
+
+const char *
+BlkTag::GetStatusName(BlkTagStatus status)
+{
+    switch (status) {
+    case BLKTAG_OK:             return "ok";
+    case BLKTAG_UNTAGGED:       return "untagged";
+    case BLKTAG_MISDIRECTED:    return "misdirected";
+    case BLKTAG_STALE:          return "stale";
+    case BLKTAG_TORN:           return "torn";
+    default:                    return "unknown";
+    }
+}
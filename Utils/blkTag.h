@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _BLKTAG_H_
+#define _BLKTAG_H_
+
+#include "tnvme.h"
+
+/// Identifies a logical block stamped by BlkTag::Fill(), ASCII "TNVMETAG"
+#define BLKTAG_MAGIC                0x474154454d564e54ULL
+/// Only this many leading bad blocks are detailed, all are counted
+#define BLKTAG_MAX_DETAILS          32
+
+
+/// What is expected within a series of consecutive logical blocks
+struct BlkTagParams {
+    uint32_t nsid;
+    uint64_t slba;          // The LBA of the 1st block of the series
+    uint32_t lbaDataSize;   // Bytes per logical block, modulo 8, >= 32
+    uint32_t generation;    // Bump each time the same LBA's are rewritten
+    uint64_t seed;          // Seeds the PRNG body of every block
+};
+
+/// Stamped at the start of every logical block, the PRNG body follows
+struct BlkTagHdr {
+    uint64_t magic;
+    uint64_t lba;
+    uint32_t nsid;
+    uint32_t generation;
+    uint64_t seed;
+} __attribute__((__packed__));
+
+typedef enum {
+    BLKTAG_OK,
+    BLKTAG_UNTAGGED,        // No tag, never written or overwritten by others
+    BLKTAG_MISDIRECTED,     // Tagged for a different NSID/LBA
+    BLKTAG_STALE,           // Right NSID/LBA, but another generation/seed
+    BLKTAG_TORN,            // Right tag, but the body is not what was written
+    BLKTAGSTATUS_FENCE      // always must be last element
+} BlkTagStatus;
+
+/// The details of a block which did not verify
+struct BlkTagBad {
+    uint32_t blk;           // Index of the block within the series
+    BlkTagStatus status;
+    BlkTagHdr found;        // The tag which was read back
+    uint32_t bodyOffset;    // BLKTAG_TORN: offset of 1st miscompare in blk
+};
+
+/// The outcome of verifying a series of logical blocks
+struct BlkTagResult {
+    uint32_t numBlks;
+    uint32_t numBad;
+    uint32_t count[BLKTAGSTATUS_FENCE];
+    vector<BlkTagBad> bad;  // The 1st BLKTAG_MAX_DETAILS bad blocks
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It writes and verifies self describing logical blocks.
+* Each block starts with a BlkTagHdr naming its NSID, LBA, write generation
+* and seed, followed by a body from a xoshiro256** PRNG which is seeded from
+* that tag. Upon readback a block which landed at the wrong LBA, which was
+* never updated, or which was only partially written is identified by
+* itself, without retaining a copy of the written data.
+*
+* @note This class will not throw exceptions.
+*/
+class BlkTag
+{
+public:
+    BlkTag();
+    virtual ~BlkTag();
+
+    /**
+     * Stamp a series of consecutive logical blocks.
+     * @param params Pass what to stamp, params.slba is for the 1st block
+     * @param buf Pass the buffer to fill
+     * @param numBlks Pass the number of blocks within buf
+     * @return false if params.lbaDataSize is unsupported, otherwise true
+     */
+    static bool Fill(const BlkTagParams &params, uint8_t *buf,
+        uint32_t numBlks);
+
+    /**
+     * Verify a series of consecutive logical blocks were stamped by Fill()
+     * given the same params.
+     * @param params Pass what is expected
+     * @param buf Pass the buffer to verify
+     * @param numBlks Pass the number of blocks within buf
+     * @param result Returns the details of every block which didn't verify,
+     *        result.numBlks is 0 if params.lbaDataSize is unsupported
+     * @return true when every block verified, otherwise false
+     */
+    static bool Verify(const BlkTagParams &params, const uint8_t *buf,
+        uint32_t numBlks, BlkTagResult &result);
+
+    /**
+     * Send the details of a failed verify to the logging endpoint.
+     * @param result Pass the result of a prior call to Verify()
+     */
+    static void Log(const BlkTagResult &result);
+
+    static const char *GetStatusName(BlkTagStatus status);
+};
+
+
+#endif
@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "bufCompare.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BUFCMP_X86
+#endif
+
+
+BufCompare::BufCompare()
+{
+}
+
+
+BufCompare::~BufCompare()
+{
+}
+
+
+/// The state of a comparison which may span many calls to the compare impls
+struct CompareState {
+    Miscompare *result;
+    uint32_t total;         // Total bytes being compared
+    uint32_t base;          // Offset of the current chunk within the total
+    uint64_t lastGranule;   // The granule of the previous miscompare
+};
+
+
+/**
+ * Account for 1 miscomparing byte. Offsets must be noted in ascending order.
+ * @param state Pass the state of the comparison
+ * @param offset Pass the offset of the miscomparing byte within the chunk
+ */
+static void
+NoteMiscompare(CompareState &state, uint32_t offset)
+{
+    Miscompare &result = *state.result;
+    offset += state.base;
+    uint64_t granule = (offset / result.granule);
+
+    if (result.numBytes++ == 0)
+        result.firstOffset = offset;
+    if ((result.numRanges != 0) && (granule == state.lastGranule))
+        return;
+
+    uint32_t start = (granule * result.granule);
+    uint32_t size = MIN(result.granule, (state.total - start));
+    if ((result.numRanges != 0) && (granule == (state.lastGranule + 1))) {
+        // The run continues, extend it only if it was recorded
+        if (result.numRanges <= MISCOMPARE_MAX_RANGES)
+            result.ranges.back().length += size;
+    } else {
+        if (result.numRanges < MISCOMPARE_MAX_RANGES) {
+            MiscompareRange range = { start, size };
+            result.ranges.push_back(range);
+        }
+        result.numRanges++;
+    }
+    state.lastGranule = granule;
+}
+
+
+/// The reference implementation
+static void
+CompareScalar(const uint8_t *buf1, const uint8_t *buf2, uint32_t offset,
+    uint32_t length, CompareState &state)
+{
+    for (; offset < length; offset++) {
+        if (buf1[offset] != buf2[offset])
+            NoteMiscompare(state, offset);
+    }
+}
+
+
+#ifdef BUFCMP_X86
+/**
+ * The vector implementations compare a vector at a time, only those which
+ * differ are examined byte by byte. The remainder is finished by the scalar
+ * reference.
+ */
+__attribute__((target("sse2")))
+static void
+CompareSSE2(const uint8_t *buf1, const uint8_t *buf2, uint32_t length,
+    CompareState &state)
+{
+    const uint32_t SAME = 0xffff;
+    uint32_t offset;
+
+    for (offset = 0; (offset + sizeof(__m128i)) <= length;
+        offset += sizeof(__m128i)) {
+
+        __m128i vec1 = _mm_loadu_si128((const __m128i *)(buf1 + offset));
+        __m128i vec2 = _mm_loadu_si128((const __m128i *)(buf2 + offset));
+        uint32_t diff = (~_mm_movemask_epi8(_mm_cmpeq_epi8(vec1, vec2)) & SAME);
+        while (diff) {
+            NoteMiscompare(state, (offset + __builtin_ctz(diff)));
+            diff &= (diff - 1);
+        }
+    }
+    CompareScalar(buf1, buf2, offset, length, state);
+}
+
+
+__attribute__((target("avx2")))
+static void
+CompareAVX2(const uint8_t *buf1, const uint8_t *buf2, uint32_t length,
+    CompareState &state)
+{
+    uint32_t offset;
+
+    for (offset = 0; (offset + sizeof(__m256i)) <= length;
+        offset += sizeof(__m256i)) {
+
+        __m256i vec1 = _mm256_loadu_si256((const __m256i *)(buf1 + offset));
+        __m256i vec2 = _mm256_loadu_si256((const __m256i *)(buf2 + offset));
+        uint32_t diff = ~(uint32_t)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(vec1, vec2));
+        while (diff) {
+            NoteMiscompare(state, (offset + __builtin_ctz(diff)));
+            diff &= (diff - 1);
+        }
+    }
+    CompareScalar(buf1, buf2, offset, length, state);
+}
+#endif
+
+
+/**
+ * Compare the next chunk of a comparison.
+ * @param impl Pass the implementation to use
+ * @param buf1 Pass the start of the chunk within the 1st buffer
+ * @param buf2 Pass the start of the chunk within the 2nd buffer
+ * @param length Pass the number of bytes within the chunk
+ * @param state Pass the state of the comparison, state.base is the offset
+ *        of this chunk
+ */
+static void
+CompareChunk(PatternGen::Impl impl, const uint8_t *buf1, const uint8_t *buf2,
+    uint32_t length, CompareState &state)
+{
+    switch (impl) {
+#ifdef BUFCMP_X86
+    case PatternGen::IMPL_SSE2:
+        CompareSSE2(buf1, buf2, length, state);
+        break;
+    case PatternGen::IMPL_AVX2:
+        CompareAVX2(buf1, buf2, length, state);
+        break;
+#endif
+    default:
+    case PatternGen::IMPL_SCALAR:
+        CompareScalar(buf1, buf2, 0, length, state);
+        break;
+    }
+}
+
+
+/// Prepare result and state to begin a comparison of length bytes
+static void
+InitCompare(uint32_t length, uint32_t granule, Miscompare &result,
+    CompareState &state)
+{
+    result.granule = granule ? granule : MAX(length, 1);
+    result.firstOffset = 0;
+    result.numBytes = 0;
+    result.numRanges = 0;
+    result.ranges.clear();
+
+    state.result = &result;
+    state.total = length;
+    state.base = 0;
+    state.lastGranule = 0;
+}
+
+
+bool
+BufCompare::Compare(const uint8_t *buf1, const uint8_t *buf2,
+    uint32_t length, uint32_t granule, Miscompare &result)
+{
+    return Compare(PatternGen::GetImpl(), buf1, buf2, length, granule,
+        result);
+}
+
+
+bool
+BufCompare::Compare(PatternGen::Impl impl, const uint8_t *buf1,
+    const uint8_t *buf2, uint32_t length, uint32_t granule,
+    Miscompare &result)
+{
+    CompareState state;
+
+    InitCompare(length, granule, result, state);
+    CompareChunk(impl, buf1, buf2, length, state);
+    return (result.numBytes == 0);
+}
+
+
+bool
+BufCompare::Verify(DataPattern dataPat, uint64_t initVal, const uint8_t *buf,
+    uint32_t length, uint32_t granule, Miscompare &result)
+{
+    PatternGen::Impl impl = PatternGen::GetImpl();
+    uint8_t expected[BUFCMP_VERIFY_CHUNK];
+    uint32_t width;
+    CompareState state;
+
+    switch (dataPat) {
+    case DATAPAT_CONST_8BIT:
+    case DATAPAT_INC_8BIT:      width = sizeof(uint8_t);    break;
+    case DATAPAT_CONST_16BIT:
+    case DATAPAT_INC_16BIT:     width = sizeof(uint16_t);   break;
+    case DATAPAT_CONST_32BIT:
+    case DATAPAT_INC_32BIT:     width = sizeof(uint32_t);   break;
+    default:
+        LOG_ERR("Unsupported data pattern %d", dataPat);
+        return false;
+    }
+    bool increments = ((dataPat == DATAPAT_INC_8BIT) ||
+        (dataPat == DATAPAT_INC_16BIT) || (dataPat == DATAPAT_INC_32BIT));
+
+    // Trailing bytes which don't form a whole element were never written
+    length -= (length % width);
+    InitCompare(length, granule, result, state);
+    while (state.base < length) {
+        uint32_t chunk = MIN(BUFCMP_VERIFY_CHUNK, (length - state.base));
+        PatternGen::Fill(impl, dataPat, initVal, expected, chunk);
+        CompareChunk(impl, (buf + state.base), expected, chunk, state);
+        if (increments)
+            initVal += (chunk / width);
+        state.base += chunk;
+    }
+    return (result.numBytes == 0);
+}
+
+
+void
+BufCompare::Log(const Miscompare &result)
+{
+    if (result.numBytes == 0) {
+        LOG_NRM("Buffers compare identically");
+        return;
+    }
+
+    LOG_ERR("Detected data miscompare: %d byte(s) differ, 1st @ "
+        "offset 0x%08X", result.numBytes, result.firstOffset);
+    LOG_ERR("Miscompares span %d range(s) of 0x%X byte granules:",
+        result.numRanges, result.granule);
+    for (size_t i = 0; i < result.ranges.size(); i++) {
+        LOG_ERR("  offset 0x%08X, length 0x%08X", result.ranges[i].offset,
+            result.ranges[i].length);
+    }
+    if (result.numRanges > result.ranges.size()) {
+        LOG_ERR("  %ld further range(s) not listed",
+            (result.numRanges - result.ranges.size()));
+    }
+}
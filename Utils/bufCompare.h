@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _BUFCOMPARE_H_
+#define _BUFCOMPARE_H_
+
+#include "tnvme.h"
+#include "patternGen.h"
+
+/// Only this many leading miscompare ranges are recorded, all are counted
+#define MISCOMPARE_MAX_RANGES       32
+/// Verify() generates the expected pattern this many bytes at a time
+#define BUFCMP_VERIFY_CHUNK         4096
+
+
+/// A run of consecutive granules which each contain at least 1 miscompare
+struct MiscompareRange {
+    uint32_t offset;        // Byte offset of the 1st granule of the run
+    uint32_t length;        // Bytes spanned by all granules of the run
+};
+
+/// The outcome of comparing 2 buffers
+struct Miscompare {
+    uint32_t granule;       // Bytes per granule, e.g. the LBA data size
+    uint32_t firstOffset;   // Byte offset of the 1st miscompare
+    uint32_t numBytes;      // Total number of bytes which miscompare
+    uint32_t numRanges;     // Total runs, may exceed ranges.size()
+    vector<MiscompareRange> ranges;
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It compares buffers using the fastest implementation the
+* host CPU supports, see PatternGen::GetImpl(), and reports where they
+* differ rather than only whether they differ.
+*
+* @note This class will not throw exceptions.
+*/
+class BufCompare
+{
+public:
+    BufCompare();
+    virtual ~BufCompare();
+
+    /**
+     * Compare 2 buffers of equal length.
+     * @param buf1 Pass the 1st buffer
+     * @param buf2 Pass the 2nd buffer
+     * @param length Pass the number of bytes to compare
+     * @param granule Pass the bytes per granule into which miscompares are
+     *        grouped into ranges, i.e. the LBA data size. 0 implies the
+     *        entire length is a single granule.
+     * @param result Returns the details of where the buffers differ
+     * @return true when the buffers are identical, otherwise false
+     */
+    static bool Compare(const uint8_t *buf1, const uint8_t *buf2,
+        uint32_t length, uint32_t granule, Miscompare &result);
+
+    /**
+     * Same as above, but forcing a specific implementation.
+     * @param impl Pass the implementation, it must be supported
+     */
+    static bool Compare(PatternGen::Impl impl, const uint8_t *buf1,
+        const uint8_t *buf2, uint32_t length, uint32_t granule,
+        Miscompare &result);
+
+    /**
+     * Verify a buffer contains a data pattern/series, as would have been
+     * written by PatternGen::Fill(). The expected data is generated a small
+     * chunk at a time, so no reference buffer need be retained.
+     * @param dataPat Pass the data pattern/series which is expected
+     * @param initVal Pass the 1st value of the pattern/series
+     * @param buf Pass the start of the buffer to verify
+     * @param length Pass the number of bytes to verify
+     * @param granule Pass the bytes per granule, see Compare()
+     * @param result Returns the details of where the buffer differs
+     * @return true when the buffer contains the pattern, otherwise false
+     */
+    static bool Verify(DataPattern dataPat, uint64_t initVal,
+        const uint8_t *buf, uint32_t length, uint32_t granule,
+        Miscompare &result);
+
+    /**
+     * Send the details of a miscompare to the logging endpoint.
+     * @param result Pass the result of a prior call to Compare()
+     */
+    static void Log(const Miscompare &result);
+};
+
+
+#endif
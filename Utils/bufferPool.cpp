@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <mutex>
+#include <vector>
+#include "bufferPool.h"
+
+// MemBuffer's may be (re)initialized from IOWorker threads
+static std::mutex poolMutex;
+static vector<uint8_t *> freeLists[BUFPOOL_MAX_SHIFT + 1];
+static BufferPool::Stats poolStats;
+
+
+BufferPool::BufferPool()
+{
+}
+
+
+BufferPool::~BufferPool()
+{
+}
+
+
+/**
+ * Calculate the size class which can contain size bytes.
+ * @param size Pass the number of bytes required
+ * @return The log2 of the size class, > BUFPOOL_MAX_SHIFT when not pooled
+ */
+static uint32_t
+SizeClass(uint32_t size)
+{
+    uint32_t shift = __builtin_ctz(sysconf(_SC_PAGESIZE));
+    while (((uint64_t)1 << shift) < size)
+        shift++;
+    return shift;
+}
+
+
+uint8_t *
+BufferPool::Alloc(uint32_t &size)
+{
+    uint8_t *buf = NULL;
+    uint32_t shift = SizeClass(size);
+
+    if (shift <= BUFPOOL_MAX_SHIFT) {
+        size = (1 << shift);
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (freeLists[shift].size()) {
+            buf = freeLists[shift].back();
+            freeLists[shift].pop_back();
+            poolStats.pooledBytes -= size;
+            poolStats.hits++;
+            return buf;
+        }
+        poolStats.misses++;
+    } else {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        poolStats.misses++;
+    }
+
+    if (posix_memalign((void **)&buf, sysconf(_SC_PAGESIZE), size))
+        return NULL;
+    return buf;
+}
+
+
+void
+BufferPool::Free(uint8_t *buf, uint32_t size)
+{
+    if (buf == NULL)
+        return;
+
+    uint32_t shift = SizeClass(size);
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if ((shift <= BUFPOOL_MAX_SHIFT) && (size == ((uint32_t)1 << shift)) &&
+            ((poolStats.pooledBytes + size) <= BUFPOOL_MAX_POOLED_BYTES)) {
+
+            freeLists[shift].push_back(buf);
+            poolStats.pooledBytes += size;
+            poolStats.frees++;
+            return;
+        }
+        poolStats.drops++;
+    }
+    free(buf);
+}
+
+
+void
+BufferPool::Drain()
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    for (uint32_t i = 0; i <= BUFPOOL_MAX_SHIFT; i++) {
+        for (size_t j = 0; j < freeLists[i].size(); j++)
+            free(freeLists[i][j]);
+        freeLists[i].clear();
+    }
+    poolStats.pooledBytes = 0;
+}
+
+
+BufferPool::Stats
+BufferPool::GetStats()
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return poolStats;
+}
+
+
+void
+BufferPool::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    uint64_t pooledBytes = poolStats.pooledBytes;
+    memset(&poolStats, 0, sizeof(poolStats));
+    poolStats.pooledBytes = pooledBytes;
+}
+
+
+void
+BufferPool::LogStats()
+{
+    Stats stats = GetStats();
+    uint64_t allocs = (stats.hits + stats.misses);
+
+    LOG_NRM("Buffer pool: %ld allocs, %ld hits (%ld%%), %ld misses, "
+        "%ld frees, %ld drops, %ld bytes idle", allocs, stats.hits,
+        allocs ? ((stats.hits * 100) / allocs) : 0, stats.misses, stats.frees,
+        stats.drops, stats.pooledBytes);
+}
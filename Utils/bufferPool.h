@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _BUFFERPOOL_H_
+#define _BUFFERPOOL_H_
+
+#include "tnvme.h"
+
+/// Smallest size class is 1 page, largest is 2^BUFPOOL_MAX_SHIFT bytes
+#define BUFPOOL_MAX_SHIFT           26
+/// Free buffers beyond this many bytes are returned to the system
+#define BUFPOOL_MAX_POOLED_BYTES    (256 * 1024 * 1024)
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It pools page aligned heap memory by power of 2 size
+* classes so that tests which repeatedly (re)initialize MemBuffer's reuse
+* memory which is already faulted in, rather than paying for a
+* posix_memalign()/free() pair, and the page faults which follow, every time.
+*
+* @note This class will not throw exceptions.
+*/
+class BufferPool
+{
+public:
+    BufferPool();
+    virtual ~BufferPool();
+
+    struct Stats {
+        uint64_t hits;      // Allocs satisfied from a free list
+        uint64_t misses;    // Allocs which required posix_memalign()
+        uint64_t frees;     // Buffers returned into a free list
+        uint64_t drops;     // Buffers returned to the system via free()
+        uint64_t pooledBytes;   // Bytes currently idle within free lists
+    };
+
+    /**
+     * Allocate page aligned memory of at least the requested size.
+     * @param size Pass the number of bytes required, it is updated with the
+     *        number of bytes actually reserved which must be passed to Free()
+     * @return A page aligned pointer, or NULL upon allocation failure
+     */
+    static uint8_t *Alloc(uint32_t &size);
+
+    /**
+     * Return memory acquired from Alloc().
+     * @param buf Pass the pointer returned by Alloc()
+     * @param size Pass the size returned by Alloc()
+     */
+    static void Free(uint8_t *buf, uint32_t size);
+
+    /// Return all idle memory to the system
+    static void Drain();
+
+    static Stats GetStats();
+    static void ResetStats();
+    static void LogStats();
+};
+
+
+#endif
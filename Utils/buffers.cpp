@@ -14,9 +14,25 @@
  *  limitations under the License.
  */
 
+#include <string.h>
 #include "buffers.h"
+#include "binDump.h"
 #include "globals.h"
 
+/// Bytes of a buffer rendered per Logger::Write()/fwrite()
+#define HEX_BLOCK_SIZE          (8 * 1024)
+
+/// The 2 hex chars of every byte value, indexed by (byte * 2)
+static const char hexPairs[] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
 
 Buffers::Buffers()
 {
@@ -33,9 +49,8 @@ Buffers::Log(const uint8_t *buf, uint32_t bufOffset, unsigned long length,
     uint32_t totalBufSize, string objName)
 {
     const uint8_t *data;
-    const int BUF_SIZE = 20;
-    char work[BUF_SIZE];
-    string output;
+    char prefix[256];
+    int prefixLen;
     unsigned long dumpLen = length;
 
 
@@ -52,22 +67,19 @@ Buffers::Log(const uint8_t *buf, uint32_t bufOffset, unsigned long length,
         dumpLen = (totalBufSize - bufOffset);
     LOG_DBG("dumpLen = 0x%016lX", dumpLen);
 
-    for (unsigned long i = 0; i < dumpLen; i++) {
-        if ((i % 16) == 15) {
-            snprintf(work, BUF_SIZE, " %02X", *data++);
-            output += work;
-            LOG_NRM("%s", output.c_str());
-            output.clear();
-        } else if ((i % 16) == 0) {
-            snprintf(work, BUF_SIZE, "0x%08X: %02X", (uint32_t)i, *data++);
-            output += work;
-        } else {
-            snprintf(work, BUF_SIZE, " %02X", *data++);
-            output += work;
-        }
+    if (Logger::GetVerbosity() < LOGLVL_NRM)
+        return;
+
+    // Whole blocks of lines per log statement, each line as LOG_NRM would be
+    prefixLen = LOG_NRM_PREFIX(prefix, sizeof(prefix));
+    prefixLen = min(prefixLen, (int)(sizeof(prefix) - 1));
+    vector<char> block(GetFormatHexSize(prefixLen,
+        min(dumpLen, (unsigned long)HEX_BLOCK_SIZE)));
+    for (unsigned long i = 0; i < dumpLen; i += HEX_BLOCK_SIZE) {
+        size_t len = FormatHex(&block[0], prefix, prefixLen, (data + i),
+            min((dumpLen - i), (unsigned long)HEX_BLOCK_SIZE), i);
+        Logger::Write(LOGLVL_NRM, &block[0], len);
     }
-    if (output.length() != 0)
-        LOG_NRM("%s", output.c_str());
 }
 
 
@@ -75,58 +87,97 @@ void
 Buffers::Dump(DumpFilename filename, const uint8_t *buf, uint32_t bufOffset,
     unsigned long length, uint32_t totalBufSize, string fileHdr)
 {
-    const uint8_t *data;
-    const int BUF_SIZE = 20;
-    char work[BUF_SIZE];
-    string output;
     FILE *fp;
     unsigned long dumpLen = length;
 
 
+    if ((totalBufSize != 0) && (bufOffset >= totalBufSize)) {
+        LOG_ERR("Offset into buffer 0x%08X >= to buffer size 0x%08X",
+            bufOffset, totalBufSize);
+        throw FrmwkEx(HERE);
+    }
+    if (totalBufSize == 0)
+        dumpLen = 0;
+    else if (length == ULONG_MAX)
+        dumpLen = (totalBufSize - bufOffset);
+    else if ((length + bufOffset) >= totalBufSize)
+        dumpLen = (totalBufSize - bufOffset);
+    LOG_DBG("dumpLen = 0x%016lX", dumpLen);
+
+    if (BinDump::IsFramed()) {
+        BinDump::Write(filename, BINDUMP_BUF, 0, (totalBufSize == 0),
+            &(buf[bufOffset]), dumpLen, fileHdr);
+        return;
+    }
+
     LOG_NRM("Dumping to filename: %s", filename.c_str());
     LOG_NRM("%s", fileHdr.c_str());
     if ((fp = fopen(filename.c_str(), "a")) == NULL)
         throw FrmwkEx(HERE, "Failed to open file: %s", filename.c_str());
     fprintf(fp, "%s\n", fileHdr.c_str());
 
-    if (totalBufSize == 0) {
+    if (totalBufSize == 0)
         fprintf(fp, "0x00000000: BUFFER IS EMPTY\n");
-        goto Dump_EXIT_SUCCESS;
-    } else if (bufOffset >= totalBufSize) {
-        LOG_ERR("Offset into buffer 0x%08X >= to buffer size 0x%08X",
-            bufOffset, totalBufSize);
-        goto Dump_EXIT_ERROR;
+    else
+        Dump(fp, &(buf[bufOffset]), dumpLen);
+    fclose(fp);
+}
+
+
+void
+Buffers::Dump(FILE *fp, const uint8_t *buf, unsigned long length)
+{
+    if (length == 0)
+        return;
+
+    vector<char> block(GetFormatHexSize(0,
+        min(length, (unsigned long)HEX_BLOCK_SIZE)));
+    for (unsigned long i = 0; i < length; i += HEX_BLOCK_SIZE) {
+        size_t len = FormatHex(&block[0], NULL, 0, (buf + i),
+            min((length - i), (unsigned long)HEX_BLOCK_SIZE), i);
+        fwrite(&block[0], 1, len, fp);
     }
+}
 
-    data = &(buf[bufOffset]);
-    if (length == ULONG_MAX)
-        dumpLen = (totalBufSize - bufOffset);
-    else if ((length + bufOffset) >= totalBufSize)
-        dumpLen = (totalBufSize - bufOffset);
-    LOG_DBG("dumpLen = 0x%016lX", dumpLen);
 
-    for (unsigned long i = 0; i < dumpLen; i++) {
-        if ((i % 16) == 15) {
-            snprintf(work, BUF_SIZE, " %02X\n", *data++);
-            output += work;
-            fprintf(fp, "%s", output.c_str());
-            output.clear();
-        } else if ((i % 16) == 0) {
-            snprintf(work, BUF_SIZE, "0x%08X: %02X", (uint32_t)i, *data++);
-            output += work;
-        } else {
-            snprintf(work, BUF_SIZE, " %02X", *data++);
-            output += work;
+size_t
+Buffers::FormatHex(char *out, const char *prefix, size_t prefixLen,
+    const uint8_t *buf, unsigned long length, uint32_t offset)
+{
+    char *pos = out;
+
+    for (unsigned long i = 0; i < length; i += HEX_BYTES_PER_LINE) {
+        uint32_t addr = (offset + i);
+        unsigned long num = min((length - i),
+            (unsigned long)HEX_BYTES_PER_LINE);
+
+        if (prefixLen) {
+            memcpy(pos, prefix, prefixLen);
+            pos += prefixLen;
+        }
+        pos[0] = '0';
+        pos[1] = 'x';
+        memcpy(&pos[2], &hexPairs[((addr >> 24) & 0xff) * 2], 2);
+        memcpy(&pos[4], &hexPairs[((addr >> 16) & 0xff) * 2], 2);
+        memcpy(&pos[6], &hexPairs[((addr >> 8) & 0xff) * 2], 2);
+        memcpy(&pos[8], &hexPairs[(addr & 0xff) * 2], 2);
+        pos[10] = ':';
+        pos += 11;
+
+        for (unsigned long j = 0; j < num; j++) {
+            pos[0] = ' ';
+            memcpy(&pos[1], &hexPairs[buf[i + j] * 2], 2);
+            pos += 3;
         }
+        *pos++ = '\n';
     }
-    if (output.length() != 0)
-        fprintf(fp, "%s\n", output.c_str());
+    return (pos - out);
+}
 
-Dump_EXIT_SUCCESS:
-    fclose(fp);
-    return;
 
-Dump_EXIT_ERROR:
-    fclose(fp);
-    throw FrmwkEx(HERE);
+size_t
+Buffers::GetFormatHexSize(size_t prefixLen, unsigned long length)
+{
+    return (((length + HEX_BYTES_PER_LINE - 1) / HEX_BYTES_PER_LINE) *
+        (prefixLen + HEX_LINE_SIZE));
 }
@@ -22,6 +22,12 @@
 #include "fileSystem.h"
 #include "../Queues/ce.h"
 
+/// Bytes rendered per line by Buffers::FormatHex()
+#define HEX_BYTES_PER_LINE      16
+/// Max chars of a line rendered by Buffers::FormatHex(), less its prefix,
+/// i.e. "0x00000000:" followed by " 00" per byte and a new line
+#define HEX_LINE_SIZE           (11 + (HEX_BYTES_PER_LINE * 3) + 1)
+
 
 /**
 * This class is meant not be instantiated because it should only ever contain
@@ -65,6 +71,33 @@ public:
     static void Dump(DumpFilename filename, const uint8_t *buf,
         uint32_t bufOffset, unsigned long length, uint32_t totalBufSize,
         string fileHdr);
+
+    /**
+     * Render length bytes of buf as hex, 16 bytes per line, to an opened
+     * file. Each line is prefixed by the offset of its 1st byte.
+     * @param fp Pass the file to write
+     * @param buf Pass a pointer to the 1st byte to render
+     * @param length Pass the number of bytes to render
+     */
+    static void Dump(FILE *fp, const uint8_t *buf, unsigned long length);
+
+    /**
+     * Render bytes as hex, HEX_BYTES_PER_LINE per line, directly into a
+     * buffer using a lookup table. Each line is the prefix followed by the
+     * offset of its 1st byte, e.g. "0x00000010: 10 11 12", and a new line.
+     * @param out Pass a buffer of at least GetFormatHexSize() chars
+     * @param prefix Pass the text to begin every line with
+     * @param prefixLen Pass the number of chars within prefix, may be 0
+     * @param buf Pass a pointer to the 1st byte to render
+     * @param length Pass the number of bytes to render
+     * @param offset Pass the offset to report for buf[0]
+     * @return The number of chars rendered, which are not NULL terminated
+     */
+    static size_t FormatHex(char *out, const char *prefix, size_t prefixLen,
+        const uint8_t *buf, unsigned long length, uint32_t offset);
+
+    /// @return The max chars FormatHex() renders for the same parameters
+    static size_t GetFormatHexSize(size_t prefixLen, unsigned long length);
 };
 
 
@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <mutex>
+#include <atomic>
+#include "dumpArchive.h"
+#include "../Exception/frmwkEx.h"
+
+#define ARCHIVE_MODE    (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH)
+#define GZIP_OS_UNIX            3
+/// Bytes of the trailer's gzip header extra field, a single subfield
+#define TRAILER_EXTRA_SIZE      12
+/// Offset of the extra field within the trailer's gzip header
+#define TRAILER_EXTRA_OFFSET    10
+/// Bytes read from the archive at a time while decompressing
+#define INFLATE_IN_SIZE         (64 * 1024)
+
+using namespace std;
+
+bool DumpArchive::mEnabled = false;
+
+static std::mutex arcMutex;                 // Guards all below but atomics
+static int arcFd = -1;
+static uint64_t arcEnd = 0;                 // File offset of the next member
+static vector<uint8_t> chunk;               // Records not yet compressed
+static vector<uint8_t> deflated;            // Output of WriteMember()
+static vector<DumpArcEntry> arcIndex;
+static std::atomic<bool> arcOpen(false);
+
+
+/**
+ * Append raw bytes to a vector.
+ * @param data Pass the vector to append to
+ * @param bytes Pass the bytes to append
+ * @param length Pass the number of bytes to append
+ */
+static void
+Put(vector<uint8_t> &data, const void *bytes, size_t length)
+{
+    const uint8_t *src = (const uint8_t *)bytes;
+    data.insert(data.end(), src, (src + length));
+}
+
+
+/**
+ * Extract raw bytes from a vector.
+ * @param data Pass the vector to extract from
+ * @param pos Pass the offset to extract from, returns the offset following
+ * @param bytes Returns the bytes extracted
+ * @param length Pass the number of bytes to extract
+ * @return true if data holds enough bytes, otherwise false
+ */
+static bool
+Get(const vector<uint8_t> &data, size_t &pos, void *bytes, size_t length)
+{
+    if ((data.size() - pos) < length)
+        return false;
+    memcpy(bytes, &data[pos], length);
+    pos += length;
+    return true;
+}
+
+
+/**
+ * Parse the decompressed data of the gzip member holding an archive's index.
+ * @param data Pass the member's data
+ * @param index Returns every record within the archive, in order
+ * @return true if successful, otherwise false
+ */
+static bool
+ParseIndex(const vector<uint8_t> &data, vector<DumpArcEntry> &index)
+{
+    char magic[sizeof(DUMPARC_INDEX_MAGIC) - 1];
+    uint32_t count;
+    uint16_t nameLen;
+    size_t pos = 0;
+
+    if ((Get(data, pos, magic, sizeof(magic)) == false) ||
+        memcmp(magic, DUMPARC_INDEX_MAGIC, sizeof(magic)) ||
+        (Get(data, pos, &count, sizeof(count)) == false)) {
+        return false;
+    }
+
+    index.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        if ((Get(data, pos, &nameLen, sizeof(nameLen)) == false) ||
+            ((data.size() - pos) < nameLen)) {
+            return false;
+        }
+        index[i].name.assign((const char *)&data[pos], nameLen);
+        pos += nameLen;
+        if ((Get(data, pos, &index[i].member, sizeof(uint64_t)) == false) ||
+            (Get(data, pos, &index[i].offset, sizeof(uint32_t)) == false) ||
+            (Get(data, pos, &index[i].length, sizeof(uint32_t)) == false)) {
+            return false;
+        }
+    }
+    return (pos == data.size());
+}
+
+
+DumpArchive::DumpArchive()
+{
+}
+
+
+DumpArchive::~DumpArchive()
+{
+}
+
+
+bool
+DumpArchive::IsOpen()
+{
+    return arcOpen;
+}
+
+
+bool
+DumpArchive::Open(DumpFilename filename)
+{
+    vector<DumpArcEntry> index;
+    uint64_t end;
+    int fd;
+
+    if (mEnabled == false)
+        return false;
+    Close();
+
+    if ((fd = open(filename.c_str(), (O_RDWR | O_CREAT), ARCHIVE_MODE)) < 0) {
+        LOG_ERR("Failed to open archive: %s: %s", filename.c_str(),
+            strerror(errno));
+        return false;
+    }
+
+    // Continue an existing archive by overwriting its index
+    if ((ReadIndex(fd, index, end) == false) || ftruncate(fd, end)) {
+        LOG_ERR("Unable to continue archive: %s", filename.c_str());
+        close(fd);
+        return false;
+    }
+
+    LOG_NRM("Archiving dumps to filename: %s", filename.c_str());
+    std::lock_guard<std::mutex> lock(arcMutex);
+    arcIndex.swap(index);
+    arcEnd = end;
+    arcFd = fd;
+    chunk.clear();
+    chunk.reserve(DUMPARC_CHUNK_SIZE);
+    arcOpen = true;
+    return true;
+}
+
+
+bool
+DumpArchive::Close()
+{
+    vector<uint8_t> index;
+    uint8_t extra[TRAILER_EXTRA_SIZE];
+    uint32_t count;
+    uint16_t nameLen;
+    bool success = true;
+
+    std::lock_guard<std::mutex> lock(arcMutex);
+    if (arcOpen == false)
+        return true;
+    arcOpen = false;
+
+    if (chunk.empty() == false)
+        success = WriteMember(&chunk[0], chunk.size(), NULL, 0);
+    chunk.clear();
+
+    uint64_t indexOffset = arcEnd;
+    count = arcIndex.size();
+    Put(index, DUMPARC_INDEX_MAGIC, (sizeof(DUMPARC_INDEX_MAGIC) - 1));
+    Put(index, &count, sizeof(count));
+    for (size_t i = 0; i < arcIndex.size(); i++) {
+        nameLen = arcIndex[i].name.length();
+        Put(index, &nameLen, sizeof(nameLen));
+        Put(index, arcIndex[i].name.data(), nameLen);
+        Put(index, &arcIndex[i].member, sizeof(uint64_t));
+        Put(index, &arcIndex[i].offset, sizeof(uint32_t));
+        Put(index, &arcIndex[i].length, sizeof(uint32_t));
+    }
+    success = (success && WriteMember(&index[0], index.size(), NULL, 0));
+
+    // gzip extra subfield: id 'T','I', little endian length, index offset
+    extra[0] = 'T';
+    extra[1] = 'I';
+    extra[2] = sizeof(indexOffset);
+    extra[3] = 0;
+    memcpy(&extra[4], &indexOffset, sizeof(indexOffset));
+    success = (success && WriteMember(NULL, 0, extra, sizeof(extra)));
+
+    close(arcFd);
+    arcFd = -1;
+    arcIndex.clear();
+    if (success == false)
+        LOG_ERR("Failed to write the index of an archive");
+    return success;
+}
+
+
+void
+DumpArchive::Append(DumpFilename filename, const BinDumpHdr &hdr,
+    const string &label, const uint8_t *payload)
+{
+    DumpArcEntry entry;
+    uint16_t nameLen;
+    bool failed = false;
+
+    if (filename.length() > UINT16_MAX)
+        filename.resize(UINT16_MAX);
+    nameLen = filename.length();
+
+    {
+        std::lock_guard<std::mutex> lock(arcMutex);
+
+        if (arcOpen) {
+            entry.name = filename;
+            entry.length = (sizeof(nameLen) + nameLen + sizeof(hdr) +
+                hdr.labelLen + hdr.length);
+
+            bool success = true;
+            if ((chunk.empty() == false) &&
+                ((chunk.size() + entry.length) > DUMPARC_CHUNK_SIZE)) {
+                success = WriteMember(&chunk[0], chunk.size(), NULL, 0);
+                chunk.clear();
+            }
+
+            if (success) {
+                entry.member = arcEnd;
+                entry.offset = chunk.size();
+                arcIndex.push_back(entry);
+                Put(chunk, &nameLen, sizeof(nameLen));
+                Put(chunk, filename.data(), nameLen);
+                Put(chunk, &hdr, sizeof(hdr));
+                Put(chunk, label.data(), hdr.labelLen);
+                Put(chunk, payload, hdr.length);
+                return;
+            }
+
+            // Abandon the archive, its index is rebuilt upon reopening
+            failed = true;
+            arcOpen = false;
+            close(arcFd);
+            arcFd = -1;
+            arcIndex.clear();
+            chunk.clear();
+        }
+    }
+
+    // Throwing leads to more dumps, thus it must be done without the lock
+    if (failed)
+        throw FrmwkEx(HERE, "Failed to write archive");
+
+    // Archiving stopped after the caller checked, the frame is not ours
+    BinDump::WriteFrame(filename, hdr, label, payload);
+}
+
+
+bool
+DumpArchive::WriteMember(const uint8_t *data, size_t size, uint8_t *extra,
+    uint32_t extraLen)
+{
+    z_stream strm;
+    gz_header gzHdr;
+    size_t written = 0;
+    ssize_t rc;
+
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, (MAX_WBITS + 16),
+        MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    if (extra) {
+        memset(&gzHdr, 0, sizeof(gzHdr));
+        gzHdr.os = GZIP_OS_UNIX;
+        gzHdr.extra = extra;
+        gzHdr.extra_len = extraLen;
+        deflateSetHeader(&strm, &gzHdr);
+    }
+
+    deflated.resize(deflateBound(&strm, size) + extraLen);
+    strm.next_in = (Bytef *)data;
+    strm.avail_in = size;
+    strm.next_out = &deflated[0];
+    strm.avail_out = deflated.size();
+    bool success = (deflate(&strm, Z_FINISH) == Z_STREAM_END);
+    size_t length = (deflated.size() - strm.avail_out);
+    deflateEnd(&strm);
+    if (success == false)
+        return false;
+
+    while (written < length) {
+        rc = pwrite(arcFd, &deflated[written], (length - written),
+            (arcEnd + written));
+        if (rc <= 0)
+            return false;
+        written += rc;
+    }
+    arcEnd += length;
+    return true;
+}
+
+
+bool
+DumpArchive::ReadMember(int fd, uint64_t offset, vector<uint8_t> &data,
+    uint64_t &next)
+{
+    vector<uint8_t> in(INFLATE_IN_SIZE);
+    uint8_t out[16 * 1024];
+    uint64_t pos = offset;
+    z_stream strm;
+    ssize_t num;
+    int rc = Z_OK;
+
+    data.clear();
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit2(&strm, (MAX_WBITS + 16)) != Z_OK)
+        return false;
+
+    // A gzip stream ends at the end of the member, not of the file
+    while (rc != Z_STREAM_END) {
+        if (strm.avail_in == 0) {
+            if ((num = pread(fd, &in[0], in.size(), pos)) <= 0)
+                break;
+            pos += num;
+            strm.next_in = &in[0];
+            strm.avail_in = num;
+        }
+        strm.next_out = out;
+        strm.avail_out = sizeof(out);
+        rc = inflate(&strm, Z_NO_FLUSH);
+        if ((rc != Z_OK) && (rc != Z_STREAM_END))
+            break;
+        data.insert(data.end(), out, (out + sizeof(out) - strm.avail_out));
+    }
+    next = (offset + strm.total_in);
+    inflateEnd(&strm);
+    return (rc == Z_STREAM_END);
+}
+
+
+bool
+DumpArchive::ReadIndex(int fd, vector<DumpArcEntry> &index, uint64_t &end)
+{
+    uint8_t trailer[DUMPARC_TRAILER_SIZE];
+    uint8_t *extra = &trailer[TRAILER_EXTRA_OFFSET + sizeof(uint16_t)];
+    vector<uint8_t> data;
+    uint64_t indexOffset;
+    uint64_t offset = 0;
+    uint64_t next;
+    struct stat st;
+
+    index.clear();
+    end = 0;
+    if (fstat(fd, &st) < 0)
+        return false;
+    uint64_t size = st.st_size;
+
+    // Closed archives end with an empty member locating the index
+    if ((size >= DUMPARC_TRAILER_SIZE) && (pread(fd, trailer, sizeof(trailer),
+        (size - sizeof(trailer))) == (ssize_t)sizeof(trailer)) &&
+        (trailer[0] == 0x1f) && (trailer[1] == 0x8b) && (trailer[3] & 0x04) &&
+        (trailer[TRAILER_EXTRA_OFFSET] == TRAILER_EXTRA_SIZE) &&
+        (trailer[TRAILER_EXTRA_OFFSET + 1] == 0) &&
+        (extra[0] == 'T') && (extra[1] == 'I')) {
+
+        memcpy(&indexOffset, &extra[4], sizeof(indexOffset));
+        if ((indexOffset < size) &&
+            ReadMember(fd, indexOffset, data, next) &&
+            ParseIndex(data, index)) {
+            end = indexOffset;
+            return true;
+        }
+        index.clear();
+    }
+
+    // Otherwise rebuild the index from every complete member
+    while ((offset < size) && ReadMember(fd, offset, data, next)) {
+        if ((data.size() < (sizeof(DUMPARC_INDEX_MAGIC) - 1)) ||
+            memcmp(&data[0], DUMPARC_INDEX_MAGIC,
+            (sizeof(DUMPARC_INDEX_MAGIC) - 1))) {
+            if (ScanRecords(data, offset, index) == false)
+                break;
+        }
+        offset = next;
+    }
+    if (offset < size) {
+        LOG_WARN("Archive is truncated after offset 0x%08lX of 0x%08lX",
+            offset, size);
+    }
+    end = offset;
+    return true;
+}
+
+
+bool
+DumpArchive::ScanRecords(const vector<uint8_t> &data, uint64_t member,
+    vector<DumpArcEntry> &index)
+{
+    vector<DumpArcEntry> found;
+    DumpArcEntry entry;
+    BinDumpHdr hdr;
+    string label;
+    const uint8_t *payload;
+    uint16_t nameLen;
+    size_t pos = 0;
+
+    while (pos < data.size()) {
+        entry.offset = pos;
+        if ((Get(data, pos, &nameLen, sizeof(nameLen)) == false) ||
+            ((data.size() - pos) < nameLen)) {
+            return false;
+        }
+        entry.name.assign((const char *)&data[pos], nameLen);
+        pos += nameLen;
+        if (BinDump::Parse(&data[0], data.size(), pos, hdr, label,
+            payload) == false) {
+            return false;
+        }
+        entry.member = member;
+        entry.length = (pos - entry.offset);
+        found.push_back(entry);
+    }
+    index.insert(index.end(), found.begin(), found.end());
+    return true;
+}
+
+
+bool
+DumpArchive::ParseRecord(const vector<uint8_t> &data,
+    const DumpArcEntry &entry, BinDumpHdr &hdr, string &label,
+    const uint8_t *&payload)
+{
+    uint16_t nameLen;
+    size_t pos = entry.offset;
+    size_t end = ((size_t)entry.offset + entry.length);
+
+    if ((end > data.size()) ||
+        (Get(data, pos, &nameLen, sizeof(nameLen)) == false)) {
+        return false;
+    }
+    pos += nameLen;
+    if (pos > end)
+        return false;
+    return (BinDump::Parse(&data[0], end, pos, hdr, label, payload) &&
+        (pos == end));
+}
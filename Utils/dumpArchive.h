@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _DUMPARCHIVE_H_
+#define _DUMPARCHIVE_H_
+
+#include <vector>
+#include "binDump.h"
+
+/// Bytes of records buffered before they are compressed into a gzip member
+#define DUMPARC_CHUNK_SIZE          (1024 * 1024)
+/// Begins the data of the gzip member holding the index
+#define DUMPARC_INDEX_MAGIC         "TNVMEIDX"
+/// Bytes of the empty gzip member which terminates every archive
+#define DUMPARC_TRAILER_SIZE        34
+
+/// Locates a single dump, i.e. a record, within an archive
+struct DumpArcEntry {
+    string   name;          // The dump file it was destined for
+    uint64_t member;        // File offset of the gzip member holding it
+    uint32_t offset;        // Offset of the record within the member's data
+    uint32_t length;        // Bytes of the record
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. When enabled, each test streams all of its dumps into a
+* single compressed archive rather than into individual dump files. Every
+* dump becomes a record consisting of the name of the file it was destined
+* for, as created by FileSystem::PrepDumpFile(), followed by its BinDump
+* frame. Records are buffered up to DUMPARC_CHUNK_SIZE and then compressed
+* into a gzip member appended to the archive, thus the memory consumed is
+* bounded and the archive remains a valid gzip file, e.g. for zcat.
+*
+* Closing the archive appends an index of all records as another gzip member,
+* followed by an empty gzip member of DUMPARC_TRAILER_SIZE bytes whose header
+* extra field holds the file offset of the index. Should tnvme die before the
+* archive is closed, the index is rebuilt by decompressing every member.
+* Reopening an archive, e.g. --loop, continues it rather than replacing it.
+* Dumps written by dnvme itself, i.e. KernelAPI::Dump*(), are not archived.
+*
+* @note This class may throw exceptions, please see comment within specific
+*       methods.
+*/
+class DumpArchive
+{
+public:
+    DumpArchive();
+    virtual ~DumpArchive();
+
+    static void SetEnabled(bool enabled) { mEnabled = enabled; }
+    static bool IsEnabled() { return mEnabled; }
+
+    /**
+     * Start streaming all dumps into an archive, continuing it if it exists.
+     * Does nothing unless enabled.
+     * @note This method will not throw
+     * @param filename Pass the filename as generated by macro
+     *      FileSystem::PrepDumpFile().
+     * @return true if successful, otherwise false and dumps are written to
+     *      their individual files.
+     */
+    static bool Open(DumpFilename filename);
+
+    /**
+     * Compress any buffered records, write the index and stop archiving.
+     * @note This method will not throw
+     * @return true if successful, otherwise false
+     */
+    static bool Close();
+
+    /// @return true if dumps are currently being streamed into an archive
+    static bool IsOpen();
+
+    /**
+     * Add a frame destined for a dump file to the archive. Only to be called
+     * by BinDump::WriteFrame().
+     * @note This method may throw
+     * @param filename Pass the filename as generated by macro
+     *      FileSystem::PrepDumpFile().
+     * @param hdr Pass the frame's header
+     * @param label Pass the frame's label text, of hdr.labelLen bytes
+     * @param payload Pass the frame's raw bytes, of hdr.length bytes
+     */
+    static void Append(DumpFilename filename, const BinDumpHdr &hdr,
+        const string &label, const uint8_t *payload);
+
+    /**
+     * Read the index of an archive, or rebuild it if the archive was never
+     * closed.
+     * @note This method will not throw
+     * @param fd Pass an open file descriptor of the archive
+     * @param index Returns every record within the archive, in order
+     * @param end Returns the file offset at which the records end, i.e. that
+     *      of the index or of any partially written member.
+     * @return true if successful, otherwise false
+     */
+    static bool ReadIndex(int fd, vector<DumpArcEntry> &index, uint64_t &end);
+
+    /**
+     * Decompress a single gzip member of an archive.
+     * @note This method will not throw
+     * @param fd Pass an open file descriptor of the archive
+     * @param offset Pass the file offset of the member
+     * @param data Returns the member's decompressed data
+     * @param next Returns the file offset of the following member
+     * @return true if successful, otherwise false
+     */
+    static bool ReadMember(int fd, uint64_t offset, vector<uint8_t> &data,
+        uint64_t &next);
+
+    /**
+     * Locate the frame within a record.
+     * @param data Pass the decompressed data of the record's member
+     * @param entry Pass the record's index entry
+     * @param hdr Returns the frame's header
+     * @param label Returns the frame's label text
+     * @param payload Returns a pointer to the frame's raw bytes within data
+     * @return true if successful, otherwise false
+     */
+    static bool ParseRecord(const vector<uint8_t> &data,
+        const DumpArcEntry &entry, BinDumpHdr &hdr, string &label,
+        const uint8_t *&payload);
+
+
+private:
+    static bool mEnabled;
+
+    /**
+     * Compress data into a gzip member and append it to the open archive.
+     * @param data Pass the data to compress
+     * @param size Pass the number of bytes within data
+     * @param extra Pass the gzip header extra field, or NULL for none
+     * @param extraLen Pass the number of bytes within extra
+     * @return true if successful, otherwise false
+     */
+    static bool WriteMember(const uint8_t *data, size_t size,
+        uint8_t *extra, uint32_t extraLen);
+
+    /**
+     * Locate every record within a member's data.
+     * @param data Pass the decompressed data of the member
+     * @param member Pass the file offset of the member
+     * @param index Returns an entry for every record found
+     * @return true if the data is entirely records, otherwise false
+     */
+    static bool ScanRecords(const vector<uint8_t> &data, uint64_t member,
+        vector<DumpArcEntry> &index);
+};
+
+
+#endif
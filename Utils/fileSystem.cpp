@@ -14,16 +14,33 @@
  *  limitations under the License.
  */
 
+#include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
 #include <boost/filesystem.hpp>
 #include "fileSystem.h"
 #include "../Exception/frmwkEx.h"
 
 #define BASE_NAME_DIR_INFO      "/Informative/"
 #define BASE_NAME_PENDING       "/GrpPending/"
+#define PREV_SUFFIX             ".prev/"
+#define DUMP_DIR_MODE           (S_IRWXU | S_IRWXG | S_IRWXO)
+
+/// Max threads removing the files of a single directory
+#define UNLINK_THREADS          4
+/// Fewer files than this per thread are not worth the thread
+#define UNLINK_PER_THREAD_MIN   256
+
+#ifndef RENAME_EXCHANGE
+#define RENAME_EXCHANGE         (1 << 1)
+#endif
 
 using namespace std;
 
@@ -45,24 +62,20 @@ FileSystem::~FileSystem()
 bool
 FileSystem::SetRootDumpDir(string dir)
 {
-    char work[256];
-
     mDumpDirPending = (dir + BASE_NAME_PENDING);
     mDumpDirInfo = (dir + BASE_NAME_DIR_INFO);
 
     try {
         if (boost::filesystem::exists(dir.c_str())) {
             SetBaseDumpDir(false);
-            snprintf(work, sizeof(work), "mkdir -p -m 777 %s",
-                mDumpDirPending.c_str());
-            system(work);
+            if (MakeDumpDir(mDumpDirPending) == false)
+                return false;
             if (CleanDumpDir() == false)
                 return false;
 
             SetBaseDumpDir(true);    // this is the default
-            snprintf(work, sizeof(work), "mkdir -p -m 777 %s",
-                mDumpDirInfo.c_str());
-            system(work);
+            if (MakeDumpDir(mDumpDirInfo) == false)
+                return false;
             if (CleanDumpDir() == false)
                 return false;
 
@@ -81,7 +94,6 @@ FileSystem::SetRootDumpDir(string dir)
 bool
 FileSystem::CleanDumpDir()
 {
-    char work[256];
     string dumpDir = (mUseDirInfo) ? mDumpDirInfo : mDumpDirPending;
 
     if (dumpDir.empty()) {
@@ -89,48 +101,167 @@ FileSystem::CleanDumpDir()
         return false;
     }
 
-    // Remove everything in the dir, not the dir itself
-    snprintf(work, sizeof(work), "rm -rf %s*", dumpDir.c_str());
-    system(work);
-    if (boost::filesystem::exists(work)) {
-        LOG_ERR("Unable to remove files within: %s", dumpDir.c_str());
+    // Remove everything in the dir, not the dir itself, nor its rotation
+    if (CleanDir(dumpDir, true) == false)
         return false;
-    }
-    return true;
+    return CleanDir(GetPrevDumpDir(dumpDir), false);
 }
 
 
 bool
 FileSystem::RotateDumpDir()
 {
-    char work[256];
     string dumpDir = (mUseDirInfo) ? mDumpDirInfo : mDumpDirPending;
 
     if (dumpDir.empty())
         return true;
 
-    // Remove everything in the dir of the form "*.prev"
-    snprintf(work, sizeof(work), "rm %s*.prev", dumpDir.c_str());
-    system(work);
-
-    // Get a vector of filenames of all other files within dir
-    boost::filesystem::path targDir(dumpDir);
-    vector<boost::filesystem::path> allFiles;
-    copy(boost::filesystem::directory_iterator(targDir),
-        boost::filesystem::directory_iterator(), back_inserter(allFiles));
-
-    // Rename all files to "*.prev"
-    for (size_t i = 0; i < allFiles.size(); i++) {
-        string newName = (allFiles[i].filename().native() + ".prev");
-        snprintf(work, sizeof(work), "mv %s%s %s%s.prev",
-            dumpDir.c_str(), allFiles[i].filename().c_str(),
-            dumpDir.c_str(), allFiles[i].filename().c_str());
-        system(work);
+    string prevDir = GetPrevDumpDir(dumpDir);
+    if (MakeDumpDir(prevDir) == false)
+        return false;
+
+    // Swapping the dirs leaves the dump dir holding the generation before
+    // last, which is emptied; nothing is moved file by file.
+#ifdef SYS_renameat2
+    if (syscall(SYS_renameat2, AT_FDCWD, dumpDir.c_str(), AT_FDCWD,
+        prevDir.c_str(), RENAME_EXCHANGE) == 0) {
+        return CleanDir(dumpDir, true);
+    }
+    LOG_DBG("renameat2(RENAME_EXCHANGE): %s", strerror(errno));
+#endif
+
+    // Kernels/file systems lacking RENAME_EXCHANGE replace the empty dir
+    if (CleanDir(prevDir, true) == false)
+        return false;
+    if (rename(dumpDir.c_str(), prevDir.c_str()) != 0) {
+        LOG_ERR("Unable to rename %s to %s: %s", dumpDir.c_str(),
+            prevDir.c_str(), strerror(errno));
+        return false;
+    }
+    return MakeDumpDir(dumpDir);
+}
+
+
+string
+FileSystem::GetPrevDumpDir(string dumpDir)
+{
+    while ((dumpDir.length() > 1) && (dumpDir[dumpDir.length() - 1] == '/'))
+        dumpDir.erase(dumpDir.length() - 1);
+    return (dumpDir + PREV_SUFFIX);
+}
+
+
+bool
+FileSystem::MakeDumpDir(string dir)
+{
+    if ((mkdir(dir.c_str(), DUMP_DIR_MODE) != 0) && (errno != EEXIST)) {
+        LOG_ERR("Unable to create dir %s: %s", dir.c_str(), strerror(errno));
+        return false;
+    }
+
+    // Dumps are world writable regardless of the umask
+    if (chmod(dir.c_str(), DUMP_DIR_MODE) != 0) {
+        LOG_ERR("Unable to chmod dir %s: %s", dir.c_str(), strerror(errno));
+        return false;
     }
     return true;
 }
 
 
+bool
+FileSystem::CleanDir(string dir, bool mustExist)
+{
+    int dirFd;
+
+    if ((dirFd = open(dir.c_str(), (O_RDONLY | O_DIRECTORY))) < 0) {
+        if ((errno == ENOENT) && (mustExist == false))
+            return true;
+        LOG_ERR("Unable to open dir %s: %s", dir.c_str(), strerror(errno));
+        return false;
+    }
+
+    bool success = RemoveDirContents(dirFd);
+    close(dirFd);
+    if (success == false)
+        LOG_ERR("Unable to remove files within: %s", dir.c_str());
+    return success;
+}
+
+
+bool
+FileSystem::RemoveDirContents(int dirFd)
+{
+    vector<string> files;
+    vector<string> dirs;
+    struct dirent *entry;
+    struct stat st;
+    DIR *dir;
+    int fd;
+
+    // fdopendir() takes ownership of the fd it is given
+    if ((fd = dup(dirFd)) < 0)
+        return false;
+    if ((dir = fdopendir(fd)) == NULL) {
+        close(fd);
+        return false;
+    }
+    while ((entry = readdir(dir)) != NULL) {
+        if ((strcmp(entry->d_name, ".") == 0) ||
+            (strcmp(entry->d_name, "..") == 0)) {
+            continue;
+        }
+
+        bool isDir = (entry->d_type == DT_DIR);
+        if ((entry->d_type == DT_UNKNOWN) && (fstatat(dirFd, entry->d_name,
+            &st, AT_SYMLINK_NOFOLLOW) == 0)) {
+            isDir = S_ISDIR(st.st_mode);
+        }
+        if (isDir)
+            dirs.push_back(entry->d_name);
+        else
+            files.push_back(entry->d_name);
+    }
+    closedir(dir);
+
+    bool success = true;
+    for (size_t i = 0; i < dirs.size(); i++) {
+        fd = openat(dirFd, dirs[i].c_str(),
+            (O_RDONLY | O_DIRECTORY | O_NOFOLLOW));
+        if (fd < 0) {
+            success = false;
+            continue;
+        }
+        success = (RemoveDirContents(fd) && success);
+        close(fd);
+        if (unlinkat(dirFd, dirs[i].c_str(), AT_REMOVEDIR) != 0)
+            success = false;
+    }
+
+    // The parent dir's lock serializes the unlinks themselves, but the
+    // release of each file's blocks happens outside of it, in parallel.
+    size_t numThreads = (files.size() / UNLINK_PER_THREAD_MIN);
+    numThreads = min(numThreads, (size_t)UNLINK_THREADS);
+    std::atomic<bool> unlinked(true);
+    auto unlinker = [&](size_t first, size_t stride) {
+        for (size_t i = first; i < files.size(); i += stride) {
+            if (unlinkat(dirFd, files[i].c_str(), 0) != 0)
+                unlinked = false;
+        }
+    };
+
+    if (numThreads <= 1) {
+        unlinker(0, 1);
+    } else {
+        vector<std::thread> threads;
+        for (size_t t = 0; t < numThreads; t++)
+            threads.push_back(std::thread(unlinker, t, numThreads));
+        for (size_t t = 0; t < numThreads; t++)
+            threads[t].join();
+    }
+    return (success && unlinked);
+}
+
+
 string
 FileSystem::PrepDumpFile(string grpName, string className, string objName,
     string qualifier)
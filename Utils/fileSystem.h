@@ -69,19 +69,23 @@ public:
     static void SetBaseDumpDir(bool useDirInfo) { mUseDirInfo = useDirInfo; }
 
     /**
-     * Cleans all files from the base dump directory. Each new group which
-     * executes should start dumping to an empty directory. This approach keeps
-     * only the last group's dumps and attempts to prevent the file system from
-     * breaching a maximum limit.
+     * Cleans all files from the base dump directory, and from its ".prev"
+     * rotation, see RotateDumpDir(). Each new group which executes should
+     * start dumping to an empty directory. This approach keeps only the last
+     * group's dumps and attempts to prevent the file system from breaching a
+     * maximum limit.
      * @note This method will not throw
      * @return true if successful, otherwise false;
      */
     static bool CleanDumpDir();
 
     /**
-     * All the files from the base dump directory will be rotated such that
-     * filenames of the format "*.prev" will be deleted, and all other files
-     * currently within will be renamed to "*.prev".
+     * The base dump directory will be rotated such that all the files
+     * currently within it are found in the sibling directory of the same name
+     * suffixed ".prev", i.e. \<root_dump\>/Informative.prev, which no longer
+     * holds what it did, and the base dump directory is left empty. The two
+     * directories are exchanged with renameat2(RENAME_EXCHANGE) rather than
+     * renaming file by file.
      * @note This method will not throw
      * @return true if successful, otherwise false;
      */
@@ -101,6 +105,35 @@ public:
 
 
 private:
+    /**
+     * @param dumpDir Pass a base dump directory
+     * @return The name of the directory RotateDumpDir() rotates dumpDir into
+     */
+    static string GetPrevDumpDir(string dumpDir);
+
+    /**
+     * Create a world writable directory, unless it already exists.
+     * @param dir Pass the name of the directory to create
+     * @return true if successful, otherwise false;
+     */
+    static bool MakeDumpDir(string dir);
+
+    /**
+     * Remove everything within a directory, but not the directory itself.
+     * @param dir Pass the name of the directory to clean
+     * @param mustExist Pass false if a missing directory is already clean
+     * @return true if successful, otherwise false;
+     */
+    static bool CleanDir(string dir, bool mustExist);
+
+    /**
+     * Remove everything within a directory recursively, but not the directory
+     * itself. The files of large directories are removed by multiple threads.
+     * @param dirFd Pass an open file descriptor of the directory
+     * @return true if successful, otherwise false;
+     */
+    static bool RemoveDirContents(int dirFd);
+
     /// true uses mDumpDirGrpInfo; false uses mDumpDirPending
     static bool mUseDirInfo;
     static string mDumpDirInfo;
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include "flightRec.h"
+#include "../Exception/frmwkEx.h"
+
+using namespace std;
+
+
+/// A frame, and the dump file it was destined for, held by the recorder
+struct FlightRecord {
+    DumpFilename        filename;
+    BinDumpHdr          hdr;
+    string              label;
+    vector<uint8_t>     payload;
+};
+
+static std::mutex recMutex;                 // Guards all below but atomics
+static deque<FlightRecord> records;         // Oldest capture at the front
+static uint64_t retained = 0;               // Bytes consumed by records
+static uint64_t numDropped = 0;             // Captures evicted or too large
+static std::atomic<bool> recording(false);
+static std::atomic<uint64_t> budget(0);
+
+
+/**
+ * Approximate the memory a record consumes, for budgeting purposes.
+ * @param rec Pass the record to examine
+ * @return The number of bytes
+ */
+static uint64_t
+RecordSize(const FlightRecord &rec)
+{
+    return (sizeof(rec) + rec.filename.length() + rec.label.length() +
+        rec.payload.size());
+}
+
+
+FlightRec::FlightRec()
+{
+}
+
+
+FlightRec::~FlightRec()
+{
+}
+
+
+void
+FlightRec::SetBudget(uint64_t bytes)
+{
+    budget = bytes;
+}
+
+
+uint64_t
+FlightRec::GetBudget()
+{
+    return budget;
+}
+
+
+bool
+FlightRec::IsRecording()
+{
+    return recording;
+}
+
+
+void
+FlightRec::Start()
+{
+    std::lock_guard<std::mutex> lock(recMutex);
+
+    records.clear();
+    retained = 0;
+    numDropped = 0;
+    recording = (budget != 0);
+}
+
+
+void
+FlightRec::Discard()
+{
+    std::lock_guard<std::mutex> lock(recMutex);
+
+    recording = false;
+    records.clear();
+    retained = 0;
+    numDropped = 0;
+}
+
+
+void
+FlightRec::Capture(DumpFilename filename, const BinDumpHdr &hdr,
+    const string &label, const uint8_t *payload)
+{
+    FlightRecord rec;
+
+    // Copy outside the lock, other IOWorker threads may be dumping too
+    rec.filename = filename;
+    rec.hdr = hdr;
+    rec.label = label;
+    rec.payload.assign(payload, (payload + hdr.length));
+    uint64_t size = RecordSize(rec);
+
+    {
+        std::lock_guard<std::mutex> lock(recMutex);
+
+        if (recording) {
+            if (size > budget) {
+                numDropped++;
+                return;
+            }
+            records.push_back(std::move(rec));
+            retained += size;
+            while (retained > budget) {
+                retained -= RecordSize(records.front());
+                records.pop_front();
+                numDropped++;
+            }
+            return;
+        }
+    }
+
+    // Recording stopped after the caller checked, the frame is not ours
+    BinDump::WriteFrame(filename, hdr, label, payload);
+}
+
+
+void
+FlightRec::Flush()
+{
+    deque<FlightRecord> work;
+    uint64_t dropped;
+    FILE *fp;
+
+    // Stop first, anything dumped while or after writing goes to disk
+    {
+        std::lock_guard<std::mutex> lock(recMutex);
+
+        recording = false;
+        work.swap(records);
+        dropped = numDropped;
+        retained = 0;
+        numDropped = 0;
+    }
+
+    if (work.empty() && (dropped == 0))
+        return;
+
+    LOG_NRM("Flight recorder writing the last %lu captured dumps",
+        work.size());
+    if (dropped) {
+        LOG_WARN("Flight recorder dropped the oldest %lu dumps to remain "
+            "within its budget of %lu bytes", dropped, budget.load());
+    }
+
+    for (size_t i = 0; i < work.size(); i++) {
+        FlightRecord &rec = work[i];
+        if (BinDump::IsFramed()) {
+            BinDump::WriteFrame(rec.filename, rec.hdr, rec.label,
+                rec.payload.data());
+        } else {
+            LOG_NRM("Dumping to filename: %s", rec.filename.c_str());
+            if ((fp = fopen(rec.filename.c_str(), "a")) == NULL) {
+                throw FrmwkEx(HERE, "Failed to open file: %s",
+                    rec.filename.c_str());
+            }
+            BinDump::Render(fp, rec.filename, rec.hdr, rec.label,
+                rec.payload.data());
+            fclose(fp);
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _FLIGHTREC_H_
+#define _FLIGHTREC_H_
+
+#include "binDump.h"
+
+/// Default memory budget of the flight recorder, in MiB, when enabled
+#define FLIGHTREC_DEFAULT_MiB       16
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It is a flight recorder for the Dump() methods throughout
+* the framework. Tests routinely dump queues, cmds and buffers on their
+* success paths, and practically all of those files are never read because
+* the test passes. While recording, every dump is captured in memory as a
+* BinDump frame rather than being written. The most recent captures are
+* retained within a memory budget, the oldest being dropped to make room for
+* new ones. When the test fails, or upon any FrmwkEx, the retained captures
+* are written to the very files they were destined for, either as frames or
+* as text depending upon BinDump::IsFramed(). When the test passes they are
+* simply discarded, and thus a passing test performs no dump file I/O.
+*
+* @note This class may throw exceptions, please see comment within specific
+*       methods.
+*/
+class FlightRec
+{
+public:
+    FlightRec();
+    virtual ~FlightRec();
+
+    /**
+     * Set the memory budget for the captures retained at any one time.
+     * @note This method will not throw
+     * @param bytes Pass the budget, 0 disables the flight recorder such that
+     *      all dumps are written immediately, which is the default.
+     */
+    static void SetBudget(uint64_t bytes);
+    static uint64_t GetBudget();
+
+    /**
+     * Start recording on behalf of a test, discarding anything captured
+     * previously. Does nothing when the flight recorder is disabled.
+     * @note This method will not throw
+     */
+    static void Start();
+
+    /**
+     * Stop recording and throw away everything captured, i.e. the test passed.
+     * @note This method will not throw
+     */
+    static void Discard();
+
+    /**
+     * Stop recording and write everything captured to the dump files, i.e.
+     * the test failed. Anything dumped afterwards is written immediately.
+     * @note This method may throw
+     */
+    static void Flush();
+
+    /// @return true if dumps are currently being captured rather than written
+    static bool IsRecording();
+
+    /**
+     * Retain a copy of a frame destined for a dump file. Only to be called
+     * by BinDump::Write(). Should recording stop in the meantime the frame
+     * is written immediately instead.
+     * @note This method may throw
+     * @param filename Pass the filename as generated by macro
+     *      FileSystem::PrepDumpFile().
+     * @param hdr Pass the frame's header
+     * @param label Pass the frame's label text, of hdr.labelLen bytes
+     * @param payload Pass the frame's raw bytes, of hdr.length bytes
+     */
+    static void Capture(DumpFilename filename, const BinDumpHdr &hdr,
+        const string &label, const uint8_t *payload);
+};
+
+
+#endif
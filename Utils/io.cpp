@@ -124,15 +124,11 @@ IO::ReapCE(SharedCQPtr cq, uint32_t numCE, uint32_t &isrCount,
 {
     uint32_t ceRemain;
     uint32_t numReaped;
+    struct CESpan span;
     string work;
 
-    LOG_NRM("The CQ's metrics before reaping holds head_ptr");
-    struct nvme_gen_cq cqMetrics = cq->GetQMetrics();
-    KernelAPI::LogCQMetrics(cqMetrics);
-
-    LOG_NRM("Reaping CE from CQ %d, requires memory to hold CE", cq->GetQId());
-    SharedMemBufferPtr ceMem = SharedMemBufferPtr(new MemBuffer());
-    if ((numReaped = cq->Reap(ceRemain, ceMem, isrCount, numCE, true)) != 1) {
+    LOG_NRM("Reaping CE from CQ %d into its reap buffer", cq->GetQId());
+    if ((numReaped = cq->ReapSpan(ceRemain, span, isrCount, numCE)) != 1) {
         work = str(boost::format("Verified CE's exist, desired %d, reaped %d")
             % numCE % numReaped);
         cq->Dump(
@@ -140,7 +136,8 @@ IO::ReapCE(SharedCQPtr cq, uint32_t numCE, uint32_t &isrCount,
             work);
         throw FrmwkEx(HERE, work);
     }
-    union CE ce = cq->PeekCE(cqMetrics.head_ptr);
+    LOG_NRM("Reaped CE resided at CQ %d head_ptr %d", cq->GetQId(), span.head);
+    union CE ce = span.ce[0];
 
     if (status.empty()) {
         throw FrmwkEx(HERE,
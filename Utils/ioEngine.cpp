@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "ioEngine.h"
+#include "globals.h"
+
+
+IOEngine::IOEngine()
+{
+    throw FrmwkEx(HERE, "Illegal constructor");
+}
+
+
+IOEngine::IOEngine(SharedSQPtr sq, SharedCQPtr cq, uint32_t qDepth,
+    uint32_t ms)
+{
+    if ((sq == SQ::NullSQPtr) || (cq == CQ::NullCQPtr))
+        throw FrmwkEx(HERE, "Passing an uninitialized SQ or CQ");
+    else if (sq->GetCqId() != cq->GetQId())
+        throw FrmwkEx(HERE, "SQ %d does not complete into CQ %d",
+            sq->GetQId(), cq->GetQId());
+    else if (qDepth == 0)
+        throw FrmwkEx(HERE, "Queue depth must be >= 1");
+
+    // Per NVME spec: 1 empty element implies a full Q, can't truly fill all
+    mQDepth = MIN(qDepth, (sq->GetNumEntries() - 1));
+    mQDepth = MIN(mQDepth, (cq->GetNumEntries() - 1));
+    if (mQDepth != qDepth) {
+        LOG_NRM("Queue depth %d exceeds what SQ %d/CQ %d can hold, using %d",
+            qDepth, sq->GetQId(), cq->GetQId(), mQDepth);
+    }
+
+    mSQ = sq;
+    mCQ = cq;
+    mMs = ms;
+    mNumSubmitted = 0;
+    mNumCompleted = 0;
+}
+
+
+IOEngine::~IOEngine()
+{
+    if (mOutstanding.size()) {
+        LOG_WARN("Destroying IO engine with %ld cmds outstanding in SQ %d",
+            mOutstanding.size(), mSQ->GetQId());
+    }
+}
+
+
+void
+IOEngine::Submit(SharedCmdPtr cmd, CECallback callback)
+{
+    uint16_t uniqueId;
+    Outstanding pending;
+
+    while (mOutstanding.size() >= mQDepth)
+        Process();
+
+    pending.cmd = cmd;
+    pending.callback = callback;
+    clock_gettime(CLOCK_MONOTONIC, &pending.sent);
+
+    // dnvme only assigns the CID during Send(), which merely stages the cmd.
+    // The DUT can't see it until Ring(), so it must be recorded, and any
+    // duplicate CID rejected, before then. Logging every cmd would dominate
+    // the cost of keeping the queue depth, thus the quiet variants.
+    mSQ->SendQuiet(cmd, uniqueId);
+    if (mOutstanding.insert(make_pair(uniqueId, pending)).second == false) {
+        throw FrmwkEx(HERE, "CID 0x%04X is already outstanding in SQ %d",
+            uniqueId, mSQ->GetQId());
+    }
+    mSQ->RingQuiet();
+    mNumSubmitted++;
+}
+
+
+uint32_t
+IOEngine::Process()
+{
+    uint32_t numCE;
+    uint32_t isrCount;
+    uint32_t ceRemain;
+    struct CESpan span;
+
+    if (mOutstanding.empty())
+        return 0;
+
+    if (mCQ->ReapInquiryWaitAny(mMs, numCE, isrCount) == false) {
+        throw FrmwkEx(HERE, "No CE's arrived in CQ %d, %ld cmds outstanding",
+            mCQ->GetQId(), mOutstanding.size());
+    }
+
+    // Callbacks may Submit() and thus reap again, which reuses the CQ's reap
+    // buffer, so the CE's must be copied out of the span before completing.
+    mCQ->ReapSpan(ceRemain, span, isrCount, numCE);
+    vector<union CE> ces(span.ce, span.ce + span.num);
+    for (size_t i = 0; i < ces.size(); i++)
+        Complete(ces[i]);
+    return ces.size();
+}
+
+
+void
+IOEngine::Drain()
+{
+    while (mOutstanding.empty() == false)
+        Process();
+}
+
+
+void
+IOEngine::Complete(union CE &ce)
+{
+    struct timespec reaped;
+    if (ce.n.SQID != mSQ->GetQId()) {
+        throw FrmwkEx(HERE, "CE in CQ %d belongs to SQ %d, expected SQ %d",
+            mCQ->GetQId(), ce.n.SQID, mSQ->GetQId());
+    }
+
+    map<uint16_t, Outstanding>::iterator item = mOutstanding.find(ce.n.CID);
+    if (item == mOutstanding.end()) {
+        throw FrmwkEx(HERE, "CE with CID 0x%04X has no outstanding cmd",
+            ce.n.CID);
+    }
+
+    // Release the slot before the callback so it may submit more cmds
+    Outstanding done = item->second;
+    mOutstanding.erase(item);
+    mNumCompleted++;
+    if (done.callback) {
+        clock_gettime(CLOCK_MONOTONIC, &reaped);
+        uint64_t latency_us =
+            (((uint64_t)1000000 * (reaped.tv_sec - done.sent.tv_sec)) +
+            ((reaped.tv_nsec - done.sent.tv_nsec) / 1000));
+        done.callback(done.cmd, ce, latency_us);
+    }
+}
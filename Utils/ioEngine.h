@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _IOENGINE_H_
+#define _IOENGINE_H_
+
+#include <map>
+#include <time.h>
+#include <boost/function.hpp>
+#include "tnvme.h"
+#include "../Queues/ce.h"
+#include "../Queues/sq.h"
+#include "../Queues/cq.h"
+
+/**
+ * Callback invoked by IOEngine as each cmd completes.
+ * @param cmd Pass the cmd which completed
+ * @param ce Pass the CE which was reaped on behalf of the cmd
+ * @param latency_us Pass the usec from sending the cmd until reaping its CE
+ */
+typedef boost::function<void (SharedCmdPtr cmd, union CE &ce,
+    uint32_t latency_us)> CECallback;
+
+
+/**
+* This class keeps up to a configured queue depth of cmds outstanding against
+* a single IOSQ/IOCQ pair. Each reaped CE is matched back to the cmd which
+* caused it via the CID assigned by dnvme during SQ::Send(), then the cmd's
+* completion callback is invoked. Submissions block, reaping CE's, whenever
+* the queue depth is exhausted so the SQ can never be overrun.
+*
+* @note This class may throw exceptions.
+*/
+class IOEngine
+{
+public:
+    /**
+     * @param sq Pass pre-existing IOSQ to issue cmds into
+     * @param cq Pass pre-existing IOCQ which the IOSQ completes into, no
+     *        other SQ's should be completing into this CQ.
+     * @param qDepth Pass the max number of cmds to keep outstanding, it is
+     *        clamped to what both the SQ and CQ can hold.
+     * @param ms Pass the max number of ms to wait for any CE to arrive.
+     */
+    IOEngine(SharedSQPtr sq, SharedCQPtr cq, uint32_t qDepth, uint32_t ms);
+    virtual ~IOEngine();
+
+    /**
+     * Send a cmd and ring the SQ's doorbell. If the queue depth is exhausted
+     * then CE's are reaped and completed until room is available.
+     * @param cmd Pass the cmd to issue into the SQ
+     * @param callback Pass the function to invoke upon the cmd's completion
+     */
+    void Submit(SharedCmdPtr cmd, CECallback callback = CECallback());
+
+    /**
+     * Wait for any CE's to arrive, reap them, and complete their cmds.
+     * @return The number of cmds completed
+     */
+    uint32_t Process();
+
+    /// Process() until all outstanding cmds have completed
+    void Drain();
+
+    uint32_t GetQDepth() { return mQDepth; }
+    uint32_t GetNumOutstanding() { return mOutstanding.size(); }
+    uint64_t GetNumSubmitted() { return mNumSubmitted; }
+    uint64_t GetNumCompleted() { return mNumCompleted; }
+
+
+private:
+    IOEngine();
+
+    struct Outstanding {
+        SharedCmdPtr cmd;
+        CECallback callback;
+        struct timespec sent;
+    };
+
+    SharedSQPtr mSQ;
+    SharedCQPtr mCQ;
+    uint32_t mQDepth;
+    uint32_t mMs;
+    uint64_t mNumSubmitted;
+    uint64_t mNumCompleted;
+
+    /// Outstanding cmds indexed by the CID dnvme assigned them
+    map<uint16_t, Outstanding> mOutstanding;
+
+    /**
+     * Match a reaped CE to its outstanding cmd and complete it.
+     * @param ce Pass the CE which was reaped
+     */
+    void Complete(union CE &ce);
+};
+
+
+#endif
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <system_error>
+#include <boost/format.hpp>
+#include "ioWorker.h"
+#include "globals.h"
+
+std::atomic<bool> IOWorker::mAbort(false);
+
+
+IOWorker::IOWorker()
+{
+    throw FrmwkEx(HERE, "Illegal constructor");
+}
+
+
+IOWorker::IOWorker(SharedSQPtr sq, SharedCQPtr cq, uint32_t qDepth,
+    uint32_t ms, const vector<SharedCmdPtr> &cmds, uint64_t numCmds, int cpu,
+    int numaNode) :
+    IOWorker(sq, cq, qDepth, ms,
+        [cmds](uint64_t n) { return cmds[n % cmds.size()]; },
+        numCmds, 0, cpu, numaNode)
+{
+    if (cmds.empty())
+        throw FrmwkEx(HERE, "Worker requires >= 1 cmd to issue");
+}
+
+
+IOWorker::IOWorker(SharedSQPtr sq, SharedCQPtr cq, uint32_t qDepth,
+    uint32_t ms, CmdSource source, uint64_t numCmds, uint32_t duration_ms,
+    int cpu, int numaNode)
+{
+    if ((numCmds == 0) && (duration_ms == 0))
+        throw FrmwkEx(HERE, "Worker requires a limit on cmds or duration");
+
+    mSQ = sq;
+    mCQ = cq;
+    mQDepth = qDepth;
+    mMs = ms;
+    mSource = source;
+    mNumCmds = numCmds;
+    mDuration_ms = duration_ms;
+    mCpu = cpu;
+    mNumaNode = numaNode;
+    mFailed = false;
+}
+
+
+IOWorker::~IOWorker()
+{
+    // A running thread must never be destroyed, it would abort the app
+    if (mThread.joinable()) {
+        mAbort = true;
+        mThread.join();
+    }
+}
+
+
+void
+IOWorker::Start()
+{
+    if (mThread.joinable())
+        throw FrmwkEx(HERE, "Worker for SQ %d already started", mSQ->GetQId());
+
+    mStats = IOStats();
+    mFailed = false;
+    mFailure.clear();
+    mThread = std::thread(&IOWorker::Run, this);
+}
+
+
+void
+IOWorker::Join()
+{
+    if (mThread.joinable())
+        mThread.join();
+
+    if (mFailed) {
+        throw FrmwkEx(HERE, "Worker for SQ %d failed: %s", mSQ->GetQId(),
+            mFailure.c_str());
+    }
+}
+
+
+IOStats
+IOWorker::RunAll(vector<SharedIOWorkerPtr> &workers)
+{
+    IOStats merged = IOStats();
+    string failures;
+
+    // Throwing upon the main thread while any worker runs would dump and
+    // disable the DUT beneath it, so nothing may throw until all are joined
+    for (size_t i = 0; i < workers.size(); i++) {
+        if (workers[i]->mThread.joinable()) {
+            throw FrmwkEx(HERE, "Worker for SQ %d already started",
+                workers[i]->mSQ->GetQId());
+        }
+    }
+
+    mAbort = false;
+    try {
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i]->Start();
+    } catch (std::system_error &ex) {
+        mAbort = true;
+        failures = str(boost::format("Unable to spawn worker thread: %s; ") %
+            ex.what());
+    }
+
+    // Every worker must be joined before any failure is reported
+    for (size_t i = 0; i < workers.size(); i++) {
+        if (workers[i]->mThread.joinable())
+            workers[i]->mThread.join();
+        if (workers[i]->mFailed) {
+            failures += str(boost::format("SQ %d: %s; ") %
+                workers[i]->mSQ->GetQId() % workers[i]->mFailure);
+        }
+
+        const IOStats &stats = workers[i]->GetStats();
+        LOG_NRM("Worker SQ %d: submitted %ld, completed %ld, errors %ld, "
+            "%ld us", workers[i]->mSQ->GetQId(), stats.numSubmitted,
+            stats.numCompleted, stats.numErrors, stats.elapsed_us);
+        merged.numSubmitted += stats.numSubmitted;
+        merged.numCompleted += stats.numCompleted;
+        merged.numErrors += stats.numErrors;
+        merged.elapsed_us = MAX(merged.elapsed_us, stats.elapsed_us);
+        merged.latency_us.Merge(stats.latency_us);
+    }
+
+    if (failures.empty() == false)
+        throw FrmwkEx(HERE, "Workers failed: %s", failures.c_str());
+    return merged;
+}
+
+
+void
+IOWorker::Run()
+{
+    struct timespec initial;
+    struct timespec current;
+
+    try {
+        Pin();
+        IOEngine engine(mSQ, mCQ, mQDepth, mMs);
+        CECallback completed = [this](SharedCmdPtr cmd, union CE &ce,
+            uint32_t latency_us) { Completed(cmd, ce, latency_us); };
+
+        clock_gettime(CLOCK_MONOTONIC, &initial);
+        uint64_t duration_us = ((uint64_t)mDuration_ms * 1000);
+        for (uint64_t n = 0; (mNumCmds == 0) || (n < mNumCmds); n++) {
+            if (mAbort)
+                break;
+            if (duration_us) {
+                clock_gettime(CLOCK_MONOTONIC, &current);
+                if (CalcElapsed(initial, current) >= duration_us)
+                    break;
+            }
+            engine.Submit(mSource(n), completed);
+            mStats.numSubmitted++;
+        }
+        engine.Drain();
+        clock_gettime(CLOCK_MONOTONIC, &current);
+        mStats.elapsed_us = CalcElapsed(initial, current);
+    } catch (FrmwkEx &ex) {
+        mFailed = true;
+        mFailure = ex.GetMessage();
+        mAbort = true;
+    } catch (...) {
+        mFailed = true;
+        mFailure = "Unknown exception";
+        mAbort = true;
+    }
+}
+
+
+uint64_t
+IOWorker::CalcElapsed(struct timespec &initial, struct timespec &current)
+{
+    return (((uint64_t)1000000 * (current.tv_sec - initial.tv_sec)) +
+        ((current.tv_nsec - initial.tv_nsec) / 1000));
+}
+
+
+void
+IOWorker::Completed(SharedCmdPtr, union CE &ce, uint32_t latency_us)
+{
+    mStats.numCompleted++;
+    mStats.latency_us.Record(latency_us);
+    // Generic cmd status, successful completion; avoids logging every CE
+    if ((ce.n.SF.b.SCT != 0) || (ce.n.SF.b.SC != 0))
+        mStats.numErrors++;
+}
+
+
+void
+IOWorker::Pin()
+{
+    FILE *fp;
+    cpu_set_t cpus;
+    char path[64];
+
+    CPU_ZERO(&cpus);
+    if (mCpu >= 0) {
+        CPU_SET(mCpu, &cpus);
+    } else if (mNumaNode >= 0) {
+        // The node's cpulist is of the form "0-3,8-11"
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist",
+            mNumaNode);
+        if ((fp = fopen(path, "r")) == NULL)
+            throw FrmwkEx(HERE, "NUMA node %d is not present", mNumaNode);
+
+        int first, last;
+        while (fscanf(fp, "%d", &first) == 1) {
+            last = first;
+            int sep = fgetc(fp);
+            if ((sep == '-') && (fscanf(fp, "%d", &last) == 1))
+                sep = fgetc(fp);
+            for (int cpu = first; cpu <= last; cpu++)
+                CPU_SET(cpu, &cpus);
+            if (sep != ',')
+                break;
+        }
+        fclose(fp);
+    } else {
+        return;
+    }
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+        throw FrmwkEx(HERE, "Unable to pin worker for SQ %d (cpu %d, node %d)",
+            mSQ->GetQId(), mCpu, mNumaNode);
+    }
+    LOG_NRM("Pinned worker for SQ %d (cpu %d, node %d)", mSQ->GetQId(), mCpu,
+        mNumaNode);
+}
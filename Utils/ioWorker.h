@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _IOWORKER_H_
+#define _IOWORKER_H_
+
+#include <thread>
+#include <atomic>
+#include "ioEngine.h"
+#include "latency.h"
+
+class IOWorker;    // forward definition
+typedef boost::shared_ptr<IOWorker>         SharedIOWorkerPtr;
+
+/// Statistics gathered by an IOWorker, or merged across many of them
+struct IOStats {
+    uint64_t numSubmitted;
+    uint64_t numCompleted;
+    uint64_t numErrors;     // CE's not reporting successful completion
+    uint64_t elapsed_us;    // wall clock time; merged stats report the max
+    LatencyHist latency_us;     // completion latency of every cmd
+};
+
+/**
+ * Supplies an IOWorker with the cmds it is to issue. Since dnvme copies a
+ * cmd into the SQ during SQ::Send(), a source may modify and return the same
+ * cmd object it returned previously, e.g. to alter the starting LBA.
+ * @param n Pass the 0-based sequence number of the cmd about to be issued
+ * @return The cmd to issue
+ */
+typedef boost::function<SharedCmdPtr (uint64_t n)> CmdSource;
+
+
+/**
+* This class owns a single IOSQ/IOCQ pair and drives it from a dedicated
+* thread, optionally pinned to a CPU or to the CPU's of a NUMA node. The
+* framework is otherwise single threaded, so while workers run the main
+* thread must only wait within Join() or RunAll(), and each worker must have
+* exclusive use of its IOQ pair and of the cmds it is given. All cmds and
+* their buffers must be fully prepared before Start() is called.
+*
+* @note This class may throw exceptions.
+*/
+class IOWorker
+{
+public:
+    /**
+     * @param sq Pass pre-existing IOSQ to issue cmds into
+     * @param cq Pass pre-existing IOCQ which only the IOSQ completes into
+     * @param qDepth Pass the max number of cmds to keep outstanding
+     * @param ms Pass the max number of ms to wait for any CE to arrive.
+     * @param cmds Pass the cmds to issue, round robin, until numCmds are sent
+     * @param numCmds Pass the total number of cmds to issue
+     * @param cpu Pass the CPU to pin the worker upon, -1 for no pinning
+     * @param numaNode Pass the NUMA node to pin the worker within, -1 for
+     *        no pinning; ignored when a specific cpu is requested.
+     */
+    IOWorker(SharedSQPtr sq, SharedCQPtr cq, uint32_t qDepth, uint32_t ms,
+        const vector<SharedCmdPtr> &cmds, uint64_t numCmds, int cpu = -1,
+        int numaNode = -1);
+
+    /**
+     * @param sq Pass pre-existing IOSQ to issue cmds into
+     * @param cq Pass pre-existing IOCQ which only the IOSQ completes into
+     * @param qDepth Pass the max number of cmds to keep outstanding
+     * @param ms Pass the max number of ms to wait for any CE to arrive.
+     * @param source Pass the supplier of each cmd to issue; it is invoked
+     *        from the worker's thread.
+     * @param numCmds Pass the total number of cmds to issue, 0 for no limit
+     * @param duration_ms Pass the max number of ms to issue cmds, 0 for no
+     *        limit; at least 1 of numCmds or duration_ms must be a limit.
+     * @param cpu Pass the CPU to pin the worker upon, -1 for no pinning
+     * @param numaNode Pass the NUMA node to pin the worker within, -1 for
+     *        no pinning; ignored when a specific cpu is requested.
+     */
+    IOWorker(SharedSQPtr sq, SharedCQPtr cq, uint32_t qDepth, uint32_t ms,
+        CmdSource source, uint64_t numCmds, uint32_t duration_ms,
+        int cpu = -1, int numaNode = -1);
+    virtual ~IOWorker();
+
+    /// Spawn the thread which drives this worker's IOQ pair
+    void Start();
+
+    /**
+     * Wait for the worker's thread to finish.
+     * @note This method throws if the worker encountered an error
+     */
+    void Join();
+
+    const IOStats &GetStats() { return mStats; }
+
+    /**
+     * Start all workers, wait for all to finish, then merge their stats,
+     * including their latency histograms.
+     * @note This method throws if any worker encountered an error. Workers
+     *       only record their exceptions, which stops the others; once all
+     *       are joined the failures are rethrown upon the calling thread,
+     *       which alone dumps the state of the system and disables the DUT.
+     * @param workers Pass the workers to run concurrently
+     * @return The statistics summed across all workers
+     */
+    static IOStats RunAll(vector<SharedIOWorkerPtr> &workers);
+
+
+private:
+    IOWorker();
+
+    SharedSQPtr mSQ;
+    SharedCQPtr mCQ;
+    uint32_t mQDepth;
+    uint32_t mMs;
+    CmdSource mSource;
+    uint64_t mNumCmds;
+    uint32_t mDuration_ms;
+    int mCpu;
+    int mNumaNode;
+
+    std::thread mThread;
+    IOStats mStats;
+    bool mFailed;
+    string mFailure;
+
+    /// Set by any worker which fails so all others stop issuing cmds
+    static std::atomic<bool> mAbort;
+
+    /// The body of the worker's thread, never allowed to throw
+    void Run();
+
+    /// Pin the calling thread as requested by mCpu or mNumaNode
+    void Pin();
+
+    /// Returns the number of usec between 2 CLOCK_MONOTONIC times
+    static uint64_t CalcElapsed(struct timespec &initial,
+        struct timespec &current);
+
+    /// Completion callback for each cmd this worker issued
+    void Completed(SharedCmdPtr cmd, union CE &ce, uint32_t latency_us);
+};
+
+
+#endif
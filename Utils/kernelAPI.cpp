@@ -20,12 +20,91 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <boost/format.hpp>
 #include "kernelAPI.h"
 #include "globals.h"
 
 #define FILENAME_FLAGS         (O_RDWR | O_TRUNC | O_CREAT)
 #define FILENAME_MODE          (S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH)
 
+/// Accounting is indexed by the ioctl's command number, _IOC_NR(request)
+#define IOCTL_NR_MAX            (_IOC_NRMASK + 1)
+
+/**
+ * The accounting of a single ioctl request. Only the owning thread writes the
+ * fields, which are atomic so that LogIoctlStats() may read them meanwhile.
+ */
+struct IoctlStats {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> errors;
+    std::atomic<uint64_t> total_ns;
+    std::atomic<uint64_t> min_ns;
+    std::atomic<uint64_t> max_ns;
+    std::atomic<uint64_t> nBytes;
+};
+
+/// The accounting of every ioctl request issued by a single thread
+struct IoctlSlots {
+    IoctlStats stats[KernelAPI::IOCTLSCOPE_FENCE][IOCTL_NR_MAX];
+    std::atomic<uint32_t> testEpoch;    // IOCTLSCOPE_TEST is valid for this
+    std::atomic<bool> owned;            // Claimed by a live thread
+};
+
+/// Relinquishes a thread's slots for reuse by later threads upon its exit
+struct IoctlSlotsOwner {
+    IoctlSlots *slots;
+    IoctlSlotsOwner() : slots(NULL) {}
+    ~IoctlSlotsOwner() { if (slots) slots->owned = false; }
+};
+
+// IOWorker threads issue ioctl's concurrently, each accounts into its own
+// slots. Slots are never freed, threads which exit leave theirs, and what
+// they have accounted, for the next thread.
+static std::mutex slotsMutex;
+static vector<IoctlSlots *> ioctlSlots;
+static thread_local IoctlSlotsOwner slotsOwner;
+
+// ResetIoctlStats() advances the epoch rather than touching other threads'
+// slots, each thread restarts its own IOCTLSCOPE_TEST accounting upon noticing
+static std::atomic<uint32_t> testEpoch(0);
+
+// The trace is serialized only while it is open
+static std::mutex traceMutex;
+static std::atomic<FILE *> ioctlTrace(NULL);
+
+#define ZZ(request)     { request, #request },
+static const struct {
+    unsigned long request;
+    const char *name;
+} ioctlNames[] = {
+    ZZ(NVME_IOCTL_READ_GENERIC)
+    ZZ(NVME_IOCTL_WRITE_GENERIC)
+    ZZ(NVME_IOCTL_CREATE_ADMN_Q)
+    ZZ(NVME_IOCTL_DEVICE_STATE)
+    ZZ(NVME_IOCTL_GET_Q_METRICS)
+    ZZ(NVME_IOCTL_PREPARE_SQ_CREATION)
+    ZZ(NVME_IOCTL_PREPARE_CQ_CREATION)
+    ZZ(NVME_IOCTL_RING_SQ_DOORBELL)
+    ZZ(NVME_IOCTL_SEND_64B_CMD)
+    ZZ(NVME_IOCTL_DUMP_METRICS)
+    ZZ(NVME_IOCTL_REAP_INQUIRY)
+    ZZ(NVME_IOCTL_REAP)
+    ZZ(NVME_IOCTL_GET_DRIVER_METRICS)
+    ZZ(NVME_IOCTL_METABUF_CREATE)
+    ZZ(NVME_IOCTL_METABUF_ALLOC)
+    ZZ(NVME_IOCTL_METABUF_DELETE)
+    ZZ(NVME_IOCTL_SET_IRQ)
+    ZZ(NVME_IOCTL_GET_DEVICE_METRICS)
+    ZZ(NVME_IOCTL_MARK_SYSLOG)
+    ZZ(NVME_IOCTL_TOXIC_64B_DWORD)
+};
+#undef ZZ
+
 
 KernelAPI::KernelAPI()
 {
@@ -70,7 +149,7 @@ KernelAPI::DumpKernelMetrics(DumpFilename filename)
     struct nvme_file dumpMe = { (short unsigned int)filename.length(), filename.c_str() };
 
     LOG_NRM("Dump dnvme metrics to filename: %s", filename.c_str());
-    if ((rc = ioctl(gDutFd, NVME_IOCTL_DUMP_METRICS, &dumpMe)) < 0)
+    if ((rc = KernelAPI::ioctl(gDutFd, NVME_IOCTL_DUMP_METRICS, &dumpMe)) < 0)
         throw FrmwkEx(HERE, "Unable to dump dnvme metrics, err code = %d", rc);
 }
 
@@ -269,8 +348,238 @@ KernelAPI::WriteToDnvmeLog(string log)
     struct nvme_logstr logMe = { (short unsigned int)log.length(), log.c_str() };
 
     LOG_NRM("Write custom string to dnvme's log output: \"%s\"", log.c_str());
-    if ((rc = ioctl(gDutFd, NVME_IOCTL_MARK_SYSLOG, &logMe)) < 0) {
+    if ((rc = KernelAPI::ioctl(gDutFd, NVME_IOCTL_MARK_SYSLOG, &logMe)) < 0) {
         throw FrmwkEx(HERE, "Unable to log custom string to dnvme, err = %d",
             rc);
     }
 }
+
+
+/// Claim slots which no live thread owns, otherwise allocate zeroed slots
+static IoctlSlots *
+ClaimIoctlSlots()
+{
+    std::lock_guard<std::mutex> lock(slotsMutex);
+    for (size_t i = 0; i < ioctlSlots.size(); i++) {
+        if (ioctlSlots[i]->owned.exchange(true) == false)
+            return ioctlSlots[i];
+    }
+
+    IoctlSlots *slots = new (std::nothrow) IoctlSlots;
+    if (slots == NULL)
+        return NULL;
+    for (int scope = 0; scope < KernelAPI::IOCTLSCOPE_FENCE; scope++) {
+        for (int nr = 0; nr < IOCTL_NR_MAX; nr++) {
+            IoctlStats &stats = slots->stats[scope][nr];
+            stats.count = 0;
+            stats.errors = 0;
+            stats.total_ns = 0;
+            stats.min_ns = 0;
+            stats.max_ns = 0;
+            stats.nBytes = 0;
+        }
+    }
+    slots->testEpoch = testEpoch.load();
+    slots->owned = true;
+    ioctlSlots.push_back(slots);
+    return slots;
+}
+
+
+/// Accumulate an ioctl into stats, which only the calling thread writes
+static void
+Account(IoctlStats &stats, uint64_t delta_ns, uint64_t nBytes, bool error)
+{
+    const std::memory_order relaxed = std::memory_order_relaxed;
+    uint64_t count = stats.count.load(relaxed);
+
+    if ((count == 0) || (delta_ns < stats.min_ns.load(relaxed)))
+        stats.min_ns.store(delta_ns, relaxed);
+    if (delta_ns > stats.max_ns.load(relaxed))
+        stats.max_ns.store(delta_ns, relaxed);
+    stats.total_ns.store(stats.total_ns.load(relaxed) + delta_ns, relaxed);
+    stats.nBytes.store(stats.nBytes.load(relaxed) + nBytes, relaxed);
+    if (error)
+        stats.errors.store(stats.errors.load(relaxed) + 1, relaxed);
+    stats.count.store(count + 1, relaxed);
+}
+
+
+/// Zero stats, which only the calling thread writes
+static void
+Restart(IoctlStats &stats)
+{
+    const std::memory_order relaxed = std::memory_order_relaxed;
+    stats.count.store(0, relaxed);
+    stats.errors.store(0, relaxed);
+    stats.total_ns.store(0, relaxed);
+    stats.min_ns.store(0, relaxed);
+    stats.max_ns.store(0, relaxed);
+    stats.nBytes.store(0, relaxed);
+}
+
+
+int
+KernelAPI::ioctl(int fd, unsigned long request, void *arg, uint64_t nBytes)
+{
+    int rc;
+    int err;
+    struct timespec start;
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    rc = ::ioctl(fd, request, arg);
+    err = errno;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    uint64_t start_ns = (((uint64_t)1000000000 * start.tv_sec) + start.tv_nsec);
+    uint64_t end_ns = (((uint64_t)1000000000 * end.tv_sec) + end.tv_nsec);
+    uint64_t delta_ns = (end_ns - start_ns);
+
+    if (slotsOwner.slots == NULL)
+        slotsOwner.slots = ClaimIoctlSlots();
+    IoctlSlots *slots = slotsOwner.slots;
+    if (slots) {
+        uint32_t nr = _IOC_NR(request);
+        uint32_t epoch = testEpoch.load(std::memory_order_relaxed);
+        if (slots->testEpoch.load(std::memory_order_relaxed) != epoch) {
+            for (int i = 0; i < IOCTL_NR_MAX; i++)
+                Restart(slots->stats[IOCTLSCOPE_TEST][i]);
+            slots->testEpoch.store(epoch, std::memory_order_release);
+        }
+        for (int scope = 0; scope < IOCTLSCOPE_FENCE; scope++)
+            Account(slots->stats[scope][nr], delta_ns, nBytes, (rc < 0));
+    }
+
+    if (ioctlTrace.load(std::memory_order_relaxed)) {
+        struct IoctlTraceRec rec;
+        rec.start_ns = start_ns;
+        rec.nBytes = nBytes;
+        rec.duration_ns = MIN(delta_ns, (uint64_t)UINT32_MAX);
+        rec.request = request;
+        rec.rc = rc;
+        rec.reserved = 0;
+
+        std::lock_guard<std::mutex> lock(traceMutex);
+        FILE *fp = ioctlTrace.load(std::memory_order_relaxed);
+        if (fp)
+            fwrite(&rec, sizeof(rec), 1, fp);
+    }
+
+    errno = err;
+    return rc;
+}
+
+
+int
+KernelAPI::ioctl(int fd, unsigned long request, unsigned long arg)
+{
+    return ioctl(fd, request, (void *)arg);
+}
+
+
+void
+KernelAPI::ResetIoctlStats()
+{
+    testEpoch++;
+}
+
+
+void
+KernelAPI::LogIoctlStats(IoctlScope scope)
+{
+    // Merge every thread's slots, those which haven't issued an ioctl since
+    // the test started hold nothing for IOCTLSCOPE_TEST.
+    struct {
+        uint64_t count;
+        uint64_t errors;
+        uint64_t total_ns;
+        uint64_t min_ns;
+        uint64_t max_ns;
+        uint64_t nBytes;
+    } snapshot[IOCTL_NR_MAX];
+    memset(snapshot, 0, sizeof(snapshot));
+    {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        uint32_t epoch = testEpoch.load();
+        for (size_t i = 0; i < ioctlSlots.size(); i++) {
+            IoctlSlots *slots = ioctlSlots[i];
+            if ((scope == IOCTLSCOPE_TEST) &&
+                (slots->testEpoch.load(std::memory_order_acquire) != epoch)) {
+                continue;
+            }
+            for (int nr = 0; nr < IOCTL_NR_MAX; nr++) {
+                IoctlStats &stats = slots->stats[scope][nr];
+                uint64_t count = stats.count.load(std::memory_order_relaxed);
+                if (count == 0)
+                    continue;
+                uint64_t min_ns = stats.min_ns.load(std::memory_order_relaxed);
+                uint64_t max_ns = stats.max_ns.load(std::memory_order_relaxed);
+                if ((snapshot[nr].count == 0) || (min_ns < snapshot[nr].min_ns))
+                    snapshot[nr].min_ns = min_ns;
+                snapshot[nr].max_ns = MAX(snapshot[nr].max_ns, max_ns);
+                snapshot[nr].count += count;
+                snapshot[nr].errors += stats.errors.load();
+                snapshot[nr].total_ns += stats.total_ns.load();
+                snapshot[nr].nBytes += stats.nBytes.load();
+            }
+        }
+    }
+
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    LOG_NRM("dnvme ioctl summary since the %s started:",
+        (scope == IOCTLSCOPE_TEST) ? "test" : "app");
+    LOG_NRM("  %-32s %10s %6s %12s %10s %10s %12s", "ioctl", "count", "errs",
+        "total(us)", "min(ns)", "max(ns)", "bytes");
+    for (int nr = 0; nr < IOCTL_NR_MAX; nr++) {
+        if (snapshot[nr].count == 0)
+            continue;
+
+        string name = str(boost::format("_IOC_NR 0x%02X") % nr);
+        for (size_t i = 0; i < (sizeof(ioctlNames) / sizeof(ioctlNames[0]));
+            i++) {
+            if (_IOC_NR(ioctlNames[i].request) == (unsigned long)nr) {
+                name = ioctlNames[i].name;
+                break;
+            }
+        }
+
+        LOG_NRM("  %-32s %10ld %6ld %12ld %10ld %10ld %12ld", name.c_str(),
+            snapshot[nr].count, snapshot[nr].errors,
+            (snapshot[nr].total_ns / 1000), snapshot[nr].min_ns,
+            snapshot[nr].max_ns, snapshot[nr].nBytes);
+        count += snapshot[nr].count;
+        total_ns += snapshot[nr].total_ns;
+    }
+    LOG_NRM("  %ld ioctl's spent %ld us within the kernel", count,
+        (total_ns / 1000));
+}
+
+
+bool
+KernelAPI::OpenIoctlTrace(string filename)
+{
+    CloseIoctlTrace();
+
+    FILE *fp;
+    if ((fp = fopen(filename.c_str(), "w")) == NULL) {
+        LOG_ERR("file=%s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+    fwrite(IOCTL_TRACE_MAGIC, strlen(IOCTL_TRACE_MAGIC), 1, fp);
+
+    std::lock_guard<std::mutex> lock(traceMutex);
+    ioctlTrace = fp;
+    return true;
+}
+
+
+void
+KernelAPI::CloseIoctlTrace()
+{
+    std::lock_guard<std::mutex> lock(traceMutex);
+    FILE *fp = ioctlTrace.exchange(NULL);
+    if (fp)
+        fclose(fp);
+}
@@ -23,6 +23,19 @@
 #include "../Singletons/regDefs.h"
 
 
+#define IOCTL_TRACE_MAGIC       "TNVMEIOC"
+
+/// A single record within the binary trace of ioctl's
+struct IoctlTraceRec {
+    uint64_t start_ns;      // CLOCK_MONOTONIC when the ioctl was issued
+    uint64_t nBytes;        // payload moved, see KernelAPI::ioctl()
+    uint32_t duration_ns;
+    uint32_t request;
+    int32_t  rc;
+    uint32_t reserved;
+} __attribute__((__packed__));
+
+
 /**
 * This class is meant not be instantiated because it should only ever contain
 * static members. These utility functions can be viewed as wrappers to
@@ -89,6 +102,46 @@ public:
      */
     static void WriteToDnvmeLog(string log);
 
+    /**
+     * The sole dispatch point for every ioctl into dnvme. Each call is timed
+     * and accounted per ioctl request, and optionally traced to a file.
+     * @note This method never throws, errno is preserved for the caller
+     * @param fd Pass the file descriptor of the DUT
+     * @param request Pass the NVME_IOCTL_* request
+     * @param arg Pass the argument of the request
+     * @param nBytes Pass the number of payload bytes the request moves
+     *        between user space and dnvme/hdw, beyond its argument
+     * @return The return value of ::ioctl()
+     */
+    static int ioctl(int fd, unsigned long request, void *arg,
+        uint64_t nBytes = 0);
+    static int ioctl(int fd, unsigned long request, unsigned long arg);
+
+    typedef enum {
+        IOCTLSCOPE_TEST,    // Accounting since the current test started
+        IOCTLSCOPE_RUN,     // Accounting since the app started
+        IOCTLSCOPE_FENCE    // always must be last element
+    } IoctlScope;
+
+    /// Restart the per test ioctl accounting
+    static void ResetIoctlStats();
+
+    /**
+     * Log a summary of the ioctl accounting: the call count, total/min/max
+     * time and bytes moved for each ioctl request which was issued.
+     * @param scope Pass which accounting to summarize
+     */
+    static void LogIoctlStats(IoctlScope scope);
+
+    /**
+     * Start writing a binary trace record for every ioctl issued. The file
+     * begins with IOCTL_TRACE_MAGIC followed by IoctlTraceRec's.
+     * @param filename Pass the file to create, or truncate if it exists
+     * @return true upon success, otherwise false
+     */
+    static bool OpenIoctlTrace(string filename);
+    static void CloseIoctlTrace();
+
 
 private:
     static void RegToFile(int fd, const PciSpcType regMetrics, uint64_t value);
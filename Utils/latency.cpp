@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "latency.h"
+#include "binDump.h"
+#include "../Exception/frmwkEx.h"
+#include "../Cmds/cmd.h"
+
+#define LATENCY_NUM_SQS         65536   // every possible 16 bit SQ ID
+#define LATENCY_NUM_OPCODES     256
+
+/// A cmd which has been sent, and possibly rung, but not yet reaped
+struct LatencyPending {
+    uint16_t cid;
+    uint8_t opcode;
+    bool valid;             // sent but not yet reaped
+    bool rung;
+    struct timespec rungAt;
+};
+
+/// All latency tracking pertaining to a single SQ
+struct LatencySQ {
+    LatencySQ() {
+        mask = 0;
+        memset(hists, 0, sizeof(hists));
+    }
+    ~LatencySQ() {
+        for (int i = 0; i < LATENCY_NUM_OPCODES; i++)
+            delete hists[i];
+    }
+
+    vector<LatencyPending> pending;         // indexed by (CID & mask)
+    uint32_t mask;
+    vector<uint16_t> staged;                // CID's sent but not yet rung
+    LatencyHist *hists[LATENCY_NUM_OPCODES];    // created upon 1st send
+    string names[LATENCY_NUM_OPCODES];
+};
+
+// Indexed by SQ ID. IOWorker gives each thread exclusive use of its IOQ
+// pair and the main thread only reports once all workers are joined, thus
+// no SQ's state is ever touched by 2 threads at once and nothing is locked.
+static LatencySQ *latencySQs[LATENCY_NUM_SQS];
+
+
+LatencyHist::LatencyHist()
+{
+    memset(mBuckets, 0, sizeof(mBuckets));
+    mCount = 0;
+    mMin = 0;
+    mMax = 0;
+    mSum = 0;
+}
+
+
+LatencyHist::~LatencyHist()
+{
+}
+
+
+uint32_t
+LatencyHist::ValueToBucket(uint64_t value)
+{
+    if (value < LATHIST_SUB_BUCKETS)
+        return value;
+
+    // Position of the MSB selects the power of 2, the following bits the sub
+    uint32_t msb = (63 - __builtin_clzll(value));
+    uint32_t shift = (msb - LATHIST_SUB_BITS);
+    uint32_t sub = ((value >> shift) - LATHIST_SUB_BUCKETS);
+    return (LATHIST_SUB_BUCKETS + (shift * LATHIST_SUB_BUCKETS) + sub);
+}
+
+
+uint64_t
+LatencyHist::BucketToValue(uint32_t bucket)
+{
+    if (bucket < LATHIST_SUB_BUCKETS)
+        return bucket;
+
+    uint32_t shift = ((bucket - LATHIST_SUB_BUCKETS) / LATHIST_SUB_BUCKETS);
+    uint32_t sub = ((bucket - LATHIST_SUB_BUCKETS) % LATHIST_SUB_BUCKETS);
+    return ((uint64_t)(LATHIST_SUB_BUCKETS + sub) << shift);
+}
+
+
+void
+LatencyHist::Record(uint64_t value)
+{
+    mBuckets[ValueToBucket(value)]++;
+    if ((mCount == 0) || (value < mMin))
+        mMin = value;
+    if (value > mMax)
+        mMax = value;
+    mSum += value;
+    mCount++;
+}
+
+
+void
+LatencyHist::Merge(const LatencyHist &other)
+{
+    if (other.mCount == 0)
+        return;
+
+    for (uint32_t i = 0; i < LATHIST_NUM_BUCKETS; i++)
+        mBuckets[i] += other.mBuckets[i];
+    if ((mCount == 0) || (other.mMin < mMin))
+        mMin = other.mMin;
+    if (other.mMax > mMax)
+        mMax = other.mMax;
+    mSum += other.mSum;
+    mCount += other.mCount;
+}
+
+
+uint64_t
+LatencyHist::GetPercentile(double percentile) const
+{
+    if (mCount == 0)
+        return 0;
+
+    uint64_t target = (uint64_t)((percentile / 100.0) * mCount);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LATHIST_NUM_BUCKETS; i++) {
+        seen += mBuckets[i];
+        if (seen > target)
+            return MAX(BucketToValue(i), mMin);
+    }
+    return mMax;
+}
+
+
+double
+LatencyHist::GetMean() const
+{
+    return (mCount ? ((double)mSum / mCount) : 0.0);
+}
+
+
+void
+LatencyHist::Dump(FILE *fp) const
+{
+    const double percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+
+    fprintf(fp, "  samples=%ld, min=%ld, avg=%.1f, max=%ld\n", mCount, mMin,
+        GetMean(), mMax);
+    for (size_t i = 0; i < (sizeof(percentiles) / sizeof(percentiles[0])); i++)
+        fprintf(fp, "  p%-6.2f = %ld\n", percentiles[i],
+            GetPercentile(percentiles[i]));
+
+    fprintf(fp, "  buckets (lower bound: count):\n");
+    for (uint32_t i = 0; i < LATHIST_NUM_BUCKETS; i++) {
+        if (mBuckets[i])
+            fprintf(fp, "    %12ld: %ld\n", BucketToValue(i), mBuckets[i]);
+    }
+}
+
+
+Latency::Latency()
+{
+}
+
+
+Latency::~Latency()
+{
+}
+
+
+void
+Latency::Sent(uint16_t sqId, uint32_t sqSize, uint16_t cid, const Cmd &cmd)
+{
+    LatencySQ *sq = latencySQs[sqId];
+    if (sq == NULL)
+        sq = latencySQs[sqId] = new LatencySQ();
+
+    // dnvme assigns CID's sequentially per SQ and the SQ holds fewer than
+    // sqSize cmds, so outstanding CID's never collide within the table
+    if (sq->pending.size() < sqSize) {
+        uint32_t size = 1;
+        while (size < sqSize)
+            size <<= 1;
+        sq->pending.assign(size, LatencyPending());
+        sq->mask = (size - 1);
+        sq->staged.clear();
+        sq->staged.reserve(size);
+    }
+
+    uint8_t opcode = cmd.GetOpcode();
+    LatencyPending &pending = sq->pending[cid & sq->mask];
+    pending.cid = cid;
+    pending.opcode = opcode;
+    pending.valid = true;
+    pending.rung = false;
+    sq->staged.push_back(cid);
+    if (sq->hists[opcode] == NULL) {
+        sq->hists[opcode] = new LatencyHist();
+        sq->names[opcode] = cmd.GetName();
+    }
+}
+
+
+void
+Latency::Rung(uint16_t sqId)
+{
+    struct timespec now;
+    LatencySQ *sq = latencySQs[sqId];
+
+    if (sq == NULL)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (size_t i = 0; i < sq->staged.size(); i++) {
+        LatencyPending &pending = sq->pending[sq->staged[i] & sq->mask];
+        if (pending.valid && (pending.cid == sq->staged[i])) {
+            pending.rung = true;
+            pending.rungAt = now;
+        }
+    }
+    sq->staged.clear();
+}
+
+
+void
+Latency::Reaped(const uint8_t *ceBuf, uint16_t entrySize, uint32_t numCE,
+    const struct timespec &detected)
+{
+    for (uint32_t i = 0; i < numCE; i++, ceBuf += entrySize) {
+        const union CE *ce = (const union CE *)ceBuf;
+
+        // CE's of cmds sent prior to the last Reset() can't be matched
+        LatencySQ *sq = latencySQs[ce->n.SQID];
+        if ((sq == NULL) || sq->pending.empty())
+            continue;
+        LatencyPending &pending = sq->pending[ce->n.CID & sq->mask];
+        if ((pending.valid == false) || (pending.cid != ce->n.CID))
+            continue;
+
+        if (pending.rung) {
+            uint64_t ns =
+                (((uint64_t)1000000000 *
+                (detected.tv_sec - pending.rungAt.tv_sec)) +
+                (detected.tv_nsec - pending.rungAt.tv_nsec));
+            sq->hists[pending.opcode]->Record(ns);
+        }
+        pending.valid = false;
+    }
+}
+
+
+LatencyHist
+Latency::GetHist(uint16_t sqId, uint8_t opcode)
+{
+    LatencySQ *sq = latencySQs[sqId];
+
+    if ((sq != NULL) && (sq->hists[opcode] != NULL))
+        return *sq->hists[opcode];
+    return LatencyHist();
+}
+
+
+void
+Latency::Reset()
+{
+    for (uint32_t i = 0; i < LATENCY_NUM_SQS; i++) {
+        delete latencySQs[i];
+        latencySQs[i] = NULL;
+    }
+}
+
+
+void
+Latency::Dump(DumpFilename filename, string fileHdr)
+{
+    FILE *fp;
+    char *text = NULL;
+    size_t textLen = 0;
+    vector<LatencyHist> merged(LATENCY_NUM_OPCODES);
+    string names[LATENCY_NUM_OPCODES];
+    uint32_t numSQs[LATENCY_NUM_OPCODES];
+    bool recorded = false;
+
+    // Each SQ recorded into its own histograms, only now are they merged
+    memset(numSQs, 0, sizeof(numSQs));
+    for (uint32_t i = 0; i < LATENCY_NUM_SQS; i++) {
+        if (latencySQs[i] == NULL)
+            continue;
+        for (uint32_t op = 0; op < LATENCY_NUM_OPCODES; op++) {
+            LatencyHist *hist = latencySQs[i]->hists[op];
+            if ((hist == NULL) || (hist->GetCount() == 0))
+                continue;
+            merged[op].Merge(*hist);
+            names[op] = latencySQs[i]->names[op];
+            numSQs[op]++;
+            recorded = true;
+        }
+    }
+    if (recorded == false)
+        return;
+
+    // Rendered in memory so it can also become a frame, see class BinDump
+    if ((fp = open_memstream(&text, &textLen)) == NULL) {
+        LOG_ERR("Failed to render cmd latency histograms");
+        return;
+    }
+
+    fprintf(fp, "Latency in nsec from ringing SQ doorbell to CE detection\n");
+    for (uint32_t i = 0; i < LATENCY_NUM_SQS; i++) {
+        if (latencySQs[i] == NULL)
+            continue;
+        for (uint32_t op = 0; op < LATENCY_NUM_OPCODES; op++) {
+            LatencyHist *hist = latencySQs[i]->hists[op];
+            if ((hist == NULL) || (hist->GetCount() == 0))
+                continue;
+            fprintf(fp, "\nSQ %d, opcode 0x%02X (%s):\n", i, op,
+                latencySQs[i]->names[op].c_str());
+            hist->Dump(fp);
+        }
+    }
+
+    // Opcodes issued to more than 1 SQ are also reported across all SQ's
+    for (uint32_t op = 0; op < LATENCY_NUM_OPCODES; op++) {
+        if (numSQs[op] < 2)
+            continue;
+        fprintf(fp, "\nAll %d SQ's, opcode 0x%02X (%s):\n", numSQs[op], op,
+            names[op].c_str());
+        merged[op].Dump(fp);
+    }
+    fclose(fp);
+
+    // The flight recorder and the dump archive decide where frames end up
+    if (BinDump::IsFramed()) {
+        try {
+            BinDump::Write(filename, BINDUMP_TEXT, 0, 0, (uint8_t *)text,
+                textLen, fileHdr);
+        } catch (FrmwkEx &ex) {
+            LOG_ERR("Failed to dump cmd latency histograms");
+        }
+        free(text);
+        return;
+    }
+
+    LOG_NRM("Dump cmd latency histograms to filename: %s", filename.c_str());
+    if ((fp = fopen(filename.c_str(), "w")) == NULL) {
+        LOG_ERR("Failed to open file: %s", filename.c_str());
+        free(text);
+        return;
+    }
+    fprintf(fp, "%s\n", fileHdr.c_str());
+    fwrite(text, 1, textLen, fp);
+    fclose(fp);
+    free(text);
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include <time.h>
+#include "tnvme.h"
+#include "fileSystem.h"
+#include "../Queues/ce.h"
+
+class Cmd;      // forward definition
+
+#define LATHIST_SUB_BITS        4       // 16 sub-buckets per power of 2
+#define LATHIST_SUB_BUCKETS     (1 << LATHIST_SUB_BITS)
+#define LATHIST_NUM_BUCKETS     \
+    (LATHIST_SUB_BUCKETS + ((64 - LATHIST_SUB_BITS) * LATHIST_SUB_BUCKETS))
+
+
+/**
+* A log bucketed latency histogram in the spirit of HdrHistogram. Each power
+* of 2 range of values is split into LATHIST_SUB_BUCKETS linear buckets, so
+* any recorded value is accurate to within ~6% while recording is O(1) and
+* the storage is a fixed size regardless of the number of samples.
+*/
+class LatencyHist
+{
+public:
+    LatencyHist();
+    virtual ~LatencyHist();
+
+    /// Record a single sample, units are up to the caller
+    void Record(uint64_t value);
+
+    /// Add all samples of another histogram into this one
+    void Merge(const LatencyHist &other);
+
+    /**
+     * @param percentile Pass [0.0 to 100.0]
+     * @return The lower bound of the bucket containing the percentile
+     */
+    uint64_t GetPercentile(double percentile) const;
+
+    uint64_t GetCount() const { return mCount; }
+    uint64_t GetMin() const { return mMin; }
+    uint64_t GetMax() const { return mMax; }
+    double   GetMean() const;
+
+    /// Write a summary and every non-empty bucket to fp
+    void Dump(FILE *fp) const;
+
+
+private:
+    uint64_t mBuckets[LATHIST_NUM_BUCKETS];
+    uint64_t mCount;
+    uint64_t mMin;
+    uint64_t mMax;
+    uint64_t mSum;
+
+    static uint32_t ValueToBucket(uint64_t value);
+    static uint64_t BucketToValue(uint32_t bucket);
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It records the latency, in nsec, of every cmd from the time
+* its SQ's doorbell is rung until its CE is detected by the CQ, into a
+* LatencyHist per SQ and per opcode. The framework resets the histograms
+* before each test and dumps them after each test.
+*
+* Each SQ's state is only touched by the thread driving that SQ, so recording
+* never locks. GetHist(), Reset() and Dump() must only be called while no
+* IOWorker is running.
+*
+* @note This class never throws, it must not alter the outcome of a test.
+*/
+class Latency
+{
+public:
+    Latency();
+    virtual ~Latency();
+
+    /**
+     * Note a cmd which was just placed into a SQ, but not yet rung.
+     * @param sqId Pass the ID of the SQ the cmd was sent to
+     * @param sqSize Pass the number of entries within that SQ
+     * @param cid Pass the cmd's unique ID as assigned by dnvme
+     * @param cmd Pass the cmd
+     */
+    static void Sent(uint16_t sqId, uint32_t sqSize, uint16_t cid,
+        const Cmd &cmd);
+
+    /**
+     * Note the doorbell of a SQ was just rung, starting the clock for every
+     * cmd sent since the previous ring.
+     * @param sqId Pass the ID of the SQ
+     */
+    static void Rung(uint16_t sqId);
+
+    /**
+     * Record the latency of each cmd which caused a reaped CE.
+     * @param ceBuf Pass the 1st reaped CE
+     * @param entrySize Pass the number of bytes between successive CE's
+     * @param numCE Pass the number of CE's reaped
+     * @param detected Pass the CLOCK_MONOTONIC time the CE's were detected
+     */
+    static void Reaped(const uint8_t *ceBuf, uint16_t entrySize,
+        uint32_t numCE, const struct timespec &detected);
+
+    /**
+     * @param sqId Pass the ID of the SQ
+     * @param opcode Pass the opcode of interest
+     * @return A copy of the histogram, which is empty if nothing was recorded
+     */
+    static LatencyHist GetHist(uint16_t sqId, uint8_t opcode);
+
+    /// Forget all cmds and recorded latencies
+    static void Reset();
+
+    /**
+     * Dump every histogram which recorded samples. Nothing is written when
+     * no samples were recorded. The text becomes a single BINDUMP_TEXT frame
+     * whenever BinDump::IsFramed(), thus the flight recorder and the dump
+     * archive apply to it as they do to every other dump.
+     * @param filename Pass the filename as generated by macro
+     *      FileSystem::PrepDumpFile().
+     * @param fileHdr Pass a custom file header description to dump
+     */
+    static void Dump(DumpFilename filename, string fileHdr);
+};
+
+
+#endif
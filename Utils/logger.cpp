@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sched.h>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "logger.h"
+
+using namespace std;
+
+/// Log text larger than this bypasses the rings and is written directly
+#define LOG_MAX_QUEUED          (LOG_RING_SIZE / 4)
+/// LogRec::len value marking the remainder of a ring as unused
+#define LOGREC_WRAP             0xffffffff
+
+/// The header preceding each statement's text within a ring
+struct LogRec {
+    uint64_t seq;
+    uint32_t len;
+    uint32_t rsvd;
+};
+
+/// A single producer, single consumer ring of LogRec's, 1 per logging thread
+struct LogRing {
+    char buf[LOG_RING_SIZE] __attribute__((aligned(sizeof(LogRec))));
+    std::atomic<uint64_t> head;     // Advanced by the owning thread only
+    std::atomic<uint64_t> tail;     // Advanced by the writer only
+    std::atomic<bool> owned;        // Claimed by a live thread
+};
+
+/// Relinquishes a thread's ring for reuse by later threads upon its exit
+struct LogRingOwner {
+    LogRing *ring;
+    LogRingOwner() : ring(NULL) {}
+    ~LogRingOwner() { if (ring) ring->owned = false; }
+};
+
+std::atomic<int> Logger::mVerbosity(LOGLVL_DBG);
+
+// Rings are never freed, threads which exit leave theirs for the next thread
+static std::mutex ringMutex;
+static vector<LogRing *> rings;
+static thread_local LogRingOwner ringOwner;
+
+static std::atomic<bool> running(false);
+static std::atomic<bool> stopping(false);
+static std::atomic<uint64_t> nextSeq(0);    // Next seq to give a statement
+static uint64_t writeSeq = 0;               // Next seq for the writer to emit
+static std::thread writer;
+
+// Guards the writer's sleep, flush requests and its progress reporting
+static std::mutex writerMutex;
+static std::condition_variable writerCond;
+static std::condition_variable flushedCond;
+static bool flushReq = false;
+static uint64_t written = 0;
+
+// Serializes all writes to stderr
+static std::mutex stderrMutex;
+
+
+Logger::Logger()
+{
+}
+
+
+Logger::~Logger()
+{
+}
+
+
+/// Round a statement's length up to the space its LogRec consumes in a ring
+static uint32_t
+RecSize(uint32_t len)
+{
+    return (sizeof(LogRec) + len + sizeof(LogRec) - 1) & ~(sizeof(LogRec) - 1);
+}
+
+
+static void
+WriteStderr(const char *text, size_t len)
+{
+    std::lock_guard<std::mutex> lock(stderrMutex);
+    fwrite(text, 1, len, stderr);
+    fflush(stderr);
+}
+
+
+static LogRing *
+ClaimRing()
+{
+    std::lock_guard<std::mutex> lock(ringMutex);
+    for (size_t i = 0; i < rings.size(); i++) {
+        if (rings[i]->owned.exchange(true) == false)
+            return rings[i];
+    }
+
+    LogRing *ring = new (std::nothrow) LogRing;
+    if (ring == NULL)
+        return NULL;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->owned = true;
+    rings.push_back(ring);
+    return ring;
+}
+
+
+/**
+ * Queue a statement into the calling thread's ring.
+ * @return false if the statement could not be queued and must be written
+ */
+static bool
+Enqueue(const char *text, uint32_t len)
+{
+    if (ringOwner.ring == NULL) {
+        if ((ringOwner.ring = ClaimRing()) == NULL)
+            return false;
+    }
+    LogRing *ring = ringOwner.ring;
+
+    // A statement never straddles the end of the ring, skip to the start
+    uint32_t need = RecSize(len);
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint32_t offset = (head & (LOG_RING_SIZE - 1));
+    uint32_t toEnd = (LOG_RING_SIZE - offset);
+    uint64_t total = (toEnd < need) ? (toEnd + need) : need;
+
+    while ((head + total -
+        ring->tail.load(std::memory_order_acquire)) > LOG_RING_SIZE) {
+        writerCond.notify_one();
+        sched_yield();
+    }
+    if (toEnd < need) {
+        ((LogRec *)(ring->buf + offset))->len = LOGREC_WRAP;
+        head += toEnd;
+        offset = 0;
+    }
+
+    // The seq is taken only once space is guaranteed, thus the writer never
+    // waits long on a seq which has been taken but is not yet visible.
+    LogRec *rec = (LogRec *)(ring->buf + offset);
+    rec->seq = nextSeq.fetch_add(1);
+    rec->len = len;
+    memcpy(ring->buf + offset + sizeof(LogRec), text, len);
+    ring->head.store(head + need, std::memory_order_release);
+
+    if ((head + need - ring->tail.load(std::memory_order_relaxed)) >
+        (LOG_RING_SIZE / 2)) {
+        writerCond.notify_one();
+    }
+    return true;
+}
+
+
+/// Returns the oldest statement within a ring, otherwise NULL
+static LogRec *
+Peek(LogRing *ring)
+{
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    if (tail == head)
+        return NULL;
+
+    LogRec *rec = (LogRec *)(ring->buf + (tail & (LOG_RING_SIZE - 1)));
+    if (rec->len == LOGREC_WRAP) {
+        tail += (LOG_RING_SIZE - (tail & (LOG_RING_SIZE - 1)));
+        ring->tail.store(tail, std::memory_order_release);
+        if (tail == head)
+            return NULL;
+        rec = (LogRec *)ring->buf;
+    }
+    return rec;
+}
+
+
+/**
+ * Write every statement which is queued, in seq order, to stderr.
+ * @param pending Returns whether statements remain which could not be
+ *        written because an earlier seq is not yet visible
+ * @return true if any statement was written
+ */
+static bool
+Drain(bool &pending)
+{
+    string out;
+    bool progress = false;
+
+    std::unique_lock<std::mutex> lock(ringMutex);
+    while (true) {
+        LogRing *found = NULL;
+        LogRec *rec = NULL;
+
+        pending = false;
+        for (size_t i = 0; (i < rings.size()) && (found == NULL); i++) {
+            if ((rec = Peek(rings[i])) == NULL)
+                continue;
+            pending = true;
+            if (rec->seq == writeSeq)
+                found = rings[i];
+        }
+        if (found == NULL)
+            break;
+
+        out.append((char *)rec + sizeof(LogRec), rec->len);
+        found->tail.fetch_add(RecSize(rec->len), std::memory_order_release);
+        writeSeq++;
+        progress = true;
+        pending = false;
+
+        if (out.size() >= LOG_MAX_QUEUED) {
+            WriteStderr(out.data(), out.size());
+            out.clear();
+        }
+    }
+    lock.unlock();
+
+    if (out.size())
+        WriteStderr(out.data(), out.size());
+
+    if (progress) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        written = writeSeq;
+        flushedCond.notify_all();
+    }
+    return progress;
+}
+
+
+static void
+Writer()
+{
+    bool pending;
+
+    while (true) {
+        if (Drain(pending))
+            continue;
+
+        if (pending) {
+            // Some thread has taken a seq and is about to make it visible
+            sched_yield();
+        } else if (stopping) {
+            break;
+        } else {
+            std::unique_lock<std::mutex> lock(writerMutex);
+            writerCond.wait_for(lock, std::chrono::milliseconds(LOG_DRAIN_ms),
+                [] { return (flushReq || stopping); });
+            flushReq = false;
+        }
+    }
+}
+
+
+void
+Logger::Start()
+{
+    if (running)
+        return;
+
+    stopping = false;
+    writeSeq = nextSeq;
+    written = writeSeq;
+    writer = std::thread(Writer);
+    running = true;
+
+    static bool registered = false;
+    if (registered == false) {
+        atexit(Logger::Stop);
+        registered = true;
+    }
+}
+
+
+void
+Logger::Stop()
+{
+    if (running == false)
+        return;
+
+    // Statements may still be queued as the writer exits, drain those too
+    bool pending;
+    stopping = true;
+    writerCond.notify_one();
+    writer.join();
+    while (Drain(pending) || pending)
+        ;
+
+    std::lock_guard<std::mutex> lock(writerMutex);
+    running = false;
+    flushedCond.notify_all();
+}
+
+
+void
+Logger::Flush()
+{
+    if ((running == false) || (std::this_thread::get_id() == writer.get_id()))
+        return;
+
+    uint64_t target = nextSeq;
+    std::unique_lock<std::mutex> lock(writerMutex);
+    flushReq = true;
+    writerCond.notify_one();
+    flushedCond.wait(lock,
+        [target] { return ((written >= target) || (running == false)); });
+}
+
+
+void
+Logger::Log(LogLevel level, const char *fmt, ...)
+{
+    char work[1024];
+    char *text = work;
+    va_list arg;
+    int len;
+
+    if (level > mVerbosity.load(std::memory_order_relaxed))
+        return;
+
+    va_start(arg, fmt);
+    len = vsnprintf(work, sizeof(work), fmt, arg);
+    va_end(arg);
+    if (len < 0)
+        return;
+
+    if ((size_t)len >= sizeof(work)) {
+        if ((text = (char *)malloc(len + 1)) == NULL)
+            return;
+        va_start(arg, fmt);
+        vsnprintf(text, (len + 1), fmt, arg);
+        va_end(arg);
+    }
+
+    Write(level, text, len);
+
+    if (text != work)
+        free(text);
+}
+
+
+void
+Logger::Write(LogLevel level, const char *text, size_t len)
+{
+    if (level > mVerbosity.load(std::memory_order_relaxed))
+        return;
+
+    if ((running == false) || (len > LOG_MAX_QUEUED) ||
+        (Enqueue(text, len) == false)) {
+        Flush();
+        WriteStderr(text, len);
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _LOGGER_H_
+#define _LOGGER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/// Bytes of log text each thread may queue before it must wait on the writer
+#define LOG_RING_SIZE               (1024 * 1024)
+/// Max ms the writer sleeps before draining queued log text
+#define LOG_DRAIN_ms                2
+
+typedef enum {
+    LOGLVL_ERR,         // LOG_ERR only
+    LOGLVL_WARN,        // LOG_ERR and LOG_WARN
+    LOGLVL_NRM,         // LOG_ERR, LOG_WARN and LOG_NRM
+    LOGLVL_DBG,         // All, LOG_DBG requires compiling with -DDEBUG
+    LOGLVL_FENCE        // always must be last element
+} LogLevel;
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It is the backend of the LOG_* macros. Until Start() is
+* called, and after Stop(), log text is written directly to stderr. While
+* started each thread formats its log text into its own lock free ring, and a
+* background thread drains all rings to stderr. Every log statement is given
+* a global sequence number, and the writer emits statements in exactly that
+* order, so the output is identical to that of direct writes.
+*
+* A crash may lose up to LOG_DRAIN_ms worth of queued log text; Flush() is
+* called wherever output must be complete, e.g. as FrmwkEx dumps the state of
+* the system.
+*
+* @note This class will not throw exceptions.
+*/
+class Logger
+{
+public:
+    Logger();
+    virtual ~Logger();
+
+    /// Spawn the background writer, Stop() is registered to run at exit()
+    static void Start();
+
+    /// Drain all queued log text and stop the writer, idempotent
+    static void Stop();
+
+    /// Block until all log text queued prior to this call has been written
+    static void Flush();
+
+    /**
+     * Suppress log statements which are less severe than the specified level.
+     * @param level Pass the least severe level to be logged
+     */
+    static void SetVerbosity(LogLevel level) { mVerbosity = level; }
+    static LogLevel GetVerbosity() { return (LogLevel)mVerbosity.load(); }
+
+    /**
+     * Log a printf() style statement, the statement is expected to supply
+     * its own trailing new line.
+     * @param level Pass the severity of the statement
+     * @param fmt Pass the printf() style format string
+     */
+    static void Log(LogLevel level, const char *fmt, ...)
+        __attribute__((format(printf, 2, 3)));
+
+    /**
+     * Log text which has already been formatted, e.g. many lines at once,
+     * each of which begins with a prefix as created by LOG_NRM_PREFIX().
+     * @param level Pass the severity of the text
+     * @param text Pass the text, which needn't be NULL terminated
+     * @param len Pass the number of chars within text
+     */
+    static void Write(LogLevel level, const char *text, size_t len);
+
+
+private:
+    static std::atomic<int> mVerbosity;
+};
+
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include "patternGen.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PATGEN_X86
+#endif
+
+
+PatternGen::PatternGen()
+{
+}
+
+
+PatternGen::~PatternGen()
+{
+}
+
+
+/// @return The byte width of each element of the pattern, 0 if unsupported
+static uint32_t
+PatWidth(DataPattern dataPat)
+{
+    switch (dataPat) {
+    case DATAPAT_CONST_8BIT:
+    case DATAPAT_INC_8BIT:      return sizeof(uint8_t);
+    case DATAPAT_CONST_16BIT:
+    case DATAPAT_INC_16BIT:     return sizeof(uint16_t);
+    case DATAPAT_CONST_32BIT:
+    case DATAPAT_INC_32BIT:     return sizeof(uint32_t);
+    default:                    return 0;
+    }
+}
+
+
+static bool
+PatIncrements(DataPattern dataPat)
+{
+    return ((dataPat == DATAPAT_INC_8BIT) || (dataPat == DATAPAT_INC_16BIT) ||
+        (dataPat == DATAPAT_INC_32BIT));
+}
+
+
+/// The reference implementation
+static void
+FillScalar(DataPattern dataPat, uint64_t initVal, uint8_t *buf,
+    uint32_t length)
+{
+    switch (dataPat) {
+    case DATAPAT_CONST_8BIT:
+        for (uint64_t i = 0; i < length; i++)
+            *buf++ = (uint8_t)initVal;
+        break;
+
+    case DATAPAT_CONST_16BIT:
+        {
+            uint16_t *rawPtr = (uint16_t *)buf;
+            for (uint64_t i = 0; i < (length / sizeof(uint16_t)); i++)
+                *rawPtr++ = (uint16_t)initVal;
+        }
+        break;
+
+    case DATAPAT_CONST_32BIT:
+        {
+            uint32_t *rawPtr = (uint32_t *)buf;
+            for (uint64_t i = 0; i < (length / sizeof(uint32_t)); i++)
+                *rawPtr++ = (uint32_t)initVal;
+        }
+        break;
+
+    case DATAPAT_INC_8BIT:
+        for (uint64_t i = 0; i < length; i++)
+            *buf++ = (uint8_t)initVal++;
+        break;
+
+    case DATAPAT_INC_16BIT:
+        {
+            uint16_t *rawPtr = (uint16_t *)buf;
+            for (uint64_t i = 0; i < (length / sizeof(uint16_t)); i++)
+                *rawPtr++ = (uint16_t)initVal++;
+        }
+        break;
+
+    case DATAPAT_INC_32BIT:
+        {
+            uint32_t *rawPtr = (uint32_t *)buf;
+            for (uint64_t i = 0; i < (length / sizeof(uint32_t)); i++)
+                *rawPtr++ = (uint32_t)initVal++;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+#ifdef PATGEN_X86
+/**
+ * The vector implementations seed the 1st vector with the scalar reference,
+ * then advance every lane by the number of elements per vector with a
+ * wrapping add of the element width. The remainder is finished by the
+ * scalar reference, continuing the series.
+ */
+__attribute__((target("sse2")))
+static void
+FillSSE2(DataPattern dataPat, uint64_t initVal, uint8_t *buf, uint32_t length)
+{
+    uint32_t width = PatWidth(dataPat);
+    uint32_t numVec = (length / sizeof(__m128i));
+    __m128i *dst = (__m128i *)buf;
+    uint8_t seed[sizeof(__m128i)];
+
+    FillScalar(dataPat, initVal, seed, sizeof(seed));
+    __m128i vec = _mm_loadu_si128((__m128i *)seed);
+
+    if (PatIncrements(dataPat) == false) {
+        for (uint32_t i = 0; i < numVec; i++)
+            _mm_storeu_si128(dst++, vec);
+    } else if (width == sizeof(uint8_t)) {
+        __m128i step = _mm_set1_epi8(sizeof(__m128i));
+        for (uint32_t i = 0; i < numVec; i++) {
+            _mm_storeu_si128(dst++, vec);
+            vec = _mm_add_epi8(vec, step);
+        }
+    } else if (width == sizeof(uint16_t)) {
+        __m128i step = _mm_set1_epi16(sizeof(__m128i) / sizeof(uint16_t));
+        for (uint32_t i = 0; i < numVec; i++) {
+            _mm_storeu_si128(dst++, vec);
+            vec = _mm_add_epi16(vec, step);
+        }
+    } else {
+        __m128i step = _mm_set1_epi32(sizeof(__m128i) / sizeof(uint32_t));
+        for (uint32_t i = 0; i < numVec; i++) {
+            _mm_storeu_si128(dst++, vec);
+            vec = _mm_add_epi32(vec, step);
+        }
+    }
+
+    uint32_t done = (numVec * sizeof(__m128i));
+    if (PatIncrements(dataPat))
+        initVal += (done / width);
+    FillScalar(dataPat, initVal, (buf + done), (length - done));
+}
+
+
+__attribute__((target("avx2")))
+static void
+FillAVX2(DataPattern dataPat, uint64_t initVal, uint8_t *buf, uint32_t length)
+{
+    uint32_t width = PatWidth(dataPat);
+    uint32_t numVec = (length / sizeof(__m256i));
+    __m256i *dst = (__m256i *)buf;
+    uint8_t seed[sizeof(__m256i)];
+
+    FillScalar(dataPat, initVal, seed, sizeof(seed));
+    __m256i vec = _mm256_loadu_si256((__m256i *)seed);
+
+    if (PatIncrements(dataPat) == false) {
+        for (uint32_t i = 0; i < numVec; i++)
+            _mm256_storeu_si256(dst++, vec);
+    } else if (width == sizeof(uint8_t)) {
+        __m256i step = _mm256_set1_epi8(sizeof(__m256i));
+        for (uint32_t i = 0; i < numVec; i++) {
+            _mm256_storeu_si256(dst++, vec);
+            vec = _mm256_add_epi8(vec, step);
+        }
+    } else if (width == sizeof(uint16_t)) {
+        __m256i step = _mm256_set1_epi16(sizeof(__m256i) / sizeof(uint16_t));
+        for (uint32_t i = 0; i < numVec; i++) {
+            _mm256_storeu_si256(dst++, vec);
+            vec = _mm256_add_epi16(vec, step);
+        }
+    } else {
+        __m256i step = _mm256_set1_epi32(sizeof(__m256i) / sizeof(uint32_t));
+        for (uint32_t i = 0; i < numVec; i++) {
+            _mm256_storeu_si256(dst++, vec);
+            vec = _mm256_add_epi32(vec, step);
+        }
+    }
+
+    uint32_t done = (numVec * sizeof(__m256i));
+    if (PatIncrements(dataPat))
+        initVal += (done / width);
+    FillScalar(dataPat, initVal, (buf + done), (length - done));
+}
+#endif
+
+
+bool
+PatternGen::Fill(DataPattern dataPat, uint64_t initVal, uint8_t *buf,
+    uint32_t length)
+{
+    return Fill(GetImpl(), dataPat, initVal, buf, length);
+}
+
+
+bool
+PatternGen::Fill(Impl impl, DataPattern dataPat, uint64_t initVal,
+    uint8_t *buf, uint32_t length)
+{
+    if (PatWidth(dataPat) == 0)
+        return false;
+
+    switch (impl) {
+#ifdef PATGEN_X86
+    case IMPL_SSE2:     FillSSE2(dataPat, initVal, buf, length);    break;
+    case IMPL_AVX2:     FillAVX2(dataPat, initVal, buf, length);    break;
+#endif
+    default:
+    case IMPL_SCALAR:   FillScalar(dataPat, initVal, buf, length);  break;
+    }
+    return true;
+}
+
+
+PatternGen::Impl
+PatternGen::GetImpl()
+{
+    static const Impl impl = IsSupported(IMPL_AVX2) ? IMPL_AVX2 :
+        (IsSupported(IMPL_SSE2) ? IMPL_SSE2 : IMPL_SCALAR);
+    return impl;
+}
+
+
+bool
+PatternGen::IsSupported(Impl impl)
+{
+    switch (impl) {
+    case IMPL_SCALAR:   return true;
+#ifdef PATGEN_X86
+    case IMPL_SSE2:     return __builtin_cpu_supports("sse2");
+    case IMPL_AVX2:     return __builtin_cpu_supports("avx2");
+#endif
+    default:            return false;
+    }
+}
+
+
+const char *
+PatternGen::GetImplName(Impl impl)
+{
+    switch (impl) {
+    case IMPL_SCALAR:   return "scalar";
+    case IMPL_SSE2:     return "SSE2";
+    case IMPL_AVX2:     return "AVX2";
+    default:            return "unknown";
+    }
+}
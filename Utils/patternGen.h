@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _PATTERNGEN_H_
+#define _PATTERNGEN_H_
+
+#include "tnvme.h"
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It generates the DataPattern series into raw buffers. The
+* fastest implementation supported by the host CPU is chosen at runtime, the
+* scalar implementation is kept as the reference which all others must match
+* byte for byte.
+*
+* @note This class will not throw exceptions.
+*/
+class PatternGen
+{
+public:
+    PatternGen();
+    virtual ~PatternGen();
+
+    typedef enum {
+        IMPL_SCALAR,
+        IMPL_SSE2,
+        IMPL_AVX2,
+        IMPL_FENCE              // always must be last element
+    } Impl;
+
+    /**
+     * Write a data pattern/series to a buffer. The 16/32 bit patterns write
+     * (length / element size) elements, any trailing bytes are not touched.
+     * @param dataPat Pass the desired data pattern/series to calc next value
+     * @param initVal Pass the 1st value of the pattern/series
+     * @param buf Pass the start of the buffer to write, need not be aligned
+     * @param length Pass the number of bytes to write
+     * @return false upon an unsupported pattern, otherwise true
+     */
+    static bool Fill(DataPattern dataPat, uint64_t initVal, uint8_t *buf,
+        uint32_t length);
+
+    /**
+     * Same as above, but forcing a specific implementation.
+     * @param impl Pass the implementation, it must be supported
+     */
+    static bool Fill(Impl impl, DataPattern dataPat, uint64_t initVal,
+        uint8_t *buf, uint32_t length);
+
+    /// @return The fastest implementation the host CPU supports
+    static Impl GetImpl();
+    static bool IsSupported(Impl impl);
+    static const char *GetImplName(Impl impl);
+};
+
+
+#endif
@@ -0,0 +1,467 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "protInfo.h"
+#include "../Exception/frmwkEx.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PROTINFO_X86
+#endif
+
+#define CRC16_T10_POLY              0x8bb7
+/// The PCLMUL impl folds this many bytes per iteration, shorter data uses
+/// the tables
+#define CRC16_FOLD_SIZE             64
+
+
+ProtInfo::ProtInfo()
+{
+}
+
+
+ProtInfo::~ProtInfo()
+{
+}
+
+
+/**
+ * Slice-by-8 tables; table[k][v] is the CRC of byte v followed by k zero
+ * bytes, which allows 8 bytes to be folded into the CRC per iteration.
+ */
+struct CRC16Tables {
+    uint16_t table[8][256];
+
+    CRC16Tables() {
+        for (uint32_t v = 0; v < 256; v++) {
+            uint16_t crc = (v << 8);
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ?
+                    ((crc << 1) ^ CRC16_T10_POLY) : (crc << 1);
+            }
+            table[0][v] = crc;
+        }
+        for (int k = 1; k < 8; k++) {
+            for (uint32_t v = 0; v < 256; v++) {
+                uint16_t crc = table[k - 1][v];
+                table[k][v] = ((crc << 8) ^ table[0][crc >> 8]);
+            }
+        }
+    }
+};
+
+
+static uint16_t
+CRC16Table(const uint8_t *buf, uint32_t length, uint16_t crc)
+{
+    static const CRC16Tables tables;
+    const uint16_t (*t)[256] = tables.table;
+
+    for (; length >= 8; length -= 8, buf += 8) {
+        crc = (t[7][buf[0] ^ (crc >> 8)] ^ t[6][buf[1] ^ (crc & 0xff)] ^
+            t[5][buf[2]] ^ t[4][buf[3]] ^ t[3][buf[4]] ^ t[2][buf[5]] ^
+            t[1][buf[6]] ^ t[0][buf[7]]);
+    }
+    for (; length; length--)
+        crc = ((crc << 8) ^ t[0][(crc >> 8) ^ *buf++]);
+    return crc;
+}
+
+
+#ifdef PROTINFO_X86
+/// @return x^n mod the CRC16 T10 DIF poly
+static uint64_t
+XPowMod(uint32_t n)
+{
+    uint32_t rem = 1;
+    for (uint32_t i = 0; i < n; i++) {
+        rem <<= 1;
+        if (rem & 0x10000)
+            rem ^= (0x10000 | CRC16_T10_POLY);
+    }
+    return rem;
+}
+
+
+/**
+ * The multipliers which fold a 128 bit value down by a distance of bits;
+ * the upper half is multiplied by x^(distance + 64), the lower half by
+ * x^distance, both mod the poly.
+ */
+struct CRC16FoldKeys {
+    uint64_t key[4][2];     // Distances of 128, 256, 384 and 512 bits
+
+    CRC16FoldKeys() {
+        for (int i = 0; i < 4; i++) {
+            key[i][0] = XPowMod(128 * (i + 1));
+            key[i][1] = XPowMod((128 * (i + 1)) + 64);
+        }
+    }
+};
+
+
+/// Fold a 128 bit value down by the distance whose keys are passed
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i
+Fold(__m128i val, __m128i keys)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(val, keys, 0x00),
+        _mm_clmulepi64_si128(val, keys, 0x11));
+}
+
+
+/**
+ * The data is a polynomial, the MSb of its 1st byte the highest power. Each
+ * 16 bytes is byte reversed into a 128 bit lane, then 4 lanes at a time are
+ * folded down onto the next 64 bytes, and finally onto each other. Folding
+ * preserves the data's remainder mod the poly, so the remaining 16 bytes,
+ * and any tail, are finished by the tables.
+ */
+__attribute__((target("pclmul,ssse3")))
+static uint16_t
+CRC16PCLMUL(const uint8_t *buf, uint32_t length, uint16_t crc)
+{
+    static const CRC16FoldKeys fold;
+    const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+        12, 13, 14, 15);
+    __m128i keys[4];
+    __m128i x[4];
+    uint8_t rem[sizeof(__m128i)];
+
+    if (length < CRC16_FOLD_SIZE)
+        return CRC16Table(buf, length, crc);
+    for (int i = 0; i < 4; i++) {
+        keys[i] = _mm_set_epi64x(fold.key[i][1], fold.key[i][0]);
+        x[i] = _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i *)(buf + (i * 16))), swap);
+    }
+    // The CRC of preceding data is folded into the 1st 2 bytes
+    x[0] = _mm_xor_si128(x[0], _mm_set_epi64x(((uint64_t)crc << 48), 0));
+    buf += CRC16_FOLD_SIZE;
+    length -= CRC16_FOLD_SIZE;
+
+    for (; length >= CRC16_FOLD_SIZE; length -= CRC16_FOLD_SIZE) {
+        for (int i = 0; i < 4; i++) {
+            x[i] = _mm_xor_si128(Fold(x[i], keys[3]), _mm_shuffle_epi8(
+                _mm_loadu_si128((const __m128i *)(buf + (i * 16))), swap));
+        }
+        buf += CRC16_FOLD_SIZE;
+    }
+    __m128i val = _mm_xor_si128(_mm_xor_si128(Fold(x[0], keys[2]),
+        Fold(x[1], keys[1])), _mm_xor_si128(Fold(x[2], keys[0]), x[3]));
+    for (; length >= sizeof(__m128i); length -= sizeof(__m128i)) {
+        val = _mm_xor_si128(Fold(val, keys[0]), _mm_shuffle_epi8(
+            _mm_loadu_si128((const __m128i *)buf), swap));
+        buf += sizeof(__m128i);
+    }
+
+    _mm_storeu_si128((__m128i *)rem, _mm_shuffle_epi8(val, swap));
+    crc = CRC16Table(rem, sizeof(rem), 0);
+    return CRC16Table(buf, length, crc);
+}
+#endif
+
+
+uint16_t
+ProtInfo::CRC16(const uint8_t *buf, uint32_t length, uint16_t crc)
+{
+    return CRC16(GetCRCImpl(), buf, length, crc);
+}
+
+
+uint16_t
+ProtInfo::CRC16(CRCImpl impl, const uint8_t *buf, uint32_t length,
+    uint16_t crc)
+{
+    switch (impl) {
+#ifdef PROTINFO_X86
+    case CRCIMPL_PCLMUL:
+        return CRC16PCLMUL(buf, length, crc);
+#endif
+    default:
+    case CRCIMPL_TABLE:
+        return CRC16Table(buf, length, crc);
+    }
+}
+
+
+uint16_t
+ProtInfo::CRC16Reference(const uint8_t *buf, uint32_t length, uint16_t crc)
+{
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= (buf[i] << 8);
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? ((crc << 1) ^ CRC16_T10_POLY) : (crc << 1);
+    }
+    return crc;
+}
+
+
+ProtInfo::CRCImpl
+ProtInfo::GetCRCImpl()
+{
+    static const CRCImpl impl =
+        IsSupported(CRCIMPL_PCLMUL) ? CRCIMPL_PCLMUL : CRCIMPL_TABLE;
+    return impl;
+}
+
+
+bool
+ProtInfo::IsSupported(CRCImpl impl)
+{
+    switch (impl) {
+    case CRCIMPL_TABLE:     return true;
+#ifdef PROTINFO_X86
+    case CRCIMPL_PCLMUL:
+        return (__builtin_cpu_supports("pclmul") &&
+            __builtin_cpu_supports("ssse3"));
+#endif
+    default:                return false;
+    }
+}
+
+
+const char *
+ProtInfo::GetCRCImplName(CRCImpl impl)
+{
+    switch (impl) {
+    case CRCIMPL_TABLE:     return "table";
+    case CRCIMPL_PCLMUL:    return "PCLMUL";
+    default:                return "unknown";
+    }
+}
+
+
+bool
+ProtInfo::GetParams(ConstSharedIdentifyPtr idNamspc, ProtInfoParams &params)
+{
+    LBAFormat lbaFmt = idNamspc->GetLBAFormat();
+    uint8_t dps = (uint8_t)idNamspc->GetValue(IDNAMESPC_DPS);
+    uint8_t flbas = (uint8_t)idNamspc->GetValue(IDNAMESPC_FLBAS);
+
+    params.type = (PIType)(dps & 0x07);
+    params.piFirst = (dps & (1 << 3));
+    params.extended = (flbas & (1 << 4));
+    params.lbaDataSize = (1 << lbaFmt.LBADS);
+    params.metaSize = lbaFmt.MS;
+    params.prchk = 0;
+    params.refTag = 0;
+    params.appTag = 0;
+    params.appTagMask = 0;
+
+    if ((params.type == PITYPE_NONE) || (params.type >= PITYPE_FENCE)) {
+        LOG_ERR("Namspc is not formatted with a supported PI type: %d",
+            params.type);
+        return false;
+    } else if (params.metaSize < PROTINFO_SIZE) {
+        LOG_ERR("Namspc meta data size %d < PI size", params.metaSize);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Locate the LBA data, the PI and the bytes covered by the guard of a block.
+ * @param params Pass the layout of the series
+ * @param data Pass the LBA data of the series
+ * @param meta Pass the meta data of the series
+ * @param blk Pass the index of the block within the series
+ * @param pi Returns the start of the PI of the block
+ * @param guardLen Returns the number of bytes the guard covers
+ * @return The start of the LBA data of the block
+ */
+static const uint8_t *
+LocateBlk(const ProtInfoParams &params, const uint8_t *data,
+    const uint8_t *meta, uint32_t blk, const uint8_t *&pi,
+    uint32_t &guardLen)
+{
+    const uint8_t *blkData;
+    const uint8_t *blkMeta;
+
+    if (params.extended) {
+        blkData = (data + ((params.lbaDataSize + params.metaSize) * blk));
+        blkMeta = (blkData + params.lbaDataSize);
+    } else {
+        blkData = (data + (params.lbaDataSize * blk));
+        blkMeta = (meta + (params.metaSize * blk));
+    }
+
+    if (params.piFirst) {
+        pi = blkMeta;
+        guardLen = params.lbaDataSize;
+    } else {
+        pi = (blkMeta + params.metaSize - PROTINFO_SIZE);
+        guardLen = (params.lbaDataSize + params.metaSize - PROTINFO_SIZE);
+    }
+    return blkData;
+}
+
+
+/// Calc the guard of a block, which may be split between 2 buffers
+static uint16_t
+CalcGuard(const ProtInfoParams &params, const uint8_t *blkData,
+    const uint8_t *pi, uint32_t guardLen)
+{
+    if (params.extended || (guardLen == params.lbaDataSize))
+        return ProtInfo::CRC16(blkData, guardLen);
+
+    uint16_t crc = ProtInfo::CRC16(blkData, params.lbaDataSize);
+    uint32_t metaLen = (guardLen - params.lbaDataSize);
+    return ProtInfo::CRC16((pi - metaLen), metaLen, crc);
+}
+
+
+/// Type 1 and 2 ref tags increment per block, type 3 ref tags do not
+static uint32_t
+ExpRefTag(const ProtInfoParams &params, uint32_t blk)
+{
+    return (params.type == PITYPE_3) ? params.refTag : (params.refTag + blk);
+}
+
+
+void
+ProtInfo::Generate(const ProtInfoParams &params, uint8_t *data,
+    uint8_t *meta, uint32_t numBlks)
+{
+    for (uint32_t blk = 0; blk < numBlks; blk++) {
+        const uint8_t *pi;
+        uint32_t guardLen;
+        const uint8_t *blkData = LocateBlk(params, data, meta, blk, pi,
+            guardLen);
+
+        uint16_t guard = CalcGuard(params, blkData, pi, guardLen);
+        uint32_t refTag = ExpRefTag(params, blk);
+
+        // PI fields are big endian
+        uint8_t *out = (uint8_t *)pi;
+        out[0] = (guard >> 8);
+        out[1] = guard;
+        out[2] = (params.appTag >> 8);
+        out[3] = params.appTag;
+        out[4] = (refTag >> 24);
+        out[5] = (refTag >> 16);
+        out[6] = (refTag >> 8);
+        out[7] = refTag;
+    }
+}
+
+
+bool
+ProtInfo::Verify(const ProtInfoParams &params, const uint8_t *data,
+    const uint8_t *meta, uint32_t numBlks, ProtInfoResult &result)
+{
+    result.numBlks = numBlks;
+    result.numBad = 0;
+    result.bad.clear();
+
+    for (uint32_t blk = 0; blk < numBlks; blk++) {
+        const uint8_t *pi;
+        uint32_t guardLen;
+        const uint8_t *blkData = LocateBlk(params, data, meta, blk, pi,
+            guardLen);
+
+        ProtInfoBad bad;
+        bad.blk = blk;
+        bad.failed = 0;
+        bad.foundGuard = ((pi[0] << 8) | pi[1]);
+        bad.foundAppTag = ((pi[2] << 8) | pi[3]);
+        bad.foundRefTag = (((uint32_t)pi[4] << 24) | (pi[5] << 16) |
+            (pi[6] << 8) | pi[7]);
+        bad.expRefTag = ExpRefTag(params, blk);
+        bad.guard = 0;
+
+        // Escape values disable checking of the entire block
+        if (bad.foundAppTag == 0xffff) {
+            if ((params.type != PITYPE_3) || (bad.foundRefTag == 0xffffffff))
+                continue;
+        }
+
+        if (params.prchk & PRCHK_GUARD) {
+            bad.guard = CalcGuard(params, blkData, pi, guardLen);
+            if (bad.guard != bad.foundGuard)
+                bad.failed |= PRCHK_GUARD;
+        }
+        if ((params.prchk & PRCHK_APPTAG) &&
+            ((bad.foundAppTag ^ params.appTag) & params.appTagMask)) {
+            bad.failed |= PRCHK_APPTAG;
+        }
+        if ((params.prchk & PRCHK_REFTAG) &&
+            (bad.foundRefTag != bad.expRefTag)) {
+            bad.failed |= PRCHK_REFTAG;
+        }
+
+        if (bad.failed && (result.numBad++ < PROTINFO_MAX_DETAILS))
+            result.bad.push_back(bad);
+    }
+    return (result.numBad == 0);
+}
+
+
+void
+ProtInfo::GetBuffers(Cmd &cmd, const ProtInfoParams &params,
+    uint32_t numBlks, uint8_t *&data, uint8_t *&meta)
+{
+    SharedMemBufferPtr prp = cmd.GetRWPrpBuffer();
+    if (prp == MemBuffer::NullMemBufferPtr)
+        throw FrmwkEx(HERE, "Cmd has no RW PRP buffer holding PI");
+
+    uint32_t blkSize = params.lbaDataSize;
+    if (params.extended)
+        blkSize += params.metaSize;
+    if (prp->GetBufSize() < (blkSize * numBlks)) {
+        throw FrmwkEx(HERE, "PRP buffer size 0x%08X < %d blks of 0x%X",
+            prp->GetBufSize(), numBlks, blkSize);
+    }
+    data = prp->GetBuffer();
+    meta = NULL;
+
+    if (params.extended == false) {
+        if ((cmd.GetMetaBuffer() == NULL) ||
+            (cmd.GetMetaBufferSize() < (params.metaSize * numBlks))) {
+            throw FrmwkEx(HERE, "Meta data buffer can't hold %d blks of PI",
+                numBlks);
+        }
+        meta = cmd.GetMetaBuffer();
+    }
+}
+
+
+void
+ProtInfo::Log(const ProtInfoResult &result)
+{
+    if (result.numBad == 0) {
+        LOG_NRM("PI of all %d blks verified", result.numBlks);
+        return;
+    }
+
+    LOG_ERR("PI of %d of %d blks failed to verify:", result.numBad,
+        result.numBlks);
+    for (size_t i = 0; i < result.bad.size(); i++) {
+        const ProtInfoBad &bad = result.bad[i];
+        LOG_ERR("  blk %d:%s%s%s guard 0x%04X(calc 0x%04X), app tag 0x%04X, "
+            "ref tag 0x%08X(expected 0x%08X)", bad.blk,
+            (bad.failed & PRCHK_GUARD) ? " GUARD" : "",
+            (bad.failed & PRCHK_APPTAG) ? " APPTAG" : "",
+            (bad.failed & PRCHK_REFTAG) ? " REFTAG" : "", bad.foundGuard,
+            bad.guard, bad.foundAppTag, bad.foundRefTag, bad.expRefTag);
+    }
+    if (result.numBad > result.bad.size()) {
+        LOG_ERR("  %ld further bad blk(s) not listed",
+            (result.numBad - result.bad.size()));
+    }
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef _PROTINFO_H_
+#define _PROTINFO_H_
+
+#include "tnvme.h"
+#include "../Cmds/cmd.h"
+#include "../Cmds/identify.h"
+
+/// Bytes of protection information (PI) within the meta data of each LBA
+#define PROTINFO_SIZE               8
+
+/// PRINFO.PRCHK bits, selects which PI fields are checked
+#define PRCHK_REFTAG                0x01
+#define PRCHK_APPTAG                0x02
+#define PRCHK_GUARD                 0x04
+#define PRCHK_ALL                   (PRCHK_GUARD | PRCHK_APPTAG | PRCHK_REFTAG)
+/// PRINFO.PRACT, the ctrlr inserts/strips the PI rather than the host
+#define PRINFO_PRACT                0x08
+
+/// Only this many leading bad blocks are detailed, all are counted
+#define PROTINFO_MAX_DETAILS        32
+
+
+typedef enum {
+    PITYPE_NONE,
+    PITYPE_1,
+    PITYPE_2,
+    PITYPE_3,
+    PITYPE_FENCE            // always must be last element
+} PIType;
+
+/// Describes the PI of a series of consecutive LBA's
+struct ProtInfoParams {
+    PIType   type;          // Identify.DPS bits 2:0
+    bool     piFirst;       // Identify.DPS bit 3; PI 1st, else last 8 bytes
+    bool     extended;      // Meta data interleaved at the end of each LBA
+    uint32_t lbaDataSize;
+    uint32_t metaSize;      // Meta data bytes per LBA, >= PROTINFO_SIZE
+    uint8_t  prchk;         // PRCHK_* fields checked by Verify()
+    uint32_t refTag;        // Ref tag of the 1st block, i.e. ILBRT/EILBRT
+    uint16_t appTag;        // i.e. LBAT/ELBAT
+    uint16_t appTagMask;    // i.e. LBATM/ELBATM
+};
+
+/// The details of a block whose PI did not verify
+struct ProtInfoBad {
+    uint32_t blk;           // Index of the block within the series
+    uint8_t  failed;        // PRCHK_* fields which miscompared
+    uint16_t guard;         // Calc'd guard
+    uint16_t foundGuard;
+    uint16_t foundAppTag;
+    uint32_t expRefTag;
+    uint32_t foundRefTag;
+};
+
+/// The outcome of verifying the PI of a series of LBA's
+struct ProtInfoResult {
+    uint32_t numBlks;
+    uint32_t numBad;
+    vector<ProtInfoBad> bad; // The 1st PROTINFO_MAX_DETAILS bad blocks
+};
+
+
+/**
+* This class is meant not be instantiated because it should only ever contain
+* static members. It generates and verifies T10 DIF style end to end
+* protection information: the CRC16 T10 guard over the LBA data, the
+* application tag and the reference tag. Both the extended LBA layout, where
+* the meta data follows each LBA within the data buffer, and the separate
+* meta data buffer layout are supported.
+*
+* @note This class may throw exceptions, please see comment within specific
+*       methods.
+*/
+class ProtInfo
+{
+public:
+    ProtInfo();
+    virtual ~ProtInfo();
+
+    typedef enum {
+        CRCIMPL_TABLE,          // Slice-by-8 lookup tables
+        CRCIMPL_PCLMUL,         // Carry-less multiply folding, 64B at a time
+        CRCIMPL_FENCE           // always must be last element
+    } CRCImpl;
+
+    /**
+     * Calc the CRC16 T10 DIF (poly 0x8bb7) using the fastest implementation
+     * the host CPU supports.
+     * @param buf Pass the data to calc
+     * @param length Pass the number of bytes to calc
+     * @param crc Pass the CRC of preceding data, allowing calc in pieces
+     * @return The CRC
+     */
+    static uint16_t CRC16(const uint8_t *buf, uint32_t length,
+        uint16_t crc = 0);
+
+    /**
+     * Same as above, but forcing a specific implementation.
+     * @param impl Pass the implementation, it must be supported
+     */
+    static uint16_t CRC16(CRCImpl impl, const uint8_t *buf, uint32_t length,
+        uint16_t crc = 0);
+
+    /// The bit at a time reference implementation of CRC16()
+    static uint16_t CRC16Reference(const uint8_t *buf, uint32_t length,
+        uint16_t crc = 0);
+
+    /// @return The fastest CRC16 implementation the host CPU supports
+    static CRCImpl GetCRCImpl();
+    static bool IsSupported(CRCImpl impl);
+    static const char *GetCRCImplName(CRCImpl impl);
+
+    /**
+     * Learn the PI layout of a namspc, the tag fields are zeroed.
+     * @note This method does not throw
+     * @param idNamspc Pass the identify namspc data of the namspc
+     * @param params Returns the layout
+     * @return false when the namspc is not formatted with PI, otherwise true
+     */
+    static bool GetParams(ConstSharedIdentifyPtr idNamspc,
+        ProtInfoParams &params);
+
+    /**
+     * Stamp PI into every block of a series. The guard covers the LBA data,
+     * and when PI is last, also any meta data preceding the PI.
+     * @note This method does not throw
+     * @param params Pass the layout and tags of the series
+     * @param data Pass the LBA data, including the meta data if extended
+     * @param meta Pass the meta data buffer, ignored if extended
+     * @param numBlks Pass the number of LBA's within the series
+     */
+    static void Generate(const ProtInfoParams &params, uint8_t *data,
+        uint8_t *meta, uint32_t numBlks);
+
+    /**
+     * Verify the PI of every block of a series, checking params.prchk
+     * fields. Blocks which escape checking per the PI type are skipped.
+     * @note This method does not throw
+     * @param params Pass the layout and expected tags of the series
+     * @param data Pass the LBA data, including the meta data if extended
+     * @param meta Pass the meta data buffer, ignored if extended
+     * @param numBlks Pass the number of LBA's within the series
+     * @param result Returns the details of every block which didn't verify
+     * @return true when every block verified, otherwise false
+     */
+    static bool Verify(const ProtInfoParams &params, const uint8_t *data,
+        const uint8_t *meta, uint32_t numBlks, ProtInfoResult &result);
+
+    /**
+     * Locate the data and meta data buffers of a cmd which holds PI.
+     * @note This method will throw if the cmd's buffers don't fit numBlks
+     * @param cmd Pass the cmd holding the buffers
+     * @param params Pass the layout of the series
+     * @param numBlks Pass the number of LBA's the cmd xfers
+     * @param data Returns the start of the data buffer
+     * @param meta Returns the start of the meta data buffer, NULL if extended
+     */
+    static void GetBuffers(Cmd &cmd, const ProtInfoParams &params,
+        uint32_t numBlks, uint8_t *&data, uint8_t *&meta);
+
+    /**
+     * Send the details of a failed verify to the logging endpoint.
+     * @note This method does not throw
+     * @param result Pass the result of a prior call to Verify()
+     */
+    static void Log(const ProtInfoResult &result);
+};
+
+
+#endif
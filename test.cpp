@@ -18,6 +18,10 @@
 #include "test.h"
 #include "globals.h"
 #include "./Utils/kernelAPI.h"
+#include "./Utils/latency.h"
+#include "./Utils/bufferPool.h"
+#include "./Utils/flightRec.h"
+#include "./Utils/dumpArchive.h"
 
 
 Test::Test(string grpName, string testName, SpecRev specRev)
@@ -66,6 +70,32 @@ Test::operator=(const Test &other)
 
 bool
 Test::Run()
+{
+    Latency::Reset();
+    KernelAPI::ResetIoctlStats();
+    BufferPool::ResetStats();
+    DumpArchive::Open(FileSystem::PrepDumpFile(mGrpName, mTestName, "dumps",
+        "gz"));
+    FlightRec::Start();
+    bool success = RunWorker();
+    Latency::Dump(FileSystem::PrepDumpFile(mGrpName, mTestName, "latency"),
+        "Cmd latency recorded during the test");
+
+    // Dumps taken along the way only matter if the test failed
+    if (success)
+        FlightRec::Discard();
+    else
+        FlightRec::Flush();
+    DumpArchive::Close();
+
+    KernelAPI::LogIoctlStats(KernelAPI::IOCTLSCOPE_TEST);
+    BufferPool::LogStats();
+    return success;
+}
+
+
+bool
+Test::RunWorker()
 {
     try {
         ResetStatusRegErrors();
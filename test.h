@@ -204,6 +204,9 @@ private:
     ///////////////////////////////////////////////////////////////////////////
 
     Test();
+
+    /// Performs the duties of Run() between the latency reset and dump
+    bool RunWorker();
 };
 
 
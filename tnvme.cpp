@@ -29,7 +29,12 @@
 #include "version.h"
 #include "globals.h"
 #include "Utils/kernelAPI.h"
+#include "Utils/bufferPool.h"
 #include "Utils/fileSystem.h"
+#include "Utils/logger.h"
+#include "Utils/binDump.h"
+#include "Utils/flightRec.h"
+#include "Utils/dumpArchive.h"
 
 
 // ------------------------------EDIT HERE---------------------------------
@@ -58,6 +63,7 @@
 #include "GrpAdminGetFeatCmd/grpAdminGetFeatCmd.h"
 #include "GrpAdminSetGetFeatCombo/grpAdminSetGetFeatCombo.h"
 #include "GrpAdminAsyncCmd/grpAdminAsyncCmd.h"
+#include "GrpPerformance/grpPerformance.h"
 
 
 void
@@ -93,6 +99,8 @@ InstantiateGroups(vector<Group *> &groups)
     groups.push_back(new GrpAdminGetFeatCmd::GrpAdminGetFeatCmd(groups.size()));
     groups.push_back(new GrpAdminSetGetFeatCombo::GrpAdminSetGetFeatCombo(groups.size()));
     groups.push_back(new GrpAdminAsyncCmd::GrpAdminAsyncCmd(groups.size()));
+    // Following is assigned grp ID=25
+    groups.push_back(new GrpPerformance::GrpPerformance(groups.size()));
 }
 // ------------------------------EDIT HERE---------------------------------
 
@@ -178,6 +186,19 @@ Usage(void) {
     printf("                                      access width <acc>={l | w | b} type\n");
     printf("                                      (Require: <size> < 8)\n");
     printf("                                      <offset:size> requires base 16 values\n");
+    printf("  -x(--trace) <filename>              Write a binary trace record of every\n");
+    printf("                                      ioctl issued to dnvme into <filename>\n");
+    printf("  -c(--verbosity) <level>             Log only statements of <level> severity\n");
+    printf("                                      or more; {0=err | 1=warn | 2=nrm |\n");
+    printf("                                      3=dbg}; dflt=3\n");
+    printf("  -j(--bindump)                       Write dump files in a compact binary\n");
+    printf("                                      format; render them with tnvme-dump\n");
+    printf("  -F(--flightrec) [MiB]               Hold each test's dumps in memory, within\n");
+    printf("                                      a budget of [MiB]; dflt=%d. Write them\n", FLIGHTREC_DEFAULT_MiB);
+    printf("                                      only if the test fails\n");
+    printf("  -Z(--archive)                       Stream each test's dumps into a single\n");
+    printf("                                      compressed archive, <grp>.<test>.dumps.gz;\n");
+    printf("                                      list/extract them with tnvme-dump\n");
 }
 
 
@@ -196,7 +217,7 @@ main(int argc, char *argv[])
     bool deviceFound = false;
     bool accessingHdw = true;
     uint64_t regVal = 0;
-    const char *short_opt = "hsnblpyzia::t::v:o:d:k:f:r:w:q:e:m:u:g:";
+    const char *short_opt = "hsnblpyzija::t::v:o:d:k:f:r:w:q:e:m:u:g:x:c:F::Z";
     static struct option long_opt[] = {
         // {name,           has_arg,            flag,   val}
         {   "detail",       optional_argument,  NULL,   'a'},
@@ -214,6 +235,8 @@ main(int argc, char *argv[])
         {   "dump",         required_argument,  NULL,   'u'},
         {   "golden",       required_argument,  NULL,   'g'},
         {   "fwimage",      required_argument,  NULL,   'm'},
+        {   "trace",        required_argument,  NULL,   'x'},
+        {   "verbosity",    required_argument,  NULL,   'c'},
 
         {   "help",         no_argument,        NULL,   'h'},
         {   "summary",      no_argument,        NULL,   's'},
@@ -224,6 +247,9 @@ main(int argc, char *argv[])
         {   "ignore",       no_argument,        NULL,   'i'},
         {   "postfail",     no_argument,        NULL,   'n'},
         {   "rsvdfields",   no_argument,        NULL,   'b'},
+        {   "bindump",      no_argument,        NULL,   'j'},
+        {   "flightrec",    optional_argument,  NULL,   'F'},
+        {   "archive",      no_argument,        NULL,   'Z'},
         {   NULL,           no_argument,        NULL,    0}
     };
 
@@ -245,6 +271,9 @@ main(int argc, char *argv[])
     // Disable buffering stdout, risk not seeing statements merged with dump dir
     setbuf(stdout, NULL);
 
+    // Log statements are queued and written to stderr by a background thread
+    Logger::Start();
+
     // Seek for all possible devices that this app may commune
     DIR *devDir = opendir("/dev");
     if (devDir == NULL) {
@@ -395,6 +424,31 @@ main(int argc, char *argv[])
             gCmdLine.dump = optarg;
             break;
 
+        case 'x':
+            gCmdLine.trace = optarg;
+            break;
+
+        case 'c':
+            tmp = strtol(optarg, &endptr, 10);
+            if ((*endptr != '\0') || (tmp < 0) || (tmp >= LOGLVL_FENCE)) {
+                printf("Unrecognized --verbosity <level>=%s\n", optarg);
+                exit(1);
+            }
+            Logger::SetVerbosity((LogLevel)tmp);
+            break;
+
+        case 'F':
+            tmp = FLIGHTREC_DEFAULT_MiB;
+            if (optarg != NULL) {
+                tmp = strtol(optarg, &endptr, 10);
+                if ((*endptr != '\0') || (tmp <= 0)) {
+                    printf("Unrecognized --flightrec [MiB]=%s\n", optarg);
+                    exit(1);
+                }
+            }
+            FlightRec::SetBudget((uint64_t)tmp * 1024 * 1024);
+            break;
+
         default:
         case 'h':   Usage();                            exit(0);
         case '?':   Usage();                            exit(1);
@@ -404,6 +458,8 @@ main(int argc, char *argv[])
         case 'n':   gCmdLine.postfail = true;           break;
         case 'b':   gCmdLine.rsvdfields = true;         break;
         case 'y':   gCmdLine.restore = true;            break;
+        case 'j':   BinDump::SetEnabled(true);          break;
+        case 'Z':   DumpArchive::SetEnabled(true);      break;
         }
     }
 
@@ -433,6 +489,13 @@ main(int argc, char *argv[])
                 exit(1);
             }
 
+            if (gCmdLine.trace.length() &&
+                (KernelAPI::OpenIoctlTrace(gCmdLine.trace) == false)) {
+                printf("Unable to create \"%s\" ioctl trace file\n",
+                    gCmdLine.trace.c_str());
+                exit(1);
+            }
+
             if (BuildSingletons() == false) {
                 printf("Unable to instantiate mandatory framework objects\n");
                 exit(1);
@@ -447,21 +510,29 @@ main(int argc, char *argv[])
             }
         }
 
-        // Process the user's cmd line parameters
+        // Process the user's cmd line parameters. The logging is written from
+        // a background thread, it must be flushed before reporting outcomes
+        // to stdout or the outcome could overtake the logging leading to it.
         if (gCmdLine.golden.req) {
-            if ((exitCode = !CompareGolden(gCmdLine.golden))) {
+            exitCode = !CompareGolden(gCmdLine.golden);
+            Logger::Flush();
+            if (exitCode) {
                 printf("FAILURE: Comparing golden data\n");
             } else {
                 printf("SUCCESS: Comparing golden data\n");
             }
         } else if (gCmdLine.format.req) {
-            if ((exitCode = !FormatDevice(gCmdLine.format))) {
+            exitCode = !FormatDevice(gCmdLine.format);
+            Logger::Flush();
+            if (exitCode) {
                 printf("FAILURE: Formatting device\n");
             } else {
                 printf("SUCCESS: Formatting device\n");
             }
         } else if (gCmdLine.numQueues.req) {
-            if ((exitCode = !SetFeaturesNumberOfQueues(gCmdLine.numQueues))) {
+            exitCode = !SetFeaturesNumberOfQueues(gCmdLine.numQueues);
+            Logger::Flush();
+            if (exitCode) {
                 printf("FAILURE: Setting number of queues\n");
             } else {
                 printf("SUCCESS: Setting number of queues\n");
@@ -516,7 +587,9 @@ main(int argc, char *argv[])
                 gCmdLine.wmmap.offset, gCmdLine.wmmap.acc,
                 (uint8_t *)(&gCmdLine.wmmap.value));
         } else if (gCmdLine.reset) {
-            if ((exitCode = !gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY))) {
+            exitCode = !gCtrlrConfig->SetState(ST_DISABLE_COMPLETELY);
+            Logger::Flush();
+            if (exitCode) {
                 printf("FAILURE: reset\n");
             } else {
                 printf("SUCCESS: reset\n");
@@ -524,12 +597,17 @@ main(int argc, char *argv[])
             // At this point we cannot enable the ctrlr because that requires
             // ACQ/ASQ's to be created, ctrlr simply won't become ready w/o them
         } else if (gCmdLine.test.req) {
-            if ((exitCode = !ExecuteTests(gCmdLine, groups))) {
+            exitCode = !ExecuteTests(gCmdLine, groups);
+            Logger::Flush();
+            if (exitCode) {
                 printf("FAILURE: testing\n");
             } else {
                 printf("SUCCESS: testing\n");
             }
         }
+
+        if (accessingHdw)
+            KernelAPI::LogIoctlStats(KernelAPI::IOCTLSCOPE_RUN);
     } catch (...) {
         LOG_ERR("An unforeseen exception has been caught");
     }
@@ -537,8 +615,11 @@ main(int argc, char *argv[])
     // cleanup duties
     DestroyTestFoundation(groups);
     DestroySingletons();
+    KernelAPI::CloseIoctlTrace();
+    BufferPool::Drain();
     gCmdLine.skiptest.clear();
     devices.clear();
+    Logger::Stop();
     exit(exitCode);
 }
 
@@ -616,7 +697,9 @@ BuildTestFoundation(vector<Group *> &groups)
     // attained a lock on the target device may have multiple threads which
     // could cause testing corruption, and therefore a single threaded device
     // interaction model is needed. No more than 1 test can occur at any time
-    // to any device and all tests must be single threaded.
+    // to any device and all tests must be single threaded. The only exception
+    // being a test may fan out IOQ pairs to IOWorker threads which it then
+    // waits upon, see Utils/ioWorker.h.
     if (gCmdLine.device.compare(NO_DEVICES) == 0) {
         LOG_ERR("There are no devices present");
         return false;
@@ -638,7 +721,8 @@ BuildTestFoundation(vector<Group *> &groups)
     }
 
     // Validate the dnvme was compiled with the same version of API as tnvme
-    ret = ioctl(gDutFd, NVME_IOCTL_GET_DRIVER_METRICS, &driverMetrics);
+    ret = KernelAPI::ioctl(gDutFd, NVME_IOCTL_GET_DRIVER_METRICS,
+        &driverMetrics);
     if (ret < 0) {
         LOG_ERR("Unable to extract driver version information");
         return false;
@@ -22,6 +22,7 @@
 #include <vector>
 #include "dnvme.h"
 #include "testRef.h"
+#include "Utils/logger.h"
 
 using namespace std;
 
@@ -31,19 +32,27 @@ using namespace std;
 #define APPNAME         "tnvme"
 #define LEVEL           APPNAME
 #define LOG_NRM(fmt, ...)       \
-    fprintf(stderr, "%s:%s:%d: " fmt "\n", LEVEL, HERE, ## __VA_ARGS__);
+    Logger::Log(LOGLVL_NRM, "%s:%s:%d: " fmt "\n", LEVEL, HERE,         \
+        ## __VA_ARGS__);
 #define LOG_ERR(fmt, ...)       \
-    fprintf(stderr, "%s-err:%s:%d: " fmt "\n", LEVEL, HERE, ## __VA_ARGS__);
+    Logger::Log(LOGLVL_ERR, "%s-err:%s:%d: " fmt "\n", LEVEL, HERE,     \
+        ## __VA_ARGS__);
 #define LOG_WARN(fmt, ...)      \
-    fprintf(stderr, "%s-warn:%s:%d: " fmt "\n", LEVEL, HERE, ## __VA_ARGS__);
+    Logger::Log(LOGLVL_WARN, "%s-warn:%s:%d: " fmt "\n", LEVEL, HERE,   \
+        ## __VA_ARGS__);
 
 #ifdef DEBUG
 #define LOG_DBG(fmt, ...)       \
-    fprintf(stderr, "%s-dbg:%s:%d: " fmt "\n", LEVEL, HERE, ## __VA_ARGS__);
+    Logger::Log(LOGLVL_DBG, "%s-dbg:%s:%d: " fmt "\n", LEVEL, HERE,     \
+        ## __VA_ARGS__);
 #else
 #define LOG_DBG(fmt, ...)       ;
 #endif
 
+/// Formats the prefix LOG_NRM gives each line, for use with Logger::Write()
+#define LOG_NRM_PREFIX(buf, size)       \
+    snprintf(buf, size, "%s:%s:%d: ", LEVEL, HERE)
+
 
 #define MAX_CHAR_PER_LINE_DESCRIPTION       63
 
@@ -188,6 +197,7 @@ struct CmdLine {
     NumQueues       numQueues;
     ErrorRegs       errRegs;
     string          dump;
+    string          trace;
 };
 
 
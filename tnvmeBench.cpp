@@ -0,0 +1,932 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <new>
+#include <vector>
+#include <random>
+#include "tnvme.h"
+#include "Utils/buffers.h"
+#include "Utils/patternGen.h"
+#include "Utils/bufCompare.h"
+#include "Utils/blkTag.h"
+#include "Utils/protInfo.h"
+#include "Cmds/write.h"
+#include "Cmds/cmdPool.h"
+
+#define BENCHAPPNAME            "tnvme-bench"
+#define DFLT_SIZE               (64 * 1024)
+#define DFLT_ITERATIONS         100
+#define PATFILL_BUFSIZE         (1024 * 1024)
+#define PATFILL_LOOPS           256
+#define CMDPOOL_LOOPS           1000000
+#define CMDPOOL_DEPTH           4
+#define BUFCMP_CASES            3000
+#define BUFCMP_MAXLEN           (64 * 1024)
+#define BLKTAG_NUMBLKS          8
+#define CRC16_CASES             3000
+#define CRC16_MAXLEN            (16 * 1024)
+#define CRC16_CHECK_VALUE       0xd0db  // CRC16 T10 DIF of "123456789"
+
+
+void
+Usage(void) {
+    //80->  xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    printf("%s [-b <name>] [-s <bytes>] [-i <count>]\n", BENCHAPPNAME);
+    printf("  Microbenchmark framework internals which never access a DUT, results\n");
+    printf("  are reported on stdout and log output is discarded. Each benchmark first\n");
+    printf("  verifies its optimized code against a reference and fails when they\n");
+    printf("  differ.\n");
+    printf("    hex:     The hex rendering of Buffers::Log() and Buffers::Dump()\n");
+    printf("             against the per byte snprintf() rendering they previously\n");
+    printf("             used.\n");
+    printf("    pattern: Every PatternGen implementation the CPU supports filling\n");
+    printf("             a %d byte buffer %d times with every DataPattern.\n", PATFILL_BUFSIZE, PATFILL_LOOPS);
+    printf("    cmdpool: Obtaining a Write cmd from a CmdPool<Write>, and releasing it,\n");
+    printf("             against constructing and deleting it, %d times each. A\n", CMDPOOL_LOOPS);
+    printf("             stocked pool must not touch the heap at all.\n");
+    printf("    compare: Every BufCompare implementation the CPU supports, and Verify(),\n");
+    printf("             against the scalar reference over %d random cases, then\n", BUFCMP_CASES);
+    printf("             comparing %d byte buffers %d times.\n", PATFILL_BUFSIZE, PATFILL_LOOPS);
+    printf("    blktag:  Tagged blks which were misdirected, stale or torn are each\n");
+    printf("             classified as such, then filling and verifying %d byte\n", PATFILL_BUFSIZE);
+    printf("             buffers of tagged blks %d times.\n", PATFILL_LOOPS);
+    printf("    crc:     Every ProtInfo::CRC16() implementation the CPU supports\n");
+    printf("             against CRC16Reference() over %d random cases, then the\n", CRC16_CASES);
+    printf("             guard throughput over %d byte buffers of 512 and 4096\n", PATFILL_BUFSIZE);
+    printf("             byte LBA's, %d times each.\n", PATFILL_LOOPS);
+    printf("  -h(--help)                          Display this help\n");
+    printf("  -b(--bench) <name>                  Run only benchmark <name>; dflt=all\n");
+    printf("  -s(--size) <bytes>                  Size of the buffer rendered by hex;\n");
+    printf("                                      dflt=%d\n", DFLT_SIZE);
+    printf("  -i(--iterations) <count>            Times each hex rendering is repeated;\n");
+    printf("                                      dflt=%d\n", DFLT_ITERATIONS);
+}
+
+
+/**
+ * The rendering Buffers::Dump(FILE *) used prior to Buffers::FormatHex().
+ * @param buf Pass a pointer to the 1st byte to render
+ * @param length Pass the number of bytes to render
+ * @param output Returns the rendering
+ */
+void
+LegacyFormat(const uint8_t *buf, unsigned long length, string &output)
+{
+    const uint8_t *data = buf;
+    const int BUF_SIZE = 20;
+    char work[BUF_SIZE];
+
+    output.clear();
+    for (unsigned long i = 0; i < length; i++) {
+        if ((i % 16) == 15) {
+            snprintf(work, BUF_SIZE, " %02X\n", *data++);
+            output += work;
+        } else if ((i % 16) == 0) {
+            snprintf(work, BUF_SIZE, "0x%08X: %02X", (uint32_t)i, *data++);
+            output += work;
+        } else {
+            snprintf(work, BUF_SIZE, " %02X", *data++);
+            output += work;
+        }
+    }
+    if (length % 16)
+        output += "\n";
+}
+
+
+/**
+ * The rendering Buffers::Log() used prior to Buffers::FormatHex(), a single
+ * log statement per line.
+ * @param buf Pass a pointer to the 1st byte to render
+ * @param length Pass the number of bytes to render
+ */
+void
+LegacyLog(const uint8_t *buf, unsigned long length)
+{
+    const uint8_t *data = buf;
+    const int BUF_SIZE = 20;
+    char work[BUF_SIZE];
+    string output;
+
+    for (unsigned long i = 0; i < length; i++) {
+        if ((i % 16) == 15) {
+            snprintf(work, BUF_SIZE, " %02X", *data++);
+            output += work;
+            LOG_NRM("%s", output.c_str());
+            output.clear();
+        } else if ((i % 16) == 0) {
+            snprintf(work, BUF_SIZE, "0x%08X: %02X", (uint32_t)i, *data++);
+            output += work;
+        } else {
+            snprintf(work, BUF_SIZE, " %02X", *data++);
+            output += work;
+        }
+    }
+    if (output.length() != 0)
+        LOG_NRM("%s", output.c_str());
+}
+
+
+/// @return The current CLOCK_MONOTONIC time in usec
+double
+Now_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((now.tv_sec * 1000000.0) + (now.tv_nsec / 1000.0));
+}
+
+
+/// Heap allocations are counted while true, see VerifyCmdPool()
+bool countAllocs = false;
+long numAllocs = 0;
+
+
+// Replaces the global new/delete to count allocations; noinline stops gcc
+// from pairing the builtin operator new with the free() below
+void *
+__attribute__((noinline)) operator new(size_t size)
+{
+    void *mem;
+
+    if (countAllocs)
+        numAllocs++;
+    if ((mem = malloc((size == 0) ? 1 : size)) == NULL)
+        throw std::bad_alloc();
+    return mem;
+}
+
+
+void
+__attribute__((noinline)) operator delete(void *mem) noexcept
+{
+    free(mem);
+}
+
+
+/**
+ * Verify FormatHex() renders exactly what the legacy code did.
+ * @return true upon success, otherwise false
+ */
+bool
+Verify(const vector<uint8_t> &buf)
+{
+    const unsigned long sizes[] = { 0, 1, 15, 16, 17, 255, 4096, 4097 };
+    vector<char> out(Buffers::GetFormatHexSize(0, buf.size()));
+    string legacy;
+
+    for (size_t i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        unsigned long size = min(sizes[i], (unsigned long)buf.size());
+        LegacyFormat(&buf[0], size, legacy);
+        size_t len = Buffers::FormatHex(&out[0], NULL, 0, &buf[0], size, 0);
+        if (legacy.compare(0, string::npos, &out[0], len) != 0) {
+            printf("FAILURE: renderings differ for %ld bytes\n", size);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Benchmark the table driven hex rendering against the legacy rendering.
+ * @param size Pass the number of bytes to render
+ * @param iterations Pass the number of times to repeat each rendering
+ * @return true upon success, otherwise false
+ */
+bool
+BenchHex(unsigned long size, long iterations)
+{
+    double start;
+    double legacy_us;
+    double table_us;
+
+    vector<uint8_t> buf(size);
+    for (size_t i = 0; i < buf.size(); i++)
+        buf[i] = (uint8_t)(i * 7);
+    if (Verify(buf) == false)
+        return false;
+
+    string legacy;
+    vector<char> out(Buffers::GetFormatHexSize(0, size));
+    start = Now_us();
+    for (long i = 0; i < iterations; i++)
+        LegacyFormat(&buf[0], size, legacy);
+    legacy_us = ((Now_us() - start) / iterations);
+    start = Now_us();
+    for (long i = 0; i < iterations; i++)
+        Buffers::FormatHex(&out[0], NULL, 0, &buf[0], size, 0);
+    table_us = ((Now_us() - start) / iterations);
+    printf("Render %ld bytes:  legacy %10.1f us  table %8.1f us  %6.1fx\n",
+        size, legacy_us, table_us, (legacy_us / table_us));
+
+    // Logging includes the writer thread draining to stderr, i.e. /dev/null
+    Logger::Start();
+    start = Now_us();
+    for (long i = 0; i < iterations; i++) {
+        LegacyLog(&buf[0], size);
+        Logger::Flush();
+    }
+    legacy_us = ((Now_us() - start) / iterations);
+    start = Now_us();
+    for (long i = 0; i < iterations; i++) {
+        Buffers::Log(&buf[0], 0, ULONG_MAX, size, "bench");
+        Logger::Flush();
+    }
+    table_us = ((Now_us() - start) / iterations);
+    Logger::Stop();
+    printf("Log    %ld bytes:  legacy %10.1f us  table %8.1f us  %6.1fx\n",
+        size, legacy_us, table_us, (legacy_us / table_us));
+    return true;
+}
+
+
+/**
+ * Verify a PatternGen implementation produces output identical to the scalar
+ * reference, including unaligned starts and partial vectors.
+ * @param impl Pass the implementation to verify
+ * @param dataPat Pass the pattern to verify
+ * @param ref Pass a work buffer of at least PATFILL_BUFSIZE + 5 bytes
+ * @param buf Pass another work buffer of the same size as ref
+ * @return true upon success, otherwise false
+ */
+bool
+VerifyPatternImpl(PatternGen::Impl impl, DataPattern dataPat,
+    vector<uint8_t> &ref, vector<uint8_t> &buf)
+{
+    // Odd lengths and starts exercise the scalar head/tail of vector impls
+    const uint32_t lengths[] = { 0, 1, 3, 15, 17, 31, 33, 63, 65, 4097,
+        PATFILL_BUFSIZE };
+    const uint64_t initVal = 0xfffffffffffffff0ULL;
+
+    for (uint32_t offset = 0; offset <= (sizeof(uint32_t) + 1); offset++) {
+        for (size_t i = 0; i < (sizeof(lengths) / sizeof(lengths[0])); i++) {
+            memset(&ref[0], 0xa5, ref.size());
+            memset(&buf[0], 0xa5, buf.size());
+            PatternGen::Fill(PatternGen::IMPL_SCALAR, dataPat, initVal,
+                &ref[offset], lengths[i]);
+            PatternGen::Fill(impl, dataPat, initVal, &buf[offset],
+                lengths[i]);
+            if (memcmp(&ref[0], &buf[0], ref.size()) != 0) {
+                printf("FAILURE: %s pattern %d miscompares with scalar "
+                    "reference; offset %d, length %d\n",
+                    PatternGen::GetImplName(impl), dataPat, offset,
+                    lengths[i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Benchmark every PatternGen implementation the CPU supports.
+ * @return true upon success, otherwise false
+ */
+bool
+BenchPattern(void)
+{
+    uint32_t unaligned = (sizeof(uint32_t) + 1);
+    vector<uint8_t> ref(PATFILL_BUFSIZE + unaligned);
+    vector<uint8_t> buf(PATFILL_BUFSIZE + unaligned);
+    uint64_t bytes = ((uint64_t)PATFILL_BUFSIZE * PATFILL_LOOPS);
+
+    printf("Pattern generation selected at runtime: %s\n",
+        PatternGen::GetImplName(PatternGen::GetImpl()));
+    for (int pat = 0; pat < DATAPATTERN_FENCE; pat++) {
+        DataPattern dataPat = (DataPattern)pat;
+        for (int i = 0; i < PatternGen::IMPL_FENCE; i++) {
+            PatternGen::Impl impl = (PatternGen::Impl)i;
+            if (PatternGen::IsSupported(impl) == false)
+                continue;
+            if (VerifyPatternImpl(impl, dataPat, ref, buf) == false)
+                return false;
+
+            double start = Now_us();
+            for (uint32_t loop = 0; loop < PATFILL_LOOPS; loop++)
+                PatternGen::Fill(impl, dataPat, loop, &buf[0], PATFILL_BUFSIZE);
+            double delta_us = (Now_us() - start);
+            printf("Pattern %d, %-6s: %8.1f MB/s\n", pat,
+                PatternGen::GetImplName(impl),
+                (delta_us > 0) ? ((double)bytes / delta_us) : 0.0);
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Compare 2 miscompare results field by field.
+ * @return true when they are identical, otherwise false
+ */
+bool
+SameMiscompare(bool same1, const Miscompare &res1, bool same2,
+    const Miscompare &res2)
+{
+    if ((same1 != same2) || (res1.granule != res2.granule) ||
+        (res1.numBytes != res2.numBytes) ||
+        (res1.numRanges != res2.numRanges) ||
+        (res1.ranges.size() != res2.ranges.size())) {
+        return false;
+    }
+    if (res1.numBytes && (res1.firstOffset != res2.firstOffset))
+        return false;
+    for (size_t i = 0; i < res1.ranges.size(); i++) {
+        if ((res1.ranges[i].offset != res2.ranges[i].offset) ||
+            (res1.ranges[i].length != res2.ranges[i].length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Verify every BufCompare implementation, and BufCompare::Verify(), report
+ * exactly what the scalar reference does. Each case fills a buffer with a
+ * random pattern at a random alignment, then corrupts random bytes and runs
+ * so that miscompares straddle vector and granule boundaries, and some runs
+ * exceed MISCOMPARE_MAX_RANGES.
+ * @return true upon success, otherwise false
+ */
+bool
+VerifyCompare(void)
+{
+    const uint32_t granules[] = { 0, 1, 512, 520, 4096, 4160 };
+    const uint32_t unaligned = 32;
+    vector<uint8_t> ref(BUFCMP_MAXLEN + unaligned);
+    vector<uint8_t> buf(BUFCMP_MAXLEN + unaligned);
+    std::mt19937_64 rng(0x5eed);
+
+    for (uint32_t i = 0; i < BUFCMP_CASES; i++) {
+        DataPattern dataPat = (DataPattern)(rng() % DATAPATTERN_FENCE);
+        uint64_t initVal = rng();
+        uint32_t offset = (rng() % unaligned);
+        uint32_t length = (rng() % (BUFCMP_MAXLEN + 1));
+        uint32_t granule = granules[rng() % (sizeof(granules) /
+            sizeof(granules[0]))];
+
+        PatternGen::Fill(PatternGen::IMPL_SCALAR, dataPat, initVal,
+            &ref[offset], length);
+        memcpy(&buf[offset], &ref[offset], length);
+        uint32_t numCorrupt = (rng() % 4) ? (rng() % 64) : 0;
+        for (uint32_t c = 0; length && (c < numCorrupt); c++) {
+            uint32_t at = (rng() % length);
+            uint32_t run = (rng() % 2) ? 1 : (uint32_t)(rng() % 600);
+            run = MIN(run, (length - at));
+            for (uint32_t b = 0; b < run; b++)
+                buf[offset + at + b] ^= (uint8_t)((rng() % 255) + 1);
+        }
+
+        Miscompare expected;
+        bool same = BufCompare::Compare(PatternGen::IMPL_SCALAR,
+            &buf[offset], &ref[offset], length, granule, expected);
+        for (int j = 0; j < PatternGen::IMPL_FENCE; j++) {
+            PatternGen::Impl impl = (PatternGen::Impl)j;
+            if (PatternGen::IsSupported(impl) == false)
+                continue;
+            Miscompare result;
+            bool implSame = BufCompare::Compare(impl, &buf[offset],
+                &ref[offset], length, granule, result);
+            if (SameMiscompare(same, expected, implSame, result) == false) {
+                printf("FAILURE: %s compare differs from scalar reference; "
+                    "case %d, offset %d, length %d, granule %d\n",
+                    PatternGen::GetImplName(impl), i, offset, length, granule);
+                return false;
+            }
+        }
+
+        // Verify() ignores trailing bytes which don't form a whole element
+        uint32_t width = ((dataPat == DATAPAT_CONST_8BIT) ||
+            (dataPat == DATAPAT_INC_8BIT)) ? sizeof(uint8_t) :
+            ((dataPat == DATAPAT_CONST_16BIT) ||
+            (dataPat == DATAPAT_INC_16BIT)) ? sizeof(uint16_t) :
+            sizeof(uint32_t);
+        uint32_t whole = (length - (length % width));
+        same = BufCompare::Compare(PatternGen::IMPL_SCALAR, &buf[offset],
+            &ref[offset], whole, granule, expected);
+        Miscompare result;
+        bool verifySame = BufCompare::Verify(dataPat, initVal, &buf[offset],
+            length, granule, result);
+        if (SameMiscompare(same, expected, verifySame, result) == false) {
+            printf("FAILURE: Verify() differs from scalar reference; case %d, "
+                "pattern %d, offset %d, length %d, granule %d\n", i, dataPat,
+                offset, length, granule);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Benchmark every BufCompare implementation the CPU supports.
+ * @return true upon success, otherwise false
+ */
+bool
+BenchCompare(void)
+{
+    vector<uint8_t> buf1(PATFILL_BUFSIZE);
+    vector<uint8_t> buf2(PATFILL_BUFSIZE);
+    uint64_t bytes = ((uint64_t)PATFILL_BUFSIZE * PATFILL_LOOPS);
+    Miscompare result;
+
+    if (VerifyCompare() == false)
+        return false;
+
+    PatternGen::Fill(DATAPAT_INC_32BIT, 0, &buf1[0], PATFILL_BUFSIZE);
+    memcpy(&buf2[0], &buf1[0], PATFILL_BUFSIZE);
+    for (int i = 0; i < PatternGen::IMPL_FENCE; i++) {
+        PatternGen::Impl impl = (PatternGen::Impl)i;
+        if (PatternGen::IsSupported(impl) == false)
+            continue;
+
+        double start = Now_us();
+        for (uint32_t loop = 0; loop < PATFILL_LOOPS; loop++) {
+            BufCompare::Compare(impl, &buf1[0], &buf2[0], PATFILL_BUFSIZE,
+                512, result);
+        }
+        double delta_us = (Now_us() - start);
+        printf("Compare %-6s: %8.1f MB/s\n", PatternGen::GetImplName(impl),
+            (delta_us > 0) ? ((double)bytes / delta_us) : 0.0);
+    }
+    return true;
+}
+
+
+/**
+ * Verify BlkTag::Verify() found exactly the expected bad block.
+ * @param what Pass a description of the corruption
+ * @param result Pass the result of verifying the series
+ * @param blk Pass the index of the corrupted block
+ * @param status Pass the status expected of blk
+ * @param bodyOffset Pass the body offset expected of blk
+ * @return true upon success, otherwise false
+ */
+bool
+ExpectBlkTag(const char *what, const BlkTagResult &result, uint32_t blk,
+    BlkTagStatus status, uint32_t bodyOffset)
+{
+    if ((result.numBad != 1) || (result.count[status] != 1) ||
+        (result.count[BLKTAG_OK] != (result.numBlks - 1)) ||
+        (result.bad.size() != 1) || (result.bad[0].blk != blk) ||
+        (result.bad[0].status != status) ||
+        (result.bad[0].bodyOffset != bodyOffset)) {
+        printf("FAILURE: %s blk %d not classified %s @ 0x%04X; bad %d, "
+            "found %s @ 0x%04X\n", what, blk, BlkTag::GetStatusName(status),
+            bodyOffset, result.numBad, result.bad.empty() ? "none" :
+            BlkTag::GetStatusName(result.bad[0].status),
+            result.bad.empty() ? 0 : result.bad[0].bodyOffset);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Verify tagged blocks which are corrupted as the DUT could corrupt them are
+ * each classified as such: a block written to the wrong LBA or NSID is
+ * misdirected, a block of an older write generation or another seed is
+ * stale, a block whose body is partially from another write or has a
+ * corrupt qword is torn, and a block which was never written is untagged.
+ * @param lbaDataSize Pass the size of every block
+ * @return true upon success, otherwise false
+ */
+bool
+VerifyBlkTag(uint32_t lbaDataSize)
+{
+    BlkTagParams params = { 1, 0x1000, lbaDataSize, 7, 0x0123456789abcdefULL };
+    vector<uint8_t> buf(BLKTAG_NUMBLKS * lbaDataSize);
+    vector<uint8_t> work(lbaDataSize);
+    BlkTagResult result;
+
+    BlkTag::Fill(params, &buf[0], BLKTAG_NUMBLKS);
+    if (BlkTag::Verify(params, &buf[0], BLKTAG_NUMBLKS, result) == false) {
+        printf("FAILURE: %d byte tagged blks don't verify as written\n",
+            lbaDataSize);
+        return false;
+    }
+
+    // Blk 5's data landed at blk 1's LBA
+    BlkTag::Fill(params, &buf[0], BLKTAG_NUMBLKS);
+    memcpy(&buf[1 * lbaDataSize], &buf[5 * lbaDataSize], lbaDataSize);
+    BlkTag::Verify(params, &buf[0], BLKTAG_NUMBLKS, result);
+    if (ExpectBlkTag("Misplaced", result, 1, BLKTAG_MISDIRECTED, 0) == false)
+        return false;
+
+    // Blk 2 holds the right LBA of another NSID
+    BlkTagParams other = params;
+    other.nsid++;
+    other.slba += 2;
+    BlkTag::Fill(params, &buf[0], BLKTAG_NUMBLKS);
+    BlkTag::Fill(other, &buf[2 * lbaDataSize], 1);
+    BlkTag::Verify(params, &buf[0], BLKTAG_NUMBLKS, result);
+    if (ExpectBlkTag("Other NSID's", result, 2, BLKTAG_MISDIRECTED, 0) == false)
+        return false;
+
+    // Blk 3 was never rewritten, it retains the prior generation
+    other = params;
+    other.generation--;
+    other.slba += 3;
+    BlkTag::Fill(params, &buf[0], BLKTAG_NUMBLKS);
+    BlkTag::Fill(other, &buf[3 * lbaDataSize], 1);
+    BlkTag::Verify(params, &buf[0], BLKTAG_NUMBLKS, result);
+    if (ExpectBlkTag("Stale", result, 3, BLKTAG_STALE, 0) == false)
+        return false;
+
+    // Blk 4 was written by a run with another seed
+    other = params;
+    other.seed++;
+    other.slba += 4;
+    BlkTag::Fill(params, &buf[0], BLKTAG_NUMBLKS);
+    BlkTag::Fill(other, &buf[4 * lbaDataSize], 1);
+    BlkTag::Verify(params, &buf[0], BLKTAG_NUMBLKS, result);
+    if (ExpectBlkTag("Reseeded", result, 4, BLKTAG_STALE, 0) == false)
+        return false;
+
+    // Blk 5's 2nd half is from the prior generation, a torn write
+    uint32_t half = ((lbaDataSize / 2) & ~(sizeof(uint64_t) - 1));
+    other = params;
+    other.generation--;
+    other.slba += 5;
+    BlkTag::Fill(params, &buf[0], BLKTAG_NUMBLKS);
+    BlkTag::Fill(other, &work[0], 1);
+    memcpy(&buf[(5 * lbaDataSize) + half], &work[half], (lbaDataSize - half));
+    BlkTag::Verify(params, &buf[0], BLKTAG_NUMBLKS, result);
+    if (ExpectBlkTag("Torn", result, 5, BLKTAG_TORN, half) == false)
+        return false;
+
+    // Blk 6's last body qword is corrupt
+    uint32_t last = (lbaDataSize - sizeof(uint64_t));
+    BlkTag::Fill(params, &buf[0], BLKTAG_NUMBLKS);
+    buf[(6 * lbaDataSize) + last + 3] ^= 0x10;
+    BlkTag::Verify(params, &buf[0], BLKTAG_NUMBLKS, result);
+    if (ExpectBlkTag("Corrupt", result, 6, BLKTAG_TORN, last) == false)
+        return false;
+
+    // Blk 7 was never written
+    BlkTag::Fill(params, &buf[0], BLKTAG_NUMBLKS);
+    memset(&buf[7 * lbaDataSize], 0, lbaDataSize);
+    BlkTag::Verify(params, &buf[0], BLKTAG_NUMBLKS, result);
+    if (ExpectBlkTag("Unwritten", result, 7, BLKTAG_UNTAGGED, 0) == false)
+        return false;
+    return true;
+}
+
+
+/**
+ * Benchmark filling and verifying tagged blocks.
+ * @return true upon success, otherwise false
+ */
+bool
+BenchBlkTag(void)
+{
+    const uint32_t lbaDataSizes[] = { 512, 520, 4096, 4160 };
+    uint64_t bytes = ((uint64_t)PATFILL_BUFSIZE * PATFILL_LOOPS);
+    BlkTagResult result;
+
+    for (size_t i = 0; i < (sizeof(lbaDataSizes) / sizeof(lbaDataSizes[0]));
+        i++) {
+
+        uint32_t lbaDataSize = lbaDataSizes[i];
+        if (VerifyBlkTag(lbaDataSize) == false)
+            return false;
+
+        uint32_t numBlks = (PATFILL_BUFSIZE / lbaDataSize);
+        vector<uint8_t> buf(numBlks * lbaDataSize);
+        BlkTagParams params = { 1, 0, lbaDataSize, 1, 0x5eed };
+        double start = Now_us();
+        for (uint32_t loop = 0; loop < PATFILL_LOOPS; loop++) {
+            params.slba = (loop * numBlks);
+            BlkTag::Fill(params, &buf[0], numBlks);
+        }
+        double fill_us = (Now_us() - start);
+        start = Now_us();
+        for (uint32_t loop = 0; loop < PATFILL_LOOPS; loop++)
+            BlkTag::Verify(params, &buf[0], numBlks, result);
+        double verify_us = (Now_us() - start);
+        printf("Tagged %4d byte blks:  fill %8.1f MB/s  verify %8.1f MB/s\n",
+            lbaDataSize, (fill_us > 0) ? ((double)bytes / fill_us) : 0.0,
+            (verify_us > 0) ? ((double)bytes / verify_us) : 0.0);
+    }
+    return true;
+}
+
+
+/**
+ * Verify every CRC16() implementation calcs the check value, and matches the
+ * bit at a time reference over random lengths, alignments and preceding
+ * CRC's, also when the data is calc'd in 2 pieces.
+ * @return true upon success, otherwise false
+ */
+bool
+VerifyCRC16(void)
+{
+    const char *check = "123456789";
+    const uint32_t unaligned = 16;
+    vector<uint8_t> buf(CRC16_MAXLEN + unaligned);
+    std::mt19937_64 rng(0x5eed);
+
+    uint16_t ref = ProtInfo::CRC16Reference((const uint8_t *)check,
+        strlen(check));
+    if (ref != CRC16_CHECK_VALUE) {
+        printf("FAILURE: CRC16Reference() check value 0x%04X != 0x%04X\n",
+            ref, CRC16_CHECK_VALUE);
+        return false;
+    }
+    for (int i = 0; i < ProtInfo::CRCIMPL_FENCE; i++) {
+        ProtInfo::CRCImpl impl = (ProtInfo::CRCImpl)i;
+        if (ProtInfo::IsSupported(impl) == false)
+            continue;
+        uint16_t crc = ProtInfo::CRC16(impl, (const uint8_t *)check,
+            strlen(check));
+        if (crc != CRC16_CHECK_VALUE) {
+            printf("FAILURE: %s CRC16() check value 0x%04X != 0x%04X\n",
+                ProtInfo::GetCRCImplName(impl), crc, CRC16_CHECK_VALUE);
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < buf.size(); i++)
+        buf[i] = (uint8_t)rng();
+    for (uint32_t i = 0; i < CRC16_CASES; i++) {
+        uint32_t offset = (rng() % unaligned);
+        // Favor short lengths, where the impls' head and tail handling lies
+        uint32_t length = (rng() % 2) ? (rng() % 256) :
+            (rng() % (CRC16_MAXLEN + 1));
+        uint32_t split = (rng() % (length + 1));
+        uint16_t seed = (uint16_t)rng();
+
+        ref = ProtInfo::CRC16Reference(&buf[offset], length, seed);
+        for (int j = 0; j < ProtInfo::CRCIMPL_FENCE; j++) {
+            ProtInfo::CRCImpl impl = (ProtInfo::CRCImpl)j;
+            if (ProtInfo::IsSupported(impl) == false)
+                continue;
+            uint16_t crc = ProtInfo::CRC16(impl, &buf[offset], length, seed);
+            uint16_t pieces = ProtInfo::CRC16(impl, &buf[offset], split,
+                seed);
+            pieces = ProtInfo::CRC16(impl, &buf[offset + split],
+                (length - split), pieces);
+            if ((crc != ref) || (pieces != ref)) {
+                printf("FAILURE: %s CRC16() 0x%04X, in pieces 0x%04X, != "
+                    "reference 0x%04X; case %d, offset %d, length %d, split "
+                    "%d, seed 0x%04X\n", ProtInfo::GetCRCImplName(impl), crc,
+                    pieces, ref, i, offset, length, split, seed);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Benchmark every CRC16() implementation the CPU supports, calc'ing a guard
+ * per LBA as ProtInfo does.
+ * @return true upon success, otherwise false
+ */
+bool
+BenchCRC16(void)
+{
+    const uint32_t lbaDataSizes[] = { 512, 4096 };
+    vector<uint8_t> buf(PATFILL_BUFSIZE);
+    uint64_t bytes = ((uint64_t)PATFILL_BUFSIZE * PATFILL_LOOPS);
+
+    if (VerifyCRC16() == false)
+        return false;
+
+    PatternGen::Fill(DATAPAT_INC_32BIT, 0, &buf[0], PATFILL_BUFSIZE);
+    printf("CRC16 selected at runtime: %s\n",
+        ProtInfo::GetCRCImplName(ProtInfo::GetCRCImpl()));
+    for (size_t i = 0; i < (sizeof(lbaDataSizes) / sizeof(lbaDataSizes[0]));
+        i++) {
+
+        uint32_t lbaDataSize = lbaDataSizes[i];
+        for (int j = 0; j < ProtInfo::CRCIMPL_FENCE; j++) {
+            ProtInfo::CRCImpl impl = (ProtInfo::CRCImpl)j;
+            if (ProtInfo::IsSupported(impl) == false)
+                continue;
+
+            double start = Now_us();
+            for (uint32_t loop = 0; loop < PATFILL_LOOPS; loop++) {
+                for (uint32_t off = 0; off < PATFILL_BUFSIZE;
+                    off += lbaDataSize) {
+                    ProtInfo::CRC16(impl, &buf[off], lbaDataSize);
+                }
+            }
+            double delta_us = (Now_us() - start);
+            printf("CRC16 %-6s %4d byte LBA's: %6.2f GB/s\n",
+                ProtInfo::GetCRCImplName(impl), lbaDataSize,
+                (delta_us > 0) ? ((double)bytes / (delta_us * 1000.0)) : 0.0);
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Verify CmdPool<T> reuses released cmds in their constructed state, honors
+ * its max idle limit, and may be destroyed while cmds are outstanding.
+ * @return true upon success, otherwise false
+ */
+bool
+VerifyCmdPool(void)
+{
+    send_64b_bitmask prpBitmask = (send_64b_bitmask)
+        (MASK_PRP1_PAGE | MASK_PRP2_PAGE | MASK_PRP2_LIST);
+    SharedMemBufferPtr mem = SharedMemBufferPtr(new MemBuffer());
+    mem->Init(4096);
+    CmdPool<Write> pool(2);
+
+    SharedWritePtr cmd = pool.Get();
+    Write *first = cmd.get();
+    cmd->SetPrpBuffer(prpBitmask, mem);
+    cmd->SetNSID(1);
+    cmd->SetSLBA(0x123456789ULL);
+    cmd.reset();
+    if ((pool.GetNumIdle() != 1) || (mem.use_count() != 1)) {
+        printf("FAILURE: released cmd not recycled, or still holds its "
+            "PRP buffer\n");
+        return false;
+    }
+
+    Write fresh;
+    cmd = pool.Get();
+    if ((cmd.get() != first) ||
+        (memcmp(cmd->GetCmd(), fresh.GetCmd(), fresh.GetCmdSizeB()) != 0) ||
+        (cmd->GetRWPrpBuffer() != MemBuffer::NullMemBufferPtr)) {
+        printf("FAILURE: recycled cmd differs from a constructed one\n");
+        return false;
+    }
+
+    // Only 2 idle cmds are retained, the 3rd is deleted upon release
+    SharedWritePtr more[2] = { pool.Get(), pool.Get() };
+    cmd.reset();
+    more[0].reset();
+    more[1].reset();
+    CmdPool<Write>::Stats stats = pool.GetStats();
+    if ((pool.GetNumIdle() != 2) || (stats.hits != 1) ||
+        (stats.misses != 3) || (stats.recycled != 3) || (stats.deleted != 1)) {
+        printf("FAILURE: CmdPool stats: hits %ld, misses %ld, recycled %ld, "
+            "deleted %ld, idle %ld\n", stats.hits, stats.misses,
+            stats.recycled, stats.deleted, pool.GetNumIdle());
+        return false;
+    }
+
+    // Outstanding cmds may outlive their pool, they're then simply deleted
+    {
+        CmdPool<Write> shortLived;
+        cmd = shortLived.Get();
+    }
+    cmd.reset();
+
+    // Once stocked by Prealloc(), cycling cmds must never touch the heap
+    CmdPool<Write> stocked;
+    stocked.Prealloc(CMDPOOL_DEPTH);
+    numAllocs = 0;
+    countAllocs = true;
+    for (uint32_t i = 0; i < 1000; i++) {
+        SharedWritePtr depth[CMDPOOL_DEPTH];
+        for (uint32_t j = 0; j < CMDPOOL_DEPTH; j++)
+            depth[j] = stocked.Get();
+    }
+    countAllocs = false;
+    if (numAllocs != 0) {
+        printf("FAILURE: CmdPool<Write> Get() performed %ld heap "
+            "allocations\n", numAllocs);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Benchmark obtaining cmds from a CmdPool<Write> against the heap.
+ * @return true upon success, otherwise false
+ */
+bool
+BenchCmdPool(void)
+{
+    double start;
+    double heap_ns;
+    double pool_ns;
+
+    if (VerifyCmdPool() == false)
+        return false;
+
+    start = Now_us();
+    for (long i = 0; i < CMDPOOL_LOOPS; i++)
+        SharedWritePtr cmd = SharedWritePtr(new Write());
+    heap_ns = (((Now_us() - start) * 1000.0) / CMDPOOL_LOOPS);
+
+    CmdPool<Write> pool;
+    pool.Prealloc(1);
+    start = Now_us();
+    for (long i = 0; i < CMDPOOL_LOOPS; i++)
+        SharedWritePtr cmd = pool.Get();
+    pool_ns = (((Now_us() - start) * 1000.0) / CMDPOOL_LOOPS);
+    printf("Write cmd:  heap %8.1f ns  pool %8.1f ns  %6.1fx\n", heap_ns,
+        pool_ns, (heap_ns / pool_ns));
+    return true;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    int c;
+    int idx = 0;
+    long tmp;
+    char *endptr;
+    string bench;
+    unsigned long size = DFLT_SIZE;
+    long iterations = DFLT_ITERATIONS;
+    const char *short_opt = "hb:s:i:";
+    static struct option long_opt[] = {
+        // {name,           has_arg,            flag,   val}
+        {   "help",         no_argument,        NULL,   'h'},
+        {   "bench",        required_argument,  NULL,   'b'},
+        {   "size",         required_argument,  NULL,   's'},
+        {   "iterations",   required_argument,  NULL,   'i'},
+        {   NULL,           no_argument,        NULL,    0}
+    };
+
+    while ((c = getopt_long(argc, argv, short_opt, long_opt, &idx)) != -1) {
+        switch (c) {
+        case 'b':
+            bench = optarg;
+            if ((bench != "hex") && (bench != "pattern") &&
+                (bench != "cmdpool") && (bench != "compare") &&
+                (bench != "blktag") && (bench != "crc")) {
+                printf("Unrecognized -%c=%s\n", c, optarg);
+                exit(1);
+            }
+            break;
+        case 's':
+        case 'i':
+            tmp = strtol(optarg, &endptr, 10);
+            if ((*endptr != '\0') || (tmp <= 0)) {
+                printf("Unrecognized -%c=%s\n", c, optarg);
+                exit(1);
+            }
+            if (c == 's')
+                size = tmp;
+            else
+                iterations = tmp;
+            break;
+        default:
+        case 'h':   Usage();                            exit(0);
+        case '?':   Usage();                            exit(1);
+        }
+    }
+
+    if (freopen("/dev/null", "w", stderr) == NULL) {
+        printf("Unable to discard stderr\n");
+        exit(1);
+    }
+
+    if (bench.empty() || (bench == "pattern")) {
+        if (BenchPattern() == false)
+            exit(1);
+    }
+    if (bench.empty() || (bench == "compare")) {
+        if (BenchCompare() == false)
+            exit(1);
+    }
+    if (bench.empty() || (bench == "blktag")) {
+        if (BenchBlkTag() == false)
+            exit(1);
+    }
+    if (bench.empty() || (bench == "crc")) {
+        if (BenchCRC16() == false)
+            exit(1);
+    }
+    if (bench.empty() || (bench == "cmdpool")) {
+        if (BenchCmdPool() == false)
+            exit(1);
+    }
+    if (bench.empty() || (bench == "hex")) {
+        if (BenchHex(size, iterations) == false)
+            exit(1);
+    }
+    exit(0);
+}
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2011, Intel Corporation.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <vector>
+#include <map>
+#include "tnvme.h"
+#include "Utils/binDump.h"
+#include "Utils/dumpArchive.h"
+
+#define DUMPAPPNAME             "tnvme-dump"
+#define TEXT_SUFFIX             ".txt"
+
+
+void
+Usage(void) {
+    //80->  xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx
+    printf("%s [-w] <file> [<file> ...]\n", DUMPAPPNAME);
+    printf("%s -l <archive> [<archive> ...]\n", DUMPAPPNAME);
+    printf("%s -x [-w] <archive> [<name> ...]\n", DUMPAPPNAME);
+    printf("  Render binary dump files written by \"%s --bindump\", or the dumps\n", APPNAME);
+    printf("  within archives written by \"%s --archive\", into the text %s\n", APPNAME, APPNAME);
+    printf("  would otherwise have written.\n");
+    printf("  -h(--help)                          Display this help\n");
+    printf("  -w(--write)                         Write each rendering to <file>%s, or\n", TEXT_SUFFIX);
+    printf("                                      with -x to <name> within the current\n");
+    printf("                                      dir, rather than to stdout\n");
+    printf("  -l(--list)                          List the name, number of dumps and\n");
+    printf("                                      bytes of the dump files within archives\n");
+    printf("  -x(--extract)                       Render the dump files named <name>, i.e.\n");
+    printf("                                      <grp>.<test>.<obj>[.<qualifier>], or\n");
+    printf("                                      all when none are named, from <archive>\n");
+}
+
+
+/**
+ * Read the entire contents of a file.
+ * @param filename Pass the name of the file to read
+ * @param data Returns the contents of the file
+ * @return true upon success, otherwise false
+ */
+bool
+ReadFile(string filename, vector<uint8_t> &data)
+{
+    struct stat st;
+    ssize_t rc;
+    size_t pos = 0;
+    int fd;
+
+    if ((fd = open(filename.c_str(), O_RDONLY)) < 0)
+        return false;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return false;
+    }
+
+    data.resize(st.st_size);
+    while (pos < data.size()) {
+        if ((rc = read(fd, &data[pos], (data.size() - pos))) <= 0)
+            break;
+        pos += rc;
+    }
+    close(fd);
+    data.resize(pos);
+    return true;
+}
+
+
+/**
+ * Render every frame within a binary dump file.
+ * @param filename Pass the name of the binary dump file
+ * @param toFile Pass true to write filename.txt, otherwise stdout
+ * @return true upon success, otherwise false
+ */
+bool
+Render(string filename, bool toFile)
+{
+    vector<uint8_t> data;
+    BinDumpHdr hdr;
+    string label;
+    const uint8_t *payload;
+    size_t pos = 0;
+    FILE *fp = stdout;
+
+    if (ReadFile(filename, data) == false) {
+        printf("Unable to read file: %s\n", filename.c_str());
+        return false;
+    }
+
+    if (toFile) {
+        string textFile = filename + TEXT_SUFFIX;
+        if ((fp = fopen(textFile.c_str(), "w")) == NULL) {
+            printf("Unable to create file: %s\n", textFile.c_str());
+            return false;
+        }
+    }
+
+    while (BinDump::Parse(&data[0], data.size(), pos, hdr, label, payload))
+        BinDump::Render(fp, filename, hdr, label, payload);
+
+    if (toFile)
+        fclose(fp);
+
+    if (pos != data.size()) {
+        printf("%s: not a binary dump, or malformed at offset 0x%08lX\n",
+            filename.c_str(), pos);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @param name Pass the name of a dump file within an archive
+ * @return The name less any directories
+ */
+string
+BaseName(string name)
+{
+    size_t pos = name.rfind('/');
+    return (pos == string::npos) ? name : name.substr(pos + 1);
+}
+
+
+/**
+ * Open an archive and read its index.
+ * @param filename Pass the name of the archive
+ * @param fd Returns an open file descriptor of the archive
+ * @param index Returns every record within the archive
+ * @return true upon success, otherwise false
+ */
+bool
+OpenArchive(string filename, int &fd, vector<DumpArcEntry> &index)
+{
+    uint64_t end;
+
+    if ((fd = open(filename.c_str(), O_RDONLY)) < 0) {
+        printf("Unable to read file: %s\n", filename.c_str());
+        return false;
+    }
+    if (DumpArchive::ReadIndex(fd, index, end) == false) {
+        printf("%s: not a dump archive\n", filename.c_str());
+        close(fd);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * List the dump files within an archive.
+ * @param filename Pass the name of the archive
+ * @return true upon success, otherwise false
+ */
+bool
+List(string filename)
+{
+    vector<DumpArcEntry> index;
+    vector<string> names;
+    map<string, uint32_t> numDumps;
+    map<string, uint64_t> numBytes;
+    int fd;
+
+    if (OpenArchive(filename, fd, index) == false)
+        return false;
+    close(fd);
+
+    for (size_t i = 0; i < index.size(); i++) {
+        string name = BaseName(index[i].name);
+        if (numDumps[name]++ == 0)
+            names.push_back(name);
+        numBytes[name] += index[i].length;
+    }
+
+    printf("%s:\n", filename.c_str());
+    for (size_t i = 0; i < names.size(); i++) {
+        printf("%8u %12lu  %s\n", numDumps[names[i]], numBytes[names[i]],
+            names[i].c_str());
+    }
+    return true;
+}
+
+
+/**
+ * Render dump files from within an archive.
+ * @param filename Pass the name of the archive
+ * @param names Pass the names of the dump files to render, empty for all
+ * @param toFile Pass true to write each to its name, otherwise stdout
+ * @return true upon success, otherwise false
+ */
+bool
+Extract(string filename, vector<string> names, bool toFile)
+{
+    vector<DumpArcEntry> index;
+    vector<uint8_t> data;
+    map<string, FILE *> files;
+    map<string, bool> found;
+    uint64_t member = UINT64_MAX;
+    uint64_t next;
+    BinDumpHdr hdr;
+    string label;
+    const uint8_t *payload;
+    bool success = true;
+    FILE *fp = stdout;
+    int fd;
+
+    if (OpenArchive(filename, fd, index) == false)
+        return false;
+
+    for (size_t i = 0; (i < index.size()) && success; i++) {
+        string name = BaseName(index[i].name);
+        if (names.size()) {
+            bool wanted = false;
+            for (size_t j = 0; j < names.size(); j++) {
+                if ((names[j] == name) || (names[j] == index[i].name)) {
+                    found[names[j]] = true;
+                    wanted = true;
+                }
+            }
+            if (wanted == false)
+                continue;
+        }
+
+        // Records of the same member are adjacent, inflate each only once
+        if (index[i].member != member) {
+            member = index[i].member;
+            if (DumpArchive::ReadMember(fd, member, data, next) == false) {
+                printf("%s: malformed at offset 0x%08lX\n", filename.c_str(),
+                    member);
+                success = false;
+                break;
+            }
+        }
+        if (DumpArchive::ParseRecord(data, index[i], hdr, label, payload) ==
+            false) {
+            printf("%s: malformed record within offset 0x%08lX\n",
+                filename.c_str(), member);
+            success = false;
+            break;
+        }
+
+        if (toFile) {
+            if ((fp = files[name]) == NULL) {
+                if ((fp = fopen(name.c_str(), "w")) == NULL) {
+                    printf("Unable to create file: %s\n", name.c_str());
+                    success = false;
+                    break;
+                }
+                files[name] = fp;
+            }
+        }
+        BinDump::Render(fp, index[i].name, hdr, label, payload);
+    }
+
+    map<string, FILE *>::iterator file;
+    for (file = files.begin(); file != files.end(); file++) {
+        if (file->second)
+            fclose(file->second);
+    }
+    close(fd);
+
+    for (size_t i = 0; i < names.size(); i++) {
+        if (found[names[i]] == false) {
+            printf("%s: no dump file named: %s\n", filename.c_str(),
+                names[i].c_str());
+            success = false;
+        }
+    }
+    return success;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    int c;
+    int idx = 0;
+    int exitCode = 0;   // assume success
+    bool toFile = false;
+    bool list = false;
+    bool extract = false;
+    const char *short_opt = "hwlx";
+    static struct option long_opt[] = {
+        // {name,           has_arg,            flag,   val}
+        {   "help",         no_argument,        NULL,   'h'},
+        {   "write",        no_argument,        NULL,   'w'},
+        {   "list",         no_argument,        NULL,   'l'},
+        {   "extract",      no_argument,        NULL,   'x'},
+        {   NULL,           no_argument,        NULL,    0}
+    };
+
+    while ((c = getopt_long(argc, argv, short_opt, long_opt, &idx)) != -1) {
+        switch (c) {
+        case 'w':   toFile = true;                      break;
+        case 'l':   list = true;                        break;
+        case 'x':   extract = true;                     break;
+        default:
+        case 'h':   Usage();                            exit(0);
+        case '?':   Usage();                            exit(1);
+        }
+    }
+
+    if ((optind >= argc) || (list && extract)) {
+        Usage();
+        exit(1);
+    }
+
+    if (extract) {
+        string archive = argv[optind++];
+        vector<string> names(&argv[optind], &argv[argc]);
+        exit(Extract(archive, names, toFile) ? 0 : 1);
+    }
+
+    while (optind < argc) {
+        if (list) {
+            if (List(argv[optind++]) == false)
+                exitCode = 1;
+            continue;
+        }
+        if (Render(argv[optind++], toFile) == false)
+            exitCode = 1;
+    }
+    exit(exitCode);
+}